@@ -0,0 +1,21 @@
+#version 450 core
+
+in vec3 world_normal;
+
+uniform vec4 model_color;
+uniform vec3 light_direction = vec3(0.0, 1.0, 0.5);
+uniform float ambient_strength = 0.3;
+uniform float diffuse_strength = 0.7;
+
+out vec4 fragment_color;
+
+void main() {
+    // Simple directional lighting
+    vec3 norm = normalize(world_normal);
+    vec3 light_dir = normalize(light_direction);
+
+    float diff = max(dot(norm, light_dir), 0.0);
+    vec3 result = (ambient_strength + diffuse_strength * diff) * model_color.rgb;
+
+    fragment_color = vec4(result, model_color.a);
+}
@@ -0,0 +1,15 @@
+#version 450 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+uniform mat4 mvp_matrix;
+uniform mat4 model_matrix;
+uniform mat4 normal_matrix;
+
+out vec3 world_normal;
+
+void main() {
+    world_normal = normalize((normal_matrix * vec4(normal, 0.0)).xyz);
+    gl_Position = mvp_matrix * model_matrix * vec4(position, 1.0);
+}
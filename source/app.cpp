@@ -1,11 +1,15 @@
 #include "app.hpp"
 
 #include <format>
+#include <limits>
 #include <vector>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <filesystem>
 
+#include <omp.h>
 #include <cxxopts.hpp>
 #include <nlohmann/json.hpp>
 
@@ -21,8 +25,15 @@
 #include "scene.hpp"
 #include "camera.hpp"
 #include "global.hpp"
+#include "export.hpp"
+#include "benchmark.hpp"
+#include "coordinator.hpp"
 #include "overlay.hpp"
 #include "renderer.hpp"
+#include "recon/shell.hpp"
+#include "recon/slab.hpp"
+#include "recon/brick.hpp"
+#include "recon/bounds.hpp"
 
 
 /* Constructors */
@@ -32,20 +43,23 @@ App::App(int argc, char* argv[])
 , app_context_{this}
 , project_(std::make_shared<Project>())
 {
+    // Parse command line arguments
+    parse_arguments(argc, argv);
+
+    // Benchmark, sequence, export, worker and coordinator modes run headless and need no window or renderer
+    camera_ = std::make_shared<Camera>();
+    if (benchmark_ || sequence_ || export_file_ || worker_slab_ || !worker_hosts_.empty()) {
+        return;
+    }
+
     // Initialize GLFW and GLEW
     if (!initialize_window()) {
         throw std::runtime_error("Failed to initialize application window");
     }
 
-    // Initialize project with default state
-    project_ = std::make_shared<Project>();
-
-    // Parse command line arguments
-    parse_arguments(argc, argv);
-
     // Create all application components with default state
     scene_ = std::make_shared<Scene>();
-    camera_ = std::make_shared<Camera>();
+    scene_->set_verbose(verbose_);
     renderer_ = std::make_shared<Renderer>(VIEW_WIDTH, VIEW_HEIGHT, scene_, camera_);
     overlay_ = std::make_shared<Overlay>(window_, scene_, renderer_, camera_, 
         [this](std::shared_ptr<Project> project) { load_project(project); },
@@ -63,14 +77,37 @@ App::App(int argc, char* argv[])
 }
 
 App::~App() {
-    glfwDestroyWindow(window_);
-    glfwTerminate();
+    if (window_) {
+        glfwDestroyWindow(window_);
+        glfwTerminate();
+    }
 }
 
 
 /* Public methods */
 
 void App::run() {
+    if (benchmark_) {
+        run_benchmark_mode();
+        return;
+    }
+    if (sequence_) {
+        run_sequence_mode();
+        return;
+    }
+    if (worker_slab_) {
+        run_worker_mode();
+        return;
+    }
+    if (!worker_hosts_.empty()) {
+        run_coordinator_mode();
+        return;
+    }
+    if (export_file_) {
+        run_export_mode();
+        return;
+    }
+
     while (!glfwWindowShouldClose(window_)) {
         overlay_->new_frame();
         overlay_->render();
@@ -83,6 +120,37 @@ void App::run() {
 }
 
 bool App::load_project(std::shared_ptr<Project> project) {
+    if (!read_project(project)) {
+        return false;
+    }
+
+    // Initialize scene and renderer with the project
+    camera_->load_project(project);
+    scene_->load_project(project);
+    renderer_->load_project(project);
+    overlay_->load_project(project);
+
+    // Store the initialized project state
+    project->empty = false;
+    project->initialized = true;
+    project->needs_calibration = false;
+
+    return true;
+}
+
+void App::unload_project() {
+    project_ = std::make_shared<Project>();
+
+    scene_->unload_project();
+    renderer_->unload_project();
+    overlay_->unload_project();
+    camera_->unload_project();
+}
+
+
+/* Private methods */
+
+bool App::read_project(std::shared_ptr<Project> project) {
     if (!project || project->empty || project->file.empty()) {
         return false;
     }
@@ -111,6 +179,99 @@ bool App::load_project(std::shared_ptr<Project> project) {
         if (cb.contains("square")) { project->square_size = cb["square"].get<float>(); }
     }
 
+    // Reconstruction parameters
+    if (json.contains("reconstruction")) {
+        const auto& rec = json["reconstruction"];
+        if (rec.contains("strategy") && rec["strategy"].is_string()) {
+            std::string name = rec["strategy"].get<std::string>();
+            if (!parse_carve_strategy(name, project->strategy)) {
+                std::cerr << "Unknown reconstruction strategy: " << name << std::endl;
+                return false;
+            }
+        }
+        if (rec.contains("mask_model") && rec["mask_model"].is_string()) {
+            std::string name = rec["mask_model"].get<std::string>();
+            if (!parse_mask_model(name, project->mask_model)) {
+                std::cerr << "Unknown mask model: " << name << std::endl;
+                return false;
+            }
+        }
+        if (rec.contains("background_sigmas")) {
+            float sigmas = rec["background_sigmas"].get<float>();
+            if (sigmas <= 0.0f) {
+                std::cerr << "Invalid background sigmas: " << sigmas << std::endl;
+                return false;
+            }
+            project->background_sigmas = sigmas;
+        }
+        if (rec.contains("min_views")) {
+            project->min_views = rec["min_views"].get<int>();
+        }
+        if (rec.contains("photo_threshold")) {
+            project->photo_threshold = rec["photo_threshold"].get<float>();
+        }
+        if (rec.contains("visibility_downsample")) {
+            project->visibility_downsample = rec["visibility_downsample"].get<int>();
+        }
+        if (rec.contains("memory_budget_mb")) {
+            project->memory_budget = static_cast<size_t>(rec["memory_budget_mb"].get<double>() * (1 << 20));
+        }
+    }
+
+    // Reconstruction grid: optional preset, refined by voxel size and extent
+    if (json.contains("grid")) {
+        const auto& grid = json["grid"];
+        if (grid.contains("preset") && grid["preset"].is_string()) {
+            std::string name = grid["preset"].get<std::string>();
+            if (!parse_grid_preset(name, project->grid)) {
+                std::cerr << "Unknown grid preset: " << name << std::endl;
+                return false;
+            }
+        }
+        float voxel_size = project->grid.voxel_size;
+        if (grid.contains("voxel_size")) {
+            voxel_size = grid["voxel_size"].get<float>();
+            if (voxel_size <= 0.0f) {
+                std::cerr << "Invalid grid voxel size: " << voxel_size << std::endl;
+                return false;
+            }
+        }
+
+        // The extent is rounded up to whole voxels once, at the final voxel size
+        if (grid.contains("min") && grid.contains("max")) {
+            auto min = grid["min"].get<std::array<float, 3>>();
+            auto max = grid["max"].get<std::array<float, 3>>();
+            project->grid = Grid::from_extent(glm::vec3(min[0], min[1], min[2]), glm::vec3(max[0], max[1], max[2]), voxel_size);
+        }
+        else if (voxel_size != project->grid.voxel_size) {
+            project->grid = project->grid.resampled(voxel_size);
+        }
+        if (grid.contains("tight_bounds")) {
+            project->tight_bounds = grid["tight_bounds"].get<bool>();
+        }
+    }
+
+    // Capture sequence parameters
+    if (json.contains("sequence")) {
+        const auto& sequence = json["sequence"];
+        if (sequence.contains("motion_margin")) {
+            float motion_margin = sequence["motion_margin"].get<float>();
+            if (motion_margin <= 0.0f) {
+                std::cerr << "Invalid sequence motion margin: " << motion_margin << std::endl;
+                return false;
+            }
+            project->motion_margin = motion_margin;
+        }
+    }
+
+    apply_overrides(*project);
+    project->brick_dir = std::filesystem::temp_directory_path() / ("volrec_bricks_" + project->name);
+
+    if (!project->grid.is_valid()) {
+        std::cerr << "Invalid reconstruction grid." << std::endl;
+        return false;
+    }
+
     if (project->chess_cols < 3 || project->chess_rows < 3 
     ||  project->chess_cols > 20 || project->chess_rows > 20 
     ||  project->square_size < 5.0f || project->square_size > 100.0f) {
@@ -140,16 +301,43 @@ bool App::load_project(std::shared_ptr<Project> project) {
 
         View view;
         view.bg_path = (project->dir / json_view["background"].get<std::string>());
-        view.bg = cv::imread(view.bg_path.string(), cv::IMREAD_UNCHANGED);
         view.fg_path = (project->dir / json_view["foreground"].get<std::string>());
-        view.fg = cv::imread(view.fg_path.string(), cv::IMREAD_UNCHANGED);
         view.cb_path = (view.bg_path.parent_path() / std::format("cb{}.yml", i + 1));
 
         if (json_view.contains("camera") && json_view["camera"].is_string()) {
             view.cb_path = (project->dir / json_view["camera"].get<std::string>());
         }
+        if (json_view.contains("backgrounds") && json_view["backgrounds"].is_array()) {
+            for (const auto& frame : json_view["backgrounds"]) {
+                view.bg_frame_paths.push_back(project->dir / frame.get<std::string>());
+            }
+        }
+        if (json_view.contains("frames") && json_view["frames"].is_array()) {
+            for (const auto& frame : json_view["frames"]) {
+                view.frame_paths.push_back(project->dir / frame.get<std::string>());
+            }
+        }
+
+        // Check if calibration file exists and is loadable
+        std::ifstream cb_file(view.cb_path);
+        if (!std::filesystem::exists(view.cb_path) || !std::filesystem::is_regular_file(view.cb_path) || !cb_file.is_open()) {
+            project->needs_calibration = true;
+        }
+
+        project->views.push_back(view);
+    }
 
-        // Check if background and foreground images exist and are loadable
+    // Decode the images of all views concurrently; failures are reported in view order afterwards
+    const int num_views = static_cast<int>(project->views.size());
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < num_views; ++i) {
+        View& view = project->views[i];
+        view.bg = cv::imread(view.bg_path.string(), cv::IMREAD_UNCHANGED);
+        view.fg = cv::imread(view.fg_path.string(), cv::IMREAD_UNCHANGED);
+    }
+
+    // Check if background and foreground images exist and are loadable
+    for (const auto& view : project->views) {
         if (!std::filesystem::exists(view.bg_path) || view.bg.empty()) {
             std::cerr << "Background image not found or not loadable: " << view.bg_path << std::endl;
             return false;
@@ -159,47 +347,235 @@ bool App::load_project(std::shared_ptr<Project> project) {
             std::cerr << "Foreground image not found or not loadable: " << view.fg_path << std::endl;
             return false;
         }
+    }
 
-        // Check if calibration file exists and is loadable
-        std::ifstream cb_file(view.cb_path);
-        if (!std::filesystem::exists(view.cb_path) || !std::filesystem::is_regular_file(view.cb_path) || !cb_file.is_open()) {
-            project->needs_calibration = true;
+    // Additional background frames are decoded when the views are calibrated
+    for (const auto& view : project->views) {
+        for (const auto& path : view.bg_frame_paths) {
+            if (!std::filesystem::exists(path)) {
+                std::cerr << "Background frame not found: " << path << std::endl;
+                return false;
+            }
         }
+    }
 
-        project->views.push_back(view);
+    // A sequence has as many frames as its shortest view
+    project->frame_count = static_cast<int>(project->views.front().frame_paths.size());
+    for (const auto& view : project->views) {
+        project->frame_count = std::min(project->frame_count, static_cast<int>(view.frame_paths.size()));
     }
 
-    // Initialize scene and renderer with the project
-    camera_->load_project(project);
-    scene_->load_project(project);
-    renderer_->load_project(project);
-    overlay_->load_project(project);
+    return true;
+}
 
-    // Store the initialized project state
-    project->empty = false;
-    project->initialized = true;
-    project->needs_calibration = false;
+void App::apply_overrides(Project& project) const {
+    if (strategy_override_) {
+        project.strategy = *strategy_override_;
+    }
+    if (min_views_override_) {
+        project.min_views = *min_views_override_;
+    }
+    if (photo_threshold_override_) {
+        project.photo_threshold = *photo_threshold_override_;
+    }
+    if (grid_override_) {
+        project.grid = *grid_override_;
+    }
+    if (voxel_size_override_) {
+        project.grid = project.grid.resampled(*voxel_size_override_);
+    }
+    if (memory_budget_override_) {
+        project.memory_budget = *memory_budget_override_;
+    }
+}
 
-    return true;
+void App::run_benchmark_mode() {
+    // Without a project only the volume fills are measured
+    if (!project_->empty) {
+        if (!read_project(project_)) {
+            throw std::runtime_error("Failed to load project for benchmark: " + project_->file.string());
+        }
+        camera_->load_project(project_);
+    }
+    else {
+        apply_overrides(*project_);
+    }
+
+    run_benchmark(project_->views, project_->grid, project_->strategy);
+    run_mask_benchmark();
+    if (!project_->views.empty()) {
+        run_projection_check(project_->views, project_->grid);
+        run_pyramid_benchmark(project_->views, project_->grid);
+        run_packed_benchmark(project_->views, project_->grid);
+        run_update_benchmark(project_->views, project_->grid, project_->min_views);
+        run_polyhedral_benchmark(project_->views, project_->grid);
+    }
 }
 
-void App::unload_project() {
-    project_ = std::make_shared<Project>();
+void App::run_sequence_mode() {
+    if (project_->empty || !read_project(project_)) {
+        throw std::runtime_error("Failed to load project for sequence: " + project_->file.string());
+    }
+    camera_->load_project(project_);
 
-    scene_->unload_project();
-    renderer_->unload_project();
-    overlay_->unload_project();
-    camera_->unload_project();
+    if (project_->frame_count == 0) {
+        throw std::runtime_error("Project has no sequence frames: " + project_->file.string());
+    }
+
+    run_sequence_benchmark(*project_, [this](int frame) { return camera_->load_frame(frame); });
 }
 
+void App::run_export_mode() {
+    if (project_->empty || !read_project(project_)) {
+        throw std::runtime_error("Failed to load project for export: " + project_->file.string());
+    }
+    camera_->load_project(project_);
+
+    Carver carver;
+    carver.set_strategy(project_->strategy);
+    carver.set_min_views(project_->min_views);
+
+    // Grids whose in-core carve exceeds the memory budget are carved and exported brick by brick
+    const Grid grid = carve_bounds(project_->views, project_->grid, project_->tight_bounds, project_->strategy);
+    if (project_->memory_budget > 0 && carve_bytes(project_->views, grid, project_->strategy) > project_->memory_budget) {
+        BrickStore store;
+        BrickStats stats;
+        store.set_budget(project_->memory_budget);
+        if (!carve_bricks(carver, project_->views, grid, project_->brick_dir, store, stats)) {
+            throw std::runtime_error("Failed to write brick store: " + project_->brick_dir.string());
+        }
+        stats.print();
 
-/* Private methods */
+        if (!export_bricks_ply(*export_file_, store, export_shell_)) {
+            throw std::runtime_error("Failed to write export file: " + export_file_->string());
+        }
+        return;
+    }
+
+    OccupancyGrid occupancy;
+    carver.carve(project_->views, grid, occupancy);
+    carver.stats().print();
+
+    // Polyhedral hulls are exported as their mesh
+    if (!carver.hull().empty()) {
+        const PolyhedralHull& hull = carver.hull();
+        std::cout << "Export: " << hull.vertices().size() << " vertices, " << hull.triangles().size() / 3 << " triangles" << std::endl;
+        if (!export_mesh_ply(*export_file_, hull.vertices(), hull.normals(), hull.triangles())) {
+            throw std::runtime_error("Failed to write export file: " + export_file_->string());
+        }
+        return;
+    }
+
+    export_occupancy(occupancy);
+}
+
+void App::run_worker_mode() {
+    if (project_->empty || !read_project(project_)) {
+        throw std::runtime_error("Failed to load project for worker: " + project_->file.string());
+    }
+    if (project_->strategy == CarveStrategy::POLYHEDRAL) {
+        throw std::runtime_error("Polyhedral hulls are built as a whole and cannot be carved in slabs");
+    }
+    camera_->load_project(project_);
+
+    // The coordinator cut the slabs from the same carve grid
+    const Grid grid = carve_bounds(project_->views, project_->grid, project_->tight_bounds, project_->strategy);
+    const int z_begin = worker_slab_->x;
+    const int z_end = worker_slab_->y;
+    if (z_begin < 0 || z_end > grid.num_z || z_begin >= z_end) {
+        throw std::runtime_error(std::format("Worker slab {}:{} outside the carve grid of {} layers", z_begin, z_end, grid.num_z));
+    }
+
+    Carver carver;
+    carver.set_strategy(project_->strategy);
+    carver.set_min_views(project_->min_views);
+
+    OccupancyGrid occupancy;
+    carver.carve(project_->views, slab_grid(grid, z_begin, z_end), occupancy);
+    carver.stats().print();
+
+    if (!write_slab(slab_output_, grid, z_begin, occupancy)) {
+        throw std::runtime_error("Failed to write slab file: " + slab_output_.string());
+    }
+}
+
+void App::run_coordinator_mode() {
+    if (project_->empty || !read_project(project_)) {
+        throw std::runtime_error("Failed to load project for coordinator: " + project_->file.string());
+    }
+    if (project_->strategy == CarveStrategy::POLYHEDRAL) {
+        throw std::runtime_error("Polyhedral hulls are built as a whole and cannot be carved in slabs");
+    }
+
+    // Masks for the balancing pre-pass; calibration also happens here, once, before the workers start
+    camera_->load_project(project_);
+
+    CoordinatorConfig config;
+    config.executable = get_executable_path();
+    config.worker_args = { project_->file.string() };
+    config.worker_args.insert(config.worker_args.end(), worker_args_.begin(), worker_args_.end());
+    config.hosts = worker_hosts_;
+    config.threads_per_worker = std::max(1, omp_get_num_procs() / static_cast<int>(worker_hosts_.size()));
+    config.work_dir = std::filesystem::temp_directory_path() / ("volrec_slabs_" + project_->name);
+
+    OccupancyGrid occupancy;
+    if (!run_coordinator(*project_, config, run_local_worker, occupancy)) {
+        throw std::runtime_error("Slab reconstruction failed: " + project_->file.string());
+    }
+
+    if (export_file_) {
+        export_occupancy(occupancy);
+    }
+}
+
+void App::export_occupancy(const OccupancyGrid& occupancy) const {
+    // Voxel and shell indices are 32 bits; only brick stores index larger grids
+    const size_t voxel_count = occupancy.grid().voxel_count();
+    if (voxel_count > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error(std::format("Grid of {} voxels exceeds the {} voxels an in-core export can index; "
+            "export it out of core with --memory-budget instead", voxel_count, std::numeric_limits<uint32_t>::max()));
+    }
+
+    // The shell carries the exposed faces; the full set is a plain point cloud
+    bool written = false;
+    if (export_shell_) {
+        SurfaceShell shell;
+        shell.build(occupancy);
+        std::cout << "Export: " << shell.size() << " shell voxels of " << occupancy.count() << std::endl;
+        written = export_ply(*export_file_, occupancy.grid(), shell.indices(), &shell.faces());
+    }
+    else {
+        const std::vector<uint32_t> indices = occupancy.active_indices();
+        std::cout << "Export: " << indices.size() << " voxels" << std::endl;
+        written = export_ply(*export_file_, occupancy.grid(), indices, nullptr);
+    }
+
+    if (!written) {
+        throw std::runtime_error("Failed to write export file: " + export_file_->string());
+    }
+}
 
 void App::parse_arguments(int argc, char** argv) {
     cxxopts::Options options("VolRec", "Volumetric Reconstruction");
     options.add_options()
         ("project", "Project file", cxxopts::value<std::string>())
         ("f,force-calibration", "Force camera calibration")
+        ("s,strategy", "Reconstruction strategy (dense, octree, footprint, consensus, polyhedral)", cxxopts::value<std::string>())
+        ("k,min-views", "Views that must see a voxel in consensus carves (0 = all)", cxxopts::value<int>())
+        ("photo-threshold", "Photo-consistency threshold of surface voxels, 0-255 (0 = off)", cxxopts::value<float>())
+        ("g,grid", "Reconstruction grid preset (preview, production)", cxxopts::value<std::string>())
+        ("voxel-size", "Reconstruction voxel size in mm", cxxopts::value<float>())
+        ("memory-budget", "Memory budget of in-core carves in MiB; larger grids are carved out of core (0 = unlimited)", cxxopts::value<float>())
+        ("b,benchmark", "Measure reconstruction thread scaling and exit")
+        ("sequence", "Carve all frames of the project sequence, report per-frame costs and exit")
+        ("e,export", "Carve the project, write the voxels to a PLY file and exit", cxxopts::value<std::string>())
+        ("export-source", "Voxels to export (shell, all)", cxxopts::value<std::string>()->default_value("shell"))
+        ("processes", "Carve in Z slabs on this many local worker processes and merge them", cxxopts::value<int>())
+        ("hosts", "Comma-separated worker hosts, one Z slab each (run through the local stand-in transport)", cxxopts::value<std::string>())
+        ("worker", "Carve only the Z layers z0:z1 of the carve grid and write them to the slab file", cxxopts::value<std::string>())
+        ("slab-output", "Slab file written in worker mode", cxxopts::value<std::string>())
+        ("threads", "Number of reconstruction threads (0 = all processors)", cxxopts::value<int>())
+        ("v,verbose", "Print carve and coloring statistics after every interactive reconstruction update")
         ("h,help", "Print usage");
     
     // Tell cxxopts that the first positional argument is "project"
@@ -213,6 +589,105 @@ void App::parse_arguments(int argc, char** argv) {
         std::exit(0);
     }
 
+    benchmark_ = args.count("benchmark") > 0;
+    sequence_ = args.count("sequence") > 0;
+    verbose_ = args.count("verbose") > 0;
+
+    // Overrides that change the carve grid or result are forwarded to slab workers
+    if (args.count("strategy")) {
+        CarveStrategy strategy;
+        std::string name = args["strategy"].as<std::string>();
+        if (!parse_carve_strategy(name, strategy)) {
+            throw std::runtime_error("Unknown reconstruction strategy: " + name);
+        }
+        strategy_override_ = strategy;
+        worker_args_.insert(worker_args_.end(), { "--strategy", name });
+    }
+
+    if (args.count("min-views")) {
+        min_views_override_ = args["min-views"].as<int>();
+        worker_args_.insert(worker_args_.end(), { "--min-views", std::to_string(*min_views_override_) });
+    }
+
+    if (args.count("photo-threshold")) {
+        photo_threshold_override_ = args["photo-threshold"].as<float>();
+    }
+    if (args.count("grid")) {
+        Grid grid;
+        std::string name = args["grid"].as<std::string>();
+        if (!parse_grid_preset(name, grid)) {
+            throw std::runtime_error("Unknown grid preset: " + name);
+        }
+        grid_override_ = grid;
+        worker_args_.insert(worker_args_.end(), { "--grid", name });
+    }
+
+    if (args.count("voxel-size")) {
+        float voxel_size = args["voxel-size"].as<float>();
+        if (voxel_size <= 0.0f) {
+            throw std::runtime_error("Voxel size must be positive");
+        }
+        voxel_size_override_ = voxel_size;
+        worker_args_.insert(worker_args_.end(), { "--voxel-size", std::format("{}", voxel_size) });
+    }
+
+    if (args.count("memory-budget")) {
+        float budget = args["memory-budget"].as<float>();
+        if (budget < 0.0f) {
+            throw std::runtime_error("Memory budget must not be negative");
+        }
+        memory_budget_override_ = static_cast<size_t>(budget * (1 << 20));
+    }
+
+    if (args.count("threads")) {
+        int threads = args["threads"].as<int>();
+        if (threads < 0) {
+            throw std::runtime_error("Thread count must not be negative");
+        }
+        omp_set_num_threads(threads > 0 ? threads : omp_get_num_procs());
+    }
+
+    if (args.count("worker")) {
+        std::string range = args["worker"].as<std::string>();
+        size_t colon = range.find(':');
+        if (colon == std::string::npos || !args.count("slab-output")) {
+            throw std::runtime_error("Worker mode needs a slab range z0:z1 and a slab output file");
+        }
+        try {
+            worker_slab_ = glm::ivec2(std::stoi(range.substr(0, colon)), std::stoi(range.substr(colon + 1)));
+        }
+        catch (const std::exception&) {
+            throw std::runtime_error("Invalid worker slab range: " + range);
+        }
+        slab_output_ = std::filesystem::absolute(args["slab-output"].as<std::string>());
+    }
+
+    if (args.count("processes")) {
+        int processes = args["processes"].as<int>();
+        if (processes < 1) {
+            throw std::runtime_error("Process count must be positive");
+        }
+        worker_hosts_.assign(processes, "localhost");
+    }
+    if (args.count("hosts")) {
+        std::stringstream hosts(args["hosts"].as<std::string>());
+        std::string host;
+        worker_hosts_.clear();
+        while (std::getline(hosts, host, ',')) {
+            if (!host.empty()) {
+                worker_hosts_.push_back(host);
+            }
+        }
+    }
+
+    if (args.count("export")) {
+        export_file_ = std::filesystem::absolute(args["export"].as<std::string>());
+    }
+    std::string export_source = args["export-source"].as<std::string>();
+    if (export_source != "shell" && export_source != "all") {
+        throw std::runtime_error("Unknown export source: " + export_source);
+    }
+    export_shell_ = export_source == "shell";
     if (args.count("project")) {
         project_->file = std::filesystem::absolute(args["project"].as<std::string>());
         if (std::filesystem::exists(project_->file)) {
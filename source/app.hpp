@@ -2,6 +2,9 @@
 
 #include <array>
 #include <memory>
+#include <string>
+#include <vector>
+#include <optional>
 #include <filesystem>
 
 #include <glm/glm.hpp>
@@ -61,6 +64,43 @@ private: // Methods
     /** @brief Initialize the application window. */
     bool initialize_window();
 
+    /**
+     * @brief Read a project file and its view images without initializing any components.
+     *
+     * The view images are decoded concurrently once the whole file is parsed.
+     *
+     * @param project Project whose file, directory and name are set.
+     * @return True if successful.
+     */
+    bool read_project(std::shared_ptr<Project> project);
+
+    /**
+     * @brief Apply the command line overrides (strategy, consensus views, photo threshold, grid, voxel size, memory budget) to a project.
+     * @param project Project to modify.
+     */
+    void apply_overrides(Project& project) const;
+
+    /** @brief Run the headless benchmark on the command line project, if any. */
+    void run_benchmark_mode();
+
+    /** @brief Carve every frame of the command line project sequence headless and report the costs. */
+    void run_sequence_mode();
+
+    /** @brief Carve the command line project headless and write the voxels to the export file. */
+    void run_export_mode();
+
+    /** @brief Carve one Z slab of the command line project headless and write it to the slab file. */
+    void run_worker_mode();
+
+    /** @brief Carve the command line project in slabs on worker processes, merge them and report or export the result. */
+    void run_coordinator_mode();
+
+    /**
+     * @brief Write carved voxels to the export file.
+     * @param occupancy Carved occupancy.
+     */
+    void export_occupancy(const OccupancyGrid& occupancy) const;
+
 private: // Variables
     GLFWwindow* window_;
     AppContext app_context_;
@@ -73,4 +113,20 @@ private: // Variables
     std::shared_ptr<Renderer> renderer_;
 
     std::unique_ptr<Input> input_;
+
+    std::optional<CarveStrategy> strategy_override_;    // Reconstruction strategy given on the command line
+    std::optional<int> min_views_override_;             // Consensus view count given on the command line
+    std::optional<float> photo_threshold_override_;     // Photo-consistency threshold given on the command line
+    std::optional<Grid> grid_override_;                 // Grid preset given on the command line
+    std::optional<float> voxel_size_override_;          // Voxel size given on the command line
+    std::optional<size_t> memory_budget_override_;      // Carve memory budget given on the command line
+    bool benchmark_ = false;                            // Run the headless benchmark instead of the viewer
+    bool sequence_ = false;                             // Run the headless sequence carve instead of the viewer
+    std::optional<std::filesystem::path> export_file_;  // Write the carved voxels to this PLY file instead of the viewer
+    bool export_shell_ = true;                          // Export only the surface shell
+    bool verbose_ = false;                              // Print carve and coloring statistics of interactive reconstructions
+    std::optional<glm::ivec2> worker_slab_;             // Z layer range carved in worker mode
+    std::filesystem::path slab_output_;                 // Slab file written in worker mode
+    std::vector<std::string> worker_hosts_;             // Worker hosts in coordinator mode, one slab each
+    std::vector<std::string> worker_args_;              // Reconstruction overrides forwarded to the workers
 };
@@ -0,0 +1,622 @@
+#include "benchmark.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+#include <omp.h>
+
+#include "model/volume.hpp"
+#include "recon/shell.hpp"
+#include "recon/brick.hpp"
+#include "recon/mask.hpp"
+#include "recon/background.hpp"
+#include "recon/bounds.hpp"
+#include "recon/packed.hpp"
+#include "recon/pyramid.hpp"
+#include "recon/footprint.hpp"
+#include "recon/occupancy.hpp"
+#include "recon/projection.hpp"
+#include "recon/visibility.hpp"
+#include "recon/simd.hpp"
+
+
+// Thread counts measured by the benchmark
+constexpr const int BENCHMARK_MAX_THREADS = 64;
+
+// Size of the synthetic mask benchmark images
+constexpr const int BENCHMARK_MASK_WIDTH = 3840;
+constexpr const int BENCHMARK_MASK_HEIGHT = 2160;
+
+// Size and training frames of the background model benchmark
+constexpr const int BENCHMARK_MODEL_WIDTH = 1920;
+constexpr const int BENCHMARK_MODEL_HEIGHT = 1080;
+constexpr const int BENCHMARK_MODEL_FRAMES = 8;
+
+// Block edge lengths in voxels of the silhouette query benchmark, as the octree carve visits them
+constexpr const int BENCHMARK_QUERY_BLOCKS[] = { 16, 8, 4 };
+
+// Pixels added around block footprints, as in the octree carve
+constexpr const int BENCHMARK_QUERY_MARGIN = 2;
+
+// Block sizes needing more queries than this are skipped
+constexpr const size_t BENCHMARK_MAX_QUERIES = size_t(1) << 22;
+
+// Bytes per cache line, for the mask working set of the gather benchmark
+constexpr const int BENCHMARK_CACHE_LINE = 64;
+
+// Erosion iterations of the simulated mask edit of the incremental update check
+constexpr const int BENCHMARK_EDIT_ITERATIONS = 3;
+
+// Repetitions per measurement; the fastest one is reported
+constexpr const int BENCHMARK_REPEATS = 3;
+
+
+/* Functions */
+
+template <typename Fn>
+static double best_time_ms(Fn&& fn) {
+    double best = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < BENCHMARK_REPEATS; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    return best;
+}
+
+void run_benchmark(const std::vector<View>& views, const Grid& grid, CarveStrategy strategy) {
+    const bool carve = !views.empty();
+    const float radius = std::min({ grid.num_x, grid.num_y, grid.num_z }) * grid.voxel_size * 0.5f;
+
+    Volume volume(grid.num_x, grid.num_y, grid.num_z, grid.voxel_size);
+    OccupancyGrid occupancy(grid);
+    Carver carver;
+    carver.set_strategy(strategy);
+
+    // Build the cached projection tables outside the measurements
+    SurfaceShell shell;
+    VisibilityBuffer visibility;
+    visibility.set_mode(SplatMode::FACES);
+    if (carve) {
+        carver.carve(views, grid, occupancy);
+        shell.build(occupancy);
+    }
+
+    std::cout << "Benchmark: " << grid.num_x << "x" << grid.num_y << "x" << grid.num_z << " voxels, "
+              << views.size() << " views, " << omp_get_num_procs() << " processors" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "fill ms" << std::setw(10) << "speedup";
+    if (carve) {
+        std::cout << std::setw(12) << "carve ms" << std::setw(10) << "speedup"
+                  << std::setw(12) << "convert ms" << std::setw(10) << "speedup"
+                  << std::setw(12) << "visible ms" << std::setw(10) << "speedup";
+    }
+    std::cout << std::endl;
+
+    double fill_base = 0.0;
+    double carve_base = 0.0;
+    double convert_base = 0.0;
+    double visible_base = 0.0;
+
+    for (int threads = 1; threads <= BENCHMARK_MAX_THREADS; threads *= 2) {
+        omp_set_num_threads(threads);
+
+        double fill_ms = best_time_ms([&]() {
+            volume.fill_sphere(glm::vec3(0.0f, radius, 0.0f), radius, glm::vec4(1.0f));
+        });
+        fill_base = threads == 1 ? fill_ms : fill_base;
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << threads << std::setw(12) << fill_ms << std::setw(10) << fill_base / fill_ms;
+
+        if (carve) {
+            double carve_ms = best_time_ms([&]() { carver.carve(views, grid, occupancy); });
+            carve_base = threads == 1 ? carve_ms : carve_base;
+
+            // Conversion of the carved occupancy to the rendered volume, measured on its own
+            double convert_ms = best_time_ms([&]() { occupancy.to_volume(volume, glm::vec4(1.0f)); });
+            convert_base = threads == 1 ? convert_ms : convert_base;
+
+            // Face-rasterized visibility buffers of the hull surface in every view
+            double visible_ms = best_time_ms([&]() {
+                for (const View& view : views) {
+                    visibility.render(view, grid, shell.indices(), &shell.faces());
+                }
+            });
+            visible_base = threads == 1 ? visible_ms : visible_base;
+
+            std::cout << std::setw(12) << carve_ms << std::setw(10) << carve_base / carve_ms
+                      << std::setw(12) << convert_ms << std::setw(10) << convert_base / convert_ms
+                      << std::setw(12) << visible_ms << std::setw(10) << visible_base / visible_ms;
+        }
+        std::cout << std::endl;
+    }
+
+    omp_set_num_threads(omp_get_num_procs());
+}
+
+void run_mask_benchmark() {
+    // Noisy background with a brighter, differently colored blob in front of it
+    cv::Mat bg(BENCHMARK_MASK_HEIGHT, BENCHMARK_MASK_WIDTH, CV_8UC3);
+    cv::randu(bg, cv::Scalar::all(40), cv::Scalar::all(120));
+    cv::Mat fg = bg.clone();
+    cv::ellipse(fg, cv::Point(BENCHMARK_MASK_WIDTH / 2, BENCHMARK_MASK_HEIGHT / 2),
+        cv::Size(BENCHMARK_MASK_WIDTH / 5, BENCHMARK_MASK_HEIGHT / 3), 0.0, 0.0, 360.0, cv::Scalar(60, 140, 220), cv::FILLED);
+    cv::Mat noise(fg.size(), fg.type());
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(24));
+    fg += noise;
+
+    cv::Mat reference;
+    cv::Mat fused;
+    double reference_ms = best_time_ms([&]() { reference = compute_mask_reference(fg, bg); });
+    double fused_ms = best_time_ms([&]() { fused = compute_mask(fg, bg); });
+    const int mismatches = cv::countNonZero(reference != fused);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Mask " << BENCHMARK_MASK_WIDTH << "x" << BENCHMARK_MASK_HEIGHT << ": reference " << reference_ms
+              << " ms, fused " << fused_ms << " ms (" << reference_ms / fused_ms << "x), "
+              << (mismatches == 0 ? "identical" : std::to_string(mismatches) + " pixels differ") << std::endl;
+
+    // Region of interest of a subject covering a fifth of the frame
+    const cv::Rect roi(BENCHMARK_MASK_WIDTH * 3 / 10, BENCHMARK_MASK_HEIGHT / 6, BENCHMARK_MASK_WIDTH * 2 / 5, BENCHMARK_MASK_HEIGHT / 2);
+    double roi_ms = best_time_ms([&]() { fused = compute_mask(fg, bg, roi); });
+    std::cout << "Mask ROI " << roi.width << "x" << roi.height << ": fused " << roi_ms << " ms ("
+              << reference_ms / roi_ms << "x)" << std::endl;
+
+    // Gaussian background model learned from noisy background frames
+    cv::Mat model_bg;
+    cv::Mat model_fg;
+    cv::resize(bg, model_bg, cv::Size(BENCHMARK_MODEL_WIDTH, BENCHMARK_MODEL_HEIGHT), 0.0, 0.0, cv::INTER_AREA);
+    cv::resize(fg, model_fg, model_bg.size(), 0.0, 0.0, cv::INTER_AREA);
+
+    std::vector<cv::Mat> frames(BENCHMARK_MODEL_FRAMES);
+    for (cv::Mat& frame : frames) {
+        cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(8));
+        cv::resize(noise, frame, model_bg.size(), 0.0, 0.0, cv::INTER_NEAREST);
+        frame += model_bg;
+    }
+
+    BackgroundModel model;
+    double train_ms = best_time_ms([&]() {
+        model.reset();
+        for (const cv::Mat& frame : frames) {
+            model.add_frame(frame);
+        }
+    });
+    double segment_ms = best_time_ms([&]() { fused = model.segment(model_fg); });
+
+    std::cout << "Background model " << BENCHMARK_MODEL_WIDTH << "x" << BENCHMARK_MODEL_HEIGHT << ": "
+              << train_ms / BENCHMARK_MODEL_FRAMES << " ms per training frame, segment " << segment_ms << " ms ("
+              << 1000.0 / segment_ms << " frames/s), " << model.memory_bytes() / (1 << 20) << " MB" << std::endl;
+}
+
+void run_pyramid_benchmark(const std::vector<View>& views, const Grid& grid) {
+    const int num_views = static_cast<int>(views.size());
+    std::vector<MaskIntegral> integrals(num_views);
+    std::vector<MaskPyramid> pyramids(num_views);
+
+    double integral_build_ms = best_time_ms([&]() {
+        for (int v = 0; v < num_views; ++v) {
+            integrals[v].build(views[v].mask);
+        }
+    });
+    double pyramid_build_ms = best_time_ms([&]() {
+        for (int v = 0; v < num_views; ++v) {
+            pyramids[v].build(views[v].mask);
+        }
+    });
+
+    size_t integral_bytes = 0;
+    size_t pyramid_bytes = 0;
+    for (int v = 0; v < num_views; ++v) {
+        integral_bytes += integrals[v].memory_bytes();
+        pyramid_bytes += pyramids[v].memory_bytes();
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Silhouette queries: build integral " << integral_build_ms << " ms (" << integral_bytes / (1 << 20) << " MB), pyramid "
+              << pyramid_build_ms << " ms (" << pyramid_bytes / (1 << 20) << " MB)" << std::endl;
+    std::cout << std::setw(8) << "block" << std::setw(12) << "queries" << std::setw(14) << "integral ms"
+              << std::setw(14) << "pyramid ms" << std::setw(12) << "partial" << std::setw(12) << "wrong" << std::endl;
+
+    for (int block : BENCHMARK_QUERY_BLOCKS) {
+        const size_t num_blocks = static_cast<size_t>((grid.num_x + block - 1) / block) * ((grid.num_y + block - 1) / block) * ((grid.num_z + block - 1) / block);
+        if (num_blocks * num_views > BENCHMARK_MAX_QUERIES) {
+            continue;
+        }
+
+        // Footprints of all blocks of this size in every view
+        std::vector<Footprint> footprints;
+        footprints.reserve(num_blocks * num_views);
+        for (int z = 0; z < grid.num_z; z += block) {
+            for (int y = 0; y < grid.num_y; y += block) {
+                for (int x = 0; x < grid.num_x; x += block) {
+                    glm::vec3 box_min = grid.position(x, y, z);
+                    glm::vec3 box_max = grid.position(std::min(x + block, grid.num_x) - 1, std::min(y + block, grid.num_y) - 1, std::min(z + block, grid.num_z) - 1);
+                    for (const View& view : views) {
+                        footprints.push_back(project_footprint(view.pinhole, box_min, box_max, BENCHMARK_QUERY_MARGIN));
+                    }
+                }
+            }
+        }
+
+        const size_t num_queries = footprints.size();
+        std::vector<Coverage> exact(num_queries);
+        std::vector<Coverage> coarse(num_queries);
+
+        double integral_ms = best_time_ms([&]() {
+            for (size_t i = 0; i < num_queries; ++i) {
+                exact[i] = integrals[i % num_views].classify(footprints[i]);
+            }
+        });
+        double pyramid_ms = best_time_ms([&]() {
+            for (size_t i = 0; i < num_queries; ++i) {
+                coarse[i] = pyramids[i % num_views].classify(footprints[i]);
+            }
+        });
+
+        // The pyramid may only answer PARTIAL where the integral is exact, never contradict it
+        size_t partial = 0;
+        size_t wrong = 0;
+        for (size_t i = 0; i < num_queries; ++i) {
+            partial += coarse[i] == Coverage::PARTIAL && exact[i] != Coverage::PARTIAL;
+            wrong += coarse[i] != Coverage::PARTIAL && coarse[i] != exact[i];
+            wrong += exact[i] == Coverage::PARTIAL && coarse[i] != Coverage::PARTIAL;
+        }
+
+        std::cout << std::setw(8) << block << std::setw(12) << num_queries << std::setw(14) << integral_ms
+                  << std::setw(14) << pyramid_ms << std::setw(12) << partial << std::setw(12) << wrong << std::endl;
+    }
+}
+
+void run_projection_check(const std::vector<View>& views, const Grid& grid) {
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    const char* kernel = "NEON";
+#else
+    const char* kernel = cpu_has_avx2() ? "AVX2" : "none";
+#endif
+
+    std::cout << "Projection accuracy against cv::projectPoints (tolerance " << PROJECTION_TOLERANCE
+              << " px, vector kernel: " << kernel << ")" << std::endl;
+    std::cout << std::setw(6) << "view" << std::setw(14) << "scalar px" << std::setw(14) << "vector px" << std::setw(8) << "result" << std::endl;
+
+    int failed = 0;
+    for (size_t v = 0; v < views.size(); ++v) {
+        const float scalar_error = max_projection_error(views[v], grid, false);
+        const float vector_error = max_projection_error(views[v], grid, true);
+        const bool pass = scalar_error <= PROJECTION_TOLERANCE && vector_error <= PROJECTION_TOLERANCE;
+        failed += !pass;
+
+        std::cout << std::fixed << std::setprecision(4)
+                  << std::setw(6) << v << std::setw(14) << scalar_error << std::setw(14) << vector_error
+                  << std::setw(8) << (pass ? "pass" : "FAIL") << std::endl;
+    }
+
+    std::cout << "Projection accuracy: " << (failed == 0 ? "pass" : std::to_string(failed) + " views FAIL") << std::endl;
+}
+
+// Check whether two occupancy grids have the same layout and occupied voxels
+static bool same_occupancy(const OccupancyGrid& a, const OccupancyGrid& b) {
+    if (!(a.grid() == b.grid())) {
+        return false;
+    }
+
+    const Grid& grid = a.grid();
+    for (int z = 0; z < grid.num_z; ++z) {
+        for (int y = 0; y < grid.num_y; ++y) {
+            if (!std::equal(a.row(y, z), a.row(y, z) + a.words_per_row(), b.row(y, z))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void run_update_benchmark(const std::vector<View>& views, const Grid& grid, int min_views) {
+    Carver incremental;
+    Carver full;
+    incremental.set_strategy(CarveStrategy::CONSENSUS);
+    incremental.set_min_views(min_views);
+    full.set_strategy(CarveStrategy::CONSENSUS);
+    full.set_min_views(min_views);
+
+    // The edits accumulate: every view keeps its eroded mask while the next one is edited
+    std::vector<View> edited = views;
+    OccupancyGrid updated;
+    OccupancyGrid reference;
+    incremental.carve(edited, grid, updated);
+    full.carve(edited, grid, reference);
+
+    double update_ms = 0.0;
+    double carve_ms = 0.0;
+    int mismatches = 0;
+    for (int v = 0; v < static_cast<int>(views.size()); ++v) {
+        cv::erode(views[v].mask, edited[v].mask, cv::Mat(), cv::Point(-1, -1), BENCHMARK_EDIT_ITERATIONS);
+
+        if (!incremental.update_view(edited, v, updated)) {
+            std::cout << "Incremental mask updates: not supported for " << views.size() << " views" << std::endl;
+            return;
+        }
+        update_ms += incremental.stats().carve_ms;
+
+        full.carve(edited, grid, reference);
+        carve_ms += full.stats().carve_ms;
+
+        mismatches += !same_occupancy(updated, reference);
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Incremental mask updates: " << views.size() << " views, update " << update_ms / views.size()
+              << " ms, full consensus carve " << carve_ms / views.size() << " ms per edit (" << carve_ms / update_ms << "x), "
+              << (mismatches == 0 ? "identical" : std::to_string(mismatches) + " updates differ") << std::endl;
+}
+
+// Gather every voxel through the tables in view order, as the dense carve does, and count the kept voxels
+template <typename Test>
+static int gather_hull(const Grid& grid, const std::vector<const uint32_t*>& tables, Test&& test) {
+    const int num_views = static_cast<int>(tables.size());
+    const int num_rows = static_cast<int>(grid.row_count());
+    int occupied = 0;
+
+#pragma omp parallel for reduction(+:occupied) schedule(dynamic, 4)
+    for (int row = 0; row < num_rows; ++row) {
+        const size_t row_start = grid.index(0, row % grid.num_y, row / grid.num_y);
+
+        for (int xi = 0; xi < grid.num_x; ++xi) {
+            bool all_visible = true;
+            for (int v = 0; v < num_views && all_visible; ++v) {
+                const uint32_t pixel = tables[v][row_start + xi];
+                all_visible = pixel != ProjectionTable::OUTSIDE && test(v, pixel);
+            }
+            occupied += all_visible;
+        }
+    }
+
+    return occupied;
+}
+
+// Count the distinct cache lines of a mask the voxels of a table fall into; entries >> shift are byte offsets
+static size_t touched_lines(const uint32_t* table, size_t count, size_t mask_bytes, int shift) {
+    std::vector<uint8_t> seen(mask_bytes / BENCHMARK_CACHE_LINE + 1, 0);
+    size_t lines = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (table[i] != ProjectionTable::OUTSIDE) {
+            const size_t line = (table[i] >> shift) / BENCHMARK_CACHE_LINE;
+            lines += !seen[line];
+            seen[line] = 1;
+        }
+    }
+
+    return lines;
+}
+
+void run_packed_benchmark(const std::vector<View>& views, const Grid& grid) {
+    const int num_views = static_cast<int>(views.size());
+    const size_t count = grid.voxel_count();
+
+    std::vector<ProjectionTable> tables(num_views);
+    std::vector<PackedMask> packed(num_views);
+    std::vector<cv::Mat> masks(num_views);
+    std::vector<std::vector<uint32_t>> flat(num_views);
+    std::vector<const uint32_t*> tiled_data(num_views);
+    std::vector<const uint32_t*> flat_data(num_views);
+    std::vector<const uint8_t*> byte_data(num_views);
+    std::vector<const uint64_t*> word_data(num_views);
+
+    // Tables address the tiles; the byte masks get the same pixels as flat row-major indices
+    size_t byte_bytes = 0;
+    size_t packed_bytes = 0;
+    size_t byte_lines = 0;
+    size_t packed_lines = 0;
+
+    for (int v = 0; v < num_views; ++v) {
+        tables[v].build(views[v], grid);
+        masks[v] = views[v].mask.isContinuous() ? views[v].mask : views[v].mask.clone();
+        packed[v].build(masks[v]);
+
+        const int cols = masks[v].cols;
+        const int tiles_per_row = PackedMask::tiles_per_row(cols);
+        flat[v].resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t address = tables[v].address(i);
+            const uint32_t tile = address >> 6;
+            const uint32_t x = (tile % tiles_per_row) * 8 + (address & 7);
+            const uint32_t y = (tile / tiles_per_row) * 8 + ((address >> 3) & 7);
+            flat[v][i] = address == ProjectionTable::OUTSIDE ? ProjectionTable::OUTSIDE : y * cols + x;
+        }
+
+        tiled_data[v] = tables[v].data();
+        flat_data[v] = flat[v].data();
+        byte_data[v] = masks[v].ptr<uint8_t>();
+        word_data[v] = packed[v].data();
+
+        byte_bytes += masks[v].total();
+        packed_bytes += packed[v].memory_bytes();
+        byte_lines += touched_lines(flat_data[v], count, masks[v].total(), 0);
+        packed_lines += touched_lines(tiled_data[v], count, packed[v].memory_bytes(), 3);
+    }
+
+    int byte_occupied = 0;
+    int packed_occupied = 0;
+    double pack_ms = best_time_ms([&]() {
+        for (int v = 0; v < num_views; ++v) {
+            packed[v].build(masks[v]);
+        }
+    });
+    double byte_ms = best_time_ms([&]() {
+        byte_occupied = gather_hull(grid, flat_data, [&](int v, uint32_t pixel) { return byte_data[v][pixel] == std::numeric_limits<uint8_t>::max(); });
+    });
+    double packed_ms = best_time_ms([&]() {
+        packed_occupied = gather_hull(grid, tiled_data, [&](int v, uint32_t pixel) { return PackedMask::test(word_data[v], pixel); });
+    });
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Mask gathers: bytes " << byte_ms << " ms (" << byte_bytes / (1 << 20) << " MB, "
+              << byte_lines * BENCHMARK_CACHE_LINE / (1 << 10) << " KiB of lines touched), tiled bits " << packed_ms
+              << " ms (" << packed_bytes / (1 << 20) << " MB, " << packed_lines * BENCHMARK_CACHE_LINE / (1 << 10)
+              << " KiB of lines touched, packed in " << pack_ms << " ms), " << byte_ms / packed_ms << "x, "
+              << (byte_occupied == packed_occupied ? "same hull" : "hulls differ") << std::endl;
+}
+
+// Count the voxels occupied in only one of two grids on the same lattice; voxels outside a grid count as empty
+static size_t occupancy_mismatches(const OccupancyGrid& a, const OccupancyGrid& b) {
+    const Grid& ga = a.grid();
+    const Grid& gb = b.grid();
+    const glm::ivec3 offset(glm::round((gb.origin - ga.origin) / ga.voxel_size));
+
+    // Occupied voxels of a that are empty or missing in b
+    size_t mismatches = 0;
+    a.for_each([&](int x, int y, int z) {
+        const glm::ivec3 voxel = glm::ivec3(x, y, z) - offset;
+        const bool inside = voxel.x >= 0 && voxel.y >= 0 && voxel.z >= 0 && voxel.x < gb.num_x && voxel.y < gb.num_y && voxel.z < gb.num_z;
+        mismatches += !inside || !b.test(voxel.x, voxel.y, voxel.z);
+    });
+
+    // Occupied voxels of b that are empty or missing in a
+    b.for_each([&](int x, int y, int z) {
+        const glm::ivec3 voxel = glm::ivec3(x, y, z) + offset;
+        const bool inside = voxel.x >= 0 && voxel.y >= 0 && voxel.z >= 0 && voxel.x < ga.num_x && voxel.y < ga.num_y && voxel.z < ga.num_z;
+        mismatches += !inside || !a.test(voxel.x, voxel.y, voxel.z);
+    });
+
+    return mismatches;
+}
+
+// Carve a frame from scratch, bounded to the hull when enabled, and return the number of tested cells
+static size_t carve_full(Carver& carver, const Project& project, OccupancyGrid& occupancy) {
+    carver.carve(project.views, carve_bounds(project.views, project.grid, project.tight_bounds, project.strategy), occupancy);
+
+    const auto& tested = carver.stats().tested_per_level;
+    return std::accumulate(tested.begin(), tested.end(), size_t(0));
+}
+
+void run_sequence_benchmark(const Project& project, const std::function<bool(int)>& load_frame) {
+    Carver seeded;
+    Carver independent;
+    seeded.set_strategy(project.strategy);
+    seeded.set_min_views(project.min_views);
+    independent.set_strategy(project.strategy);
+    independent.set_min_views(project.min_views);
+
+    OccupancyGrid hull;
+    OccupancyGrid reference;
+
+    std::cout << "Sequence: " << project.frame_count << " frames, " << project.views.size() << " views, motion margin "
+              << project.motion_margin << " mm" << std::endl;
+    std::cout << std::setw(6) << "frame" << std::setw(8) << "mode" << std::setw(14) << "tested" << std::setw(12) << "ms"
+              << std::setw(14) << "full tested" << std::setw(12) << "full ms" << std::setw(10) << "speedup"
+              << std::setw(12) << "mismatches" << std::endl;
+
+    double seeded_total = 0.0;
+    double independent_total = 0.0;
+    size_t mismatch_total = 0;
+
+    for (int frame = 0; frame < project.frame_count; ++frame) {
+        if (!load_frame(frame)) {
+            std::cerr << "Stopping sequence at frame " << frame << std::endl;
+            break;
+        }
+
+        // Seeded carve, as the viewer does when stepping through frames
+        auto start = std::chrono::steady_clock::now();
+        const Grid& seed_grid = hull.grid();
+        const int margin = static_cast<int>(std::ceil(project.motion_margin / seed_grid.voxel_size));
+        const bool bounded = !(seed_grid == project.grid);
+
+        size_t tested = 0;
+        const char* mode = "seeded";
+        if (frame > 0 && seeded.carve_band(project.views, std::max(margin, 1), bounded, hull)) {
+            tested = seeded.stats().tested_per_level.front();
+        }
+        else {
+            tested = carve_full(seeded, project, hull);
+            mode = frame > 0 ? "refit" : "full";
+        }
+        double seeded_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Independent carve of the same frame
+        start = std::chrono::steady_clock::now();
+        size_t independent_tested = carve_full(independent, project, reference);
+        double independent_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Both grids are bounds on the project lattice, so the hulls must agree voxel for voxel
+        const size_t mismatches = occupancy_mismatches(hull, reference);
+
+        seeded_total += seeded_ms;
+        independent_total += independent_ms;
+        mismatch_total += mismatches;
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(6) << frame << std::setw(8) << mode << std::setw(14) << tested << std::setw(12) << seeded_ms
+                  << std::setw(14) << independent_tested << std::setw(12) << independent_ms
+                  << std::setw(10) << independent_ms / seeded_ms << std::setw(12) << mismatches << std::endl;
+    }
+
+    std::cout << "Total: " << seeded_total << " ms seeded, " << independent_total << " ms independent ("
+              << independent_total / seeded_total << "x), "
+              << (mismatch_total == 0 ? "identical hulls" : std::to_string(mismatch_total) + " voxels differ") << std::endl;
+}
+
+// Count the directed edges of a triangle mesh without exactly one opposite edge (0 for closed, consistently oriented meshes)
+static size_t open_edges(const std::vector<uint32_t>& triangles) {
+    std::vector<uint64_t> edges;
+    edges.reserve(triangles.size());
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        for (int k = 0; k < 3; ++k) {
+            edges.push_back(static_cast<uint64_t>(triangles[t + k]) << 32 | triangles[t + (k + 1) % 3]);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    size_t open = 0;
+    for (uint64_t edge : edges) {
+        const auto same = std::equal_range(edges.begin(), edges.end(), edge);
+        const auto opposite = std::equal_range(edges.begin(), edges.end(), edge << 32 | edge >> 32);
+        open += same.second - same.first != 1 || opposite.second - opposite.first != 1;
+    }
+    return open;
+}
+
+void run_polyhedral_benchmark(const std::vector<View>& views, const Grid& grid) {
+    Carver polyhedral;
+    Carver dense;
+    polyhedral.set_strategy(CarveStrategy::POLYHEDRAL);
+    dense.set_strategy(CarveStrategy::DENSE);
+
+    OccupancyGrid mesh_occupancy;
+    OccupancyGrid occupancy;
+    const double mesh_ms = best_time_ms([&]() { polyhedral.carve(views, grid, mesh_occupancy); });
+    dense.carve(views, grid, occupancy);
+    const double dense_ms = best_time_ms([&]() { dense.carve(views, grid, occupancy); });
+
+    // Enclosed volume from the divergence theorem, against the voxel cubes of the dense carve
+    const PolyhedralHull& hull = polyhedral.hull();
+    const std::vector<glm::vec3>& vertices = hull.vertices();
+    const std::vector<uint32_t>& triangles = hull.triangles();
+    double mesh_volume = 0.0;
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        const glm::dvec3 a(vertices[triangles[t]]);
+        const glm::dvec3 b(vertices[triangles[t + 1]]);
+        const glm::dvec3 c(vertices[triangles[t + 2]]);
+        mesh_volume += glm::dot(a, glm::cross(b, c)) / 6.0;
+    }
+    const double voxel_volume = static_cast<double>(occupancy.count()) * grid.voxel_size * grid.voxel_size * grid.voxel_size;
+    const size_t open = open_edges(triangles);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Polyhedral hull: " << triangles.size() / 3 << " triangles from " << hull.contour_vertex_count()
+              << " contour vertices in " << mesh_ms << " ms, " << hull.memory_bytes() / 1024 << " KiB; dense carve "
+              << dense_ms << " ms, " << carve_bytes(views, grid, CarveStrategy::DENSE) / 1024 << " KiB ("
+              << dense_ms / mesh_ms << "x)" << std::endl;
+    std::cout << "  " << (open == 0 ? "watertight" : std::to_string(open) + " open edges") << ", "
+              << hull.open_face_count() << " open faces, volume " << mesh_volume / 1e3 << " cm3 vs "
+              << voxel_volume / 1e3 << " cm3 of voxels (" << 100.0 * (voxel_volume - mesh_volume) / mesh_volume << "%)" << std::endl;
+}
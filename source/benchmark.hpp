@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "view.hpp"
+#include "project.hpp"
+#include "recon/grid.hpp"
+#include "recon/carver.hpp"
+
+
+/**
+ * @brief Measure the thread scaling of volume fills and carving and print the results.
+ *
+ * Runs every workload with 1 to 64 OpenMP threads (doubling each step) and reports the best of
+ * several repetitions together with the speedup over a single thread. Carving is only measured
+ * when calibrated views with masks are given; its conversion to the rendered volume is timed separately.
+ *
+ * @param views Calibrated views with masks; may be empty.
+ * @param grid Reconstruction grid.
+ * @param strategy Carve strategy to measure.
+ */
+void run_benchmark(const std::vector<View>& views, const Grid& grid, CarveStrategy strategy);
+
+/**
+ * @brief Compare the fused foreground mask kernel with the OpenCV reference on a 4K image pair.
+ *
+ * Segments a synthetic 3840x2160 BGR foreground against its background with compute_mask_reference()
+ * and compute_mask() using all threads, prints the best time of both and checks the masks are identical.
+ * Also measures the fused kernel restricted to a region of a fifth of the frame, and training and
+ * segmentation of a Gaussian background model at 1920x1080.
+ */
+void run_mask_benchmark();
+
+/**
+ * @brief Compare silhouette rectangle queries of mask pyramids and integral images.
+ *
+ * Builds a MaskIntegral and a MaskPyramid of every view mask and classifies the footprints of all
+ * grid blocks of 16, 8 and 4 voxels with both (sizes needing too many queries are skipped). Prints build and query times, the queries the pyramid
+ * answers PARTIAL where the integral is exact, and any contradictions (expected to be 0).
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Reconstruction grid.
+ */
+void run_pyramid_benchmark(const std::vector<View>& views, const Grid& grid);
+
+/**
+ * @brief Check the batch voxel projection of every view against cv::projectPoints.
+ *
+ * Projects a strided sample of the grid voxels with the scalar code and with the AVX2 or NEON kernel
+ * (the scalar code again when neither is available) and prints the maximum pixel error of both per
+ * view, which passes when it is within PROJECTION_TOLERANCE.
+ *
+ * @param views Calibrated views.
+ * @param grid Reconstruction grid.
+ */
+void run_projection_check(const std::vector<View>& views, const Grid& grid);
+
+/**
+ * @brief Check incremental consensus updates against full re-carves after single-mask edits.
+ *
+ * Carves the views with the consensus strategy, then erodes the mask of one view after the other and
+ * applies every edit with Carver::update_view. Each result is compared voxel by voxel with a full
+ * consensus carve of the edited views. Prints the average time of both per edit and the number of
+ * updates that differ (expected to be 0).
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Reconstruction grid.
+ * @param min_views Views required per voxel (0 = all).
+ */
+void run_update_benchmark(const std::vector<View>& views, const Grid& grid, int min_views);
+
+/**
+ * @brief Compare the dense carve gather on byte masks and on tiled bit-packed masks.
+ *
+ * Projects the grid into every view and keeps the voxels seen as foreground by all views, once
+ * looking up 8-bit masks by row-major pixel index and once PackedMask tiles by bit address. Prints
+ * the best time of both, the packing time, the mask memory and the cache lines the voxels touch in
+ * each layout, which is where the speedup comes from, and checks both hulls match.
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Reconstruction grid.
+ */
+void run_packed_benchmark(const std::vector<View>& views, const Grid& grid);
+
+/**
+ * @brief Carve every frame of a capture sequence and compare seeded and independent carves.
+ *
+ * Each frame is carved once seeded by the hull of the previous frame (Carver::carve_band, falling
+ * back to a full carve when the seed is rejected) and once independently from scratch. Prints the
+ * tested voxels and wall time of both per frame with the number of voxels on which the two hulls
+ * differ, and the totals over the sequence.
+ *
+ * @param project Loaded and calibrated project with sequence frames.
+ * @param load_frame Callback loading the images and masks of a frame into the project views.
+ */
+void run_sequence_benchmark(const Project& project, const std::function<bool(int)>& load_frame);
+
+/**
+ * @brief Compare the polyhedral hull mesh with a dense voxel carve of the same grid.
+ *
+ * Builds the exact polyhedral hull and carves the grid densely, and prints the best time and the memory
+ * of both. The mesh is checked to be watertight (every directed edge has exactly one opposite edge) and
+ * its enclosed volume is compared with the volume of the carved voxels, which approaches it as the
+ * voxels shrink.
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Reconstruction grid.
+ */
+void run_polyhedral_benchmark(const std::vector<View>& views, const Grid& grid);
@@ -1,23 +1,22 @@
 #include "camera.hpp"
 
 #include <limits>
+#include <vector>
 #include <numbers>
 #include <iostream>
 #include <algorithm>
 
+#include <omp.h>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <opencv2/opencv.hpp>
 
 #include "global.hpp"
+#include "recon/mask.hpp"
 
 
-// Mask thresholding values
-constexpr const int THRESHOLD_H = 20;
-constexpr const int THRESHOLD_S = 20;
-constexpr const int THRESHOLD_V = 40;
-
 // Camera configuration constants
 constexpr const float FRUSTUM_DISTANCE = 100.0f;
 constexpr const float LOOK_AT_DISTANCE = 1000.0f;
@@ -58,9 +57,12 @@ void Camera::load_project(std::shared_ptr<Project> project) {
         read_calibration();
     }
 
-    // Ensure all views have valid calibration data
-    for (auto& view : project_->views) {
-        calibrate_view(view);
+    // Nested regions run on one thread, so views only go to separate threads when there are enough of
+    // them to fill all threads; otherwise they are prepared one after the other by the parallel mask kernels
+    const int num_views = static_cast<int>(project_->views.size());
+#pragma omp parallel for schedule(dynamic, 1) if (num_views >= omp_get_max_threads())
+    for (int i = 0; i < num_views; ++i) {
+        calibrate_view(project_->views[i]);
     }
 
     // Mark the project as initialized
@@ -172,6 +174,70 @@ void Camera::resize(int width, int height) {
     }
 }
 
+bool Camera::load_frame(int frame) {
+    if (frame < -1 || frame >= project_->frame_count) {
+        return false;
+    }
+
+    // Decode and segment the frame of every view, concurrently if the views fill all threads, else with
+    // the parallel mask kernel; the views only change once all succeeded
+    std::vector<View>& views = project_->views;
+    const int num_views = static_cast<int>(views.size());
+    std::vector<cv::Mat> images(num_views);
+    std::vector<cv::Mat> masks(num_views);
+
+#pragma omp parallel for schedule(dynamic, 1) if (num_views >= omp_get_max_threads())
+    for (int i = 0; i < num_views; ++i) {
+        const std::filesystem::path& path = frame < 0 ? views[i].fg_path : views[i].frame_paths[frame];
+        images[i] = cv::imread(path.string(), cv::IMREAD_UNCHANGED);
+        if (!images[i].empty() && images[i].size() == views[i].bg.size()) {
+            masks[i] = calc_mask(views[i], images[i]);
+        }
+    }
+
+    for (int i = 0; i < num_views; ++i) {
+        if (masks[i].empty()) {
+            std::cerr << "Frame image not found or not loadable: " << (frame < 0 ? views[i].fg_path : views[i].frame_paths[frame]) << std::endl;
+            return false;
+        }
+    }
+
+    for (int i = 0; i < num_views; ++i) {
+        views[i].fg = images[i];
+        views[i].mask = masks[i];
+    }
+
+    // Keep the active static view in sync with the new images
+    if (current_view_index_ >= 0) {
+        current_view_ = project_->views[current_view_index_];
+    }
+
+    return true;
+}
+
+bool Camera::load_view_frame(int view_index, int frame) {
+    if (view_index < 0 || view_index >= static_cast<int>(project_->views.size()) || frame < -1 || frame >= project_->frame_count) {
+        return false;
+    }
+
+    View& view = project_->views[view_index];
+    const std::filesystem::path& path = frame < 0 ? view.fg_path : view.frame_paths[frame];
+    cv::Mat image = cv::imread(path.string(), cv::IMREAD_UNCHANGED);
+    if (image.empty() || image.size() != view.bg.size()) {
+        std::cerr << "Frame image not found or not loadable: " << path << std::endl;
+        return false;
+    }
+
+    view.fg = image;
+    view.mask = calc_mask(view, image);
+
+    if (current_view_index_ == view_index) {
+        current_view_ = view;
+    }
+
+    return true;
+}
+
 
 /* Private methods */
 
@@ -203,9 +269,14 @@ void Camera::run_calibration() {
         );
     }
 
-    // Loop through each view to find chessboard corners
-    for (auto& view : project_->views) {
-        cv::Mat img = cv::imread(view.bg_path.string(), cv::IMREAD_GRAYSCALE);
+    // Find the chessboard corners of all views concurrently
+    const int num_views = static_cast<int>(project_->views.size());
+    std::vector<std::vector<cv::Point2f>> view_corners(num_views);
+    std::vector<cv::Mat> view_images(num_views);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < num_views; ++i) {
+        cv::Mat img = cv::imread(project_->views[i].bg_path.string(), cv::IMREAD_GRAYSCALE);
 
         std::vector<cv::Point2f> corners;
         int find_flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE;
@@ -215,9 +286,17 @@ void Camera::run_calibration() {
             // Refine corner locations
             cv::TermCriteria term_criteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.1);
             cv::cornerSubPix(img, corners, cv::Size(11, 11), cv::Size(-1, -1), term_criteria);
-            image_points.push_back(corners);
+            view_corners[i] = corners;
+            view_images[i] = img;
+        }
+    }
+
+    // Keep the detections in view order
+    for (int i = 0; i < num_views; ++i) {
+        if (!view_images[i].empty()) {
+            image_points.push_back(view_corners[i]);
             object_points.push_back(obj_points);
-            images.push_back(img);
+            images.push_back(view_images[i]);
         }
     }
 
@@ -333,8 +412,6 @@ void Camera::calibrate_view(View& view) const {
     view.focal_length = view.intrinsic(cv::Range(0,2), cv::Range(0,1)).clone();
     view.principal_point = view.intrinsic(cv::Range(0,2), cv::Range(2,3)).clone();
 
-    // Compute the mask for the foreground image based on the background image
-    view.mask = calc_mask(view.fg, view.bg);
 
     // Compute field of view
     view.fov = calc_fov(static_cast<float>(view.intrinsic.at<double>(0, 0)), view_width);
@@ -348,6 +425,18 @@ void Camera::calibrate_view(View& view) const {
     center = -rotation.t() * view.tvec;
     view.tvec_proj = -rotation * center;
 
+    // Single-precision copy of the calibration for batch voxel projection
+    view.pinhole = PinholeModel::from_calibration(view.rvec, view.tvec_proj, view.intrinsic, view.distortion);
+
+    // Only the image region of the reconstruction grid can affect a carve, so masks are segmented there
+    view.mask_roi = grid_image_bounds(view.pinhole, project_->grid, view.bg.size());
+    if (project_->mask_model == MaskModel::GAUSSIAN) {
+        view.background = learn_background(view);
+    }
+
+    // Compute the mask for the foreground image based on the background
+    view.mask = calc_mask(view, view.fg);
+
     // Convert camera center and rotation to float for OpenGL compatibility
     center.convertTo(center, CV_32F);
     rotation.convertTo(rotation, CV_32F);
@@ -368,42 +457,26 @@ void Camera::calibrate_view(View& view) const {
     }
 }
 
-cv::Mat Camera::calc_mask(const cv::Mat& fg_img, const cv::Mat& bg_img) const {
-    cv::Mat mask;
-    cv::Mat fg_hsv, bg_hsv;
-    cv::Mat diff_h, diff_s, diff_v;
-    cv::Mat mask_h, mask_s, mask_v;
-    std::vector<cv::Mat> fg_channels, bg_channels;
-
-    // Convert images to HSV
-    cv::cvtColor(fg_img, fg_hsv, cv::COLOR_BGR2HSV);
-    cv::cvtColor(bg_img, bg_hsv, cv::COLOR_BGR2HSV);
-
-    // Split HSV channels
-    cv::split(fg_hsv, fg_channels);
-    cv::split(bg_hsv, bg_channels);
-
-    // Compute absolute differences for each channel
-    cv::absdiff(fg_channels[0], bg_channels[0], diff_h);
-    cv::absdiff(fg_channels[1], bg_channels[1], diff_s);
-    cv::absdiff(fg_channels[2], bg_channels[2], diff_v);
-
-    // Threshold each channel
-    double maxval = static_cast<double>(std::numeric_limits<uint8_t>::max());
-    cv::threshold(diff_h, mask_h, THRESHOLD_H, maxval, cv::THRESH_BINARY);
-    cv::threshold(diff_s, mask_s, THRESHOLD_S, maxval, cv::THRESH_BINARY);
-    cv::threshold(diff_v, mask_v, THRESHOLD_V, maxval, cv::THRESH_BINARY);
-
-    // Combine masks: (H AND S) OR V
-    cv::bitwise_and(mask_h, mask_s, mask);
-    cv::bitwise_or(mask, mask_v, mask);
-
-    // Morphological operations to clean up the mask
-    cv::erode(mask, mask, cv::Mat());
-    cv::dilate(mask, mask, cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(5, 5)), cv::Point(-1, -1), 2);
-    cv::erode(mask, mask, cv::Mat());
-
-    return mask;
+cv::Mat Camera::calc_mask(const View& view, const cv::Mat& fg_img) const {
+    if (view.background) {
+        return view.background->segment(fg_img);
+    }
+    return compute_mask(fg_img, view.bg, view.mask_roi);
+}
+
+std::shared_ptr<const BackgroundModel> Camera::learn_background(const View& view) const {
+    auto model = std::make_shared<BackgroundModel>();
+    model->set_sigmas(project_->background_sigmas);
+    model->set_region(view.mask_roi);
+    model->add_frame(view.bg);
+
+    for (const auto& path : view.bg_frame_paths) {
+        if (!model->add_frame(cv::imread(path.string(), cv::IMREAD_UNCHANGED))) {
+            std::cerr << "Skipping background frame that is not loadable or of a different size: " << path << std::endl;
+        }
+    }
+
+    return model;
 }
 
 float Camera::calc_fov(float focal_length, float view_width) const {
@@ -21,6 +21,10 @@ public: // Constructors
 public: // Methods
     /**
      * @brief Load a project and initialize camera parameters.
+     *
+     * Chessboard detection and the per-view preparation (mask, pinhole model, projection) run
+     * concurrently across the views.
+     *
      * @param project Shared pointer to the project to load.
      */
     void load_project(std::shared_ptr<Project> project);
@@ -54,6 +58,27 @@ public: // Methods
      */
     void resize(int width, int height);
 
+    /**
+     * @brief Load the foreground images of a sequence frame and recompute the masks of all views.
+     *
+     * The views are decoded and segmented concurrently and only updated once all images loaded.
+     *
+     * @param frame Frame index (0 to frame_count - 1), or -1 for the project foreground images.
+     * @return True if the images of all views were loaded.
+     */
+    bool load_frame(int frame);
+
+    /**
+     * @brief Reload the foreground image of one view from disk and recompute its mask.
+     *
+     * Picks up edits of the image file, e.g. a retouched frame, without reloading the other views.
+     *
+     * @param view_index Index of the view.
+     * @param frame Frame index (0 to frame_count - 1), or -1 for the project foreground image.
+     * @return True if the image was loaded.
+     */
+    bool load_view_frame(int view_index, int frame);
+
 public: // Methods
     /**
      * @brief Get the current camera view (OpenGL coordinate system).
@@ -106,18 +131,28 @@ private: // Methods
     void write_calibration();
 
     /**
-     * @brief Compute the mask and OpenGL transformation for a given view.
+     * @brief Compute the mask, batch projection model and OpenGL transformation for a given view.
      * @param view View to calibrate.
      */
     void calibrate_view(View& view) const;
 
     /**
-     * @brief Calculate the mask from foreground and background images.
+     * @brief Learn the Gaussian background model of a view within its mask region.
+     * @param view View with the background image, additional background frames and mask region.
+     * @return Background model.
+     */
+    std::shared_ptr<const BackgroundModel> learn_background(const View& view) const;
+
+    /**
+     * @brief Calculate the mask of a foreground image against the background model or image of a view.
+     *
+     * Only the mask region of the view is segmented; the rest of the mask is background.
+     *
+     * @param view View with the background image and optional background model.
      * @param fg_img Foreground image.
-     * @param bg_img Background image.
      * @return Mask image.
      */
-    cv::Mat calc_mask(const cv::Mat& fg_img, const cv::Mat& bg_img) const;
+    cv::Mat calc_mask(const View& view, const cv::Mat& fg_img) const;
 
     /**
      * @brief Calculate the field of view based on focal length and view width.
@@ -0,0 +1,147 @@
+#include "coordinator.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <iostream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+#include "recon/slab.hpp"
+#include "recon/bounds.hpp"
+
+
+/* Functions */
+
+#ifdef _WIN32
+/** @brief Quote an argument so the C runtime of the worker parses it back unchanged. */
+static std::string quote_argument(const std::string& arg) {
+    // Backslashes are literal unless they precede a quote, which is escaped by doubling them
+    std::string quoted = "\"";
+    size_t backslashes = 0;
+    for (char c : arg) {
+        if (c == '\\') {
+            ++backslashes;
+            continue;
+        }
+        quoted.append(c == '"' ? 2 * backslashes + 1 : backslashes, '\\');
+        quoted += c;
+        backslashes = 0;
+    }
+    quoted.append(2 * backslashes, '\\');
+    return quoted + "\"";
+}
+#endif
+
+int run_local_worker(const std::string&, const std::vector<std::string>& args) {
+    if (args.empty()) {
+        return -1;
+    }
+
+#ifdef _WIN32
+    // _spawnv joins the arguments into one command line, which the worker splits again
+    std::vector<std::string> quoted;
+    for (const std::string& arg : args) {
+        quoted.push_back(quote_argument(arg));
+    }
+    std::vector<const char*> argv;
+    for (const std::string& arg : quoted) {
+        argv.push_back(arg.c_str());
+    }
+    argv.push_back(nullptr);
+
+    return static_cast<int>(_spawnv(_P_WAIT, args[0].c_str(), argv.data()));
+#else
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    if (posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0) {
+        return -1;
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+bool run_coordinator(const Project& project, const CoordinatorConfig& config, const WorkerTransport& transport, OccupancyGrid& occupancy) {
+    if (config.hosts.empty()) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const Grid grid = carve_bounds(project.views, project.grid, project.tight_bounds, project.strategy);
+    const std::vector<int> bounds = balance_slabs(project.views, grid, static_cast<int>(config.hosts.size()));
+    const int num_slabs = static_cast<int>(bounds.size()) - 1;
+
+    std::cout << "Coordinator: " << grid.num_x << "x" << grid.num_y << "x" << grid.num_z << " voxels in "
+              << num_slabs << " slabs" << std::endl;
+
+    std::filesystem::create_directories(config.work_dir);
+
+    // One command per slab; the workers derive the same carve grid from the project
+    std::vector<std::filesystem::path> files(num_slabs);
+    std::vector<std::vector<std::string>> commands(num_slabs);
+    for (int s = 0; s < num_slabs; ++s) {
+        files[s] = config.work_dir / (project.name + "_slab" + std::to_string(s) + ".bin");
+
+        std::vector<std::string>& command = commands[s];
+        command.push_back(config.executable.string());
+        command.insert(command.end(), config.worker_args.begin(), config.worker_args.end());
+        command.insert(command.end(), { "--worker", std::to_string(bounds[s]) + ":" + std::to_string(bounds[s + 1]) });
+        command.insert(command.end(), { "--slab-output", files[s].string() });
+        if (config.threads_per_worker > 0) {
+            command.insert(command.end(), { "--threads", std::to_string(config.threads_per_worker) });
+        }
+
+        std::cout << "  slab " << s << " on " << config.hosts[s] << ": layers " << bounds[s] << "-" << bounds[s + 1] - 1 << std::endl;
+    }
+
+    // Workers run concurrently; each call blocks until its worker exits
+    std::vector<int> results(num_slabs, -1);
+    std::vector<std::thread> threads;
+    threads.reserve(num_slabs);
+    for (int s = 0; s < num_slabs; ++s) {
+        threads.emplace_back([&, s]() { results[s] = transport(config.hosts[s], commands[s]); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    bool merged = true;
+    occupancy.reset(grid);
+    for (int s = 0; s < num_slabs; ++s) {
+        if (results[s] != 0) {
+            std::cerr << "Worker for slab " << s << " on " << config.hosts[s] << " failed with exit code " << results[s] << std::endl;
+            merged = false;
+        }
+        else {
+            merged = merge_slab(files[s], occupancy) && merged;
+        }
+
+        std::error_code error;
+        std::filesystem::remove(files[s], error);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (merged) {
+        std::cout << "Coordinator: " << occupancy.count() << " occupied voxels from " << num_slabs << " workers in " << ms << " ms" << std::endl;
+    }
+    return merged;
+}
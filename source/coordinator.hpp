@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+#include "project.hpp"
+#include "recon/occupancy.hpp"
+
+
+/**
+ * @brief Transport running one worker command for a host.
+ *
+ * Takes the host name and the worker argument vector (executable first) and returns the worker's exit
+ * code. Arguments may contain any character, so a transport going through a shell must quote them.
+ */
+using WorkerTransport = std::function<int(const std::string& host, const std::vector<std::string>& args)>;
+
+
+/**
+ * @struct CoordinatorConfig
+ * @brief Worker setup of a slab-partitioned reconstruction.
+ *
+ * Members:
+ * - executable: Worker executable (this program).
+ * - worker_args: Arguments passed to every worker: the project file and the reconstruction overrides.
+ * - hosts: One worker and slab per host.
+ * - threads_per_worker: OpenMP threads per worker (0 = all processors of the host).
+ * - work_dir: Directory of the slab files exchanged with the workers.
+ */
+struct CoordinatorConfig {
+    std::filesystem::path executable;       // Worker executable
+    std::vector<std::string> worker_args;   // Arguments shared by all workers
+    std::vector<std::string> hosts;         // Worker hosts
+    int threads_per_worker = 0;             // Threads per worker
+    std::filesystem::path work_dir;         // Slab file directory
+};
+
+
+/**
+ * @brief Run a worker command on this machine.
+ *
+ * Stand-in for remote transports: a remote transport would run the same command on the host (with the
+ * project and work directory on a shared file system); this one runs it locally whatever the host.
+ * The worker is spawned directly from the argument vector, without a shell.
+ *
+ * @param host Host name, unused.
+ * @param args Worker executable followed by its arguments.
+ * @return Exit code of the worker, or -1 if it could not be started or did not exit normally.
+ */
+int run_local_worker(const std::string& host, const std::vector<std::string>& args);
+
+/**
+ * @brief Carve a project in Z slabs on worker processes and merge the slabs.
+ *
+ * The carve grid is split into one slab per host, balanced by a coarse pre-pass (balance_slabs).
+ * Every worker runs this program with --worker on its slab range and writes the slab occupancy to a
+ * file in the work directory; the coordinator waits for all workers, then merges the files.
+ *
+ * @param project Loaded project; its views, grid and bounds setting select the carve grid, as in the workers.
+ * @param config Worker setup.
+ * @param transport Transport running the worker commands.
+ * @param occupancy Output occupancy of the carve grid.
+ * @return False if a worker failed or a slab could not be merged.
+ */
+bool run_coordinator(const Project& project, const CoordinatorConfig& config, const WorkerTransport& transport, OccupancyGrid& occupancy);
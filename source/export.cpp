@@ -0,0 +1,240 @@
+#include "export.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <omp.h>
+
+#include "recon/shell.hpp"
+
+
+// Width reserved for the vertex count of streamed PLY headers, patched once all bricks are written
+constexpr const int EXPORT_COUNT_WIDTH = 20;
+
+
+/* Functions */
+
+bool export_ply(const std::filesystem::path& file, const Grid& grid, const std::vector<uint32_t>& indices, const std::vector<uint8_t>* faces) {
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Could not open export file: " << file << std::endl;
+        return false;
+    }
+
+    stream << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex " << indices.size() << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n";
+    if (faces) {
+        stream << "property uchar faces\n";
+    }
+    stream << "end_header\n";
+
+    // Encode all records in parallel, then write them in one call
+    const size_t record_size = 3 * sizeof(float) + (faces ? 1 : 0);
+    std::vector<char> records(indices.size() * record_size);
+
+    const int count = static_cast<int>(indices.size());
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; ++i) {
+        const glm::vec3 position = grid.position(grid.coordinates(indices[i]));
+
+        char* record = records.data() + static_cast<size_t>(i) * record_size;
+        std::memcpy(record, &position.x, 3 * sizeof(float));
+        if (faces) {
+            record[3 * sizeof(float)] = static_cast<char>((*faces)[i]);
+        }
+    }
+
+    stream.write(records.data(), static_cast<std::streamsize>(records.size()));
+    return static_cast<bool>(stream);
+}
+
+bool export_mesh_ply(const std::filesystem::path& file, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals,
+    const std::vector<uint32_t>& triangles) {
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Could not open export file: " << file << std::endl;
+        return false;
+    }
+
+    const size_t num_triangles = triangles.size() / 3;
+    stream << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex " << vertices.size() << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n"
+           << "property float nx\n"
+           << "property float ny\n"
+           << "property float nz\n"
+           << "element face " << num_triangles << "\n"
+           << "property list uchar uint vertex_indices\n"
+           << "end_header\n";
+
+    const size_t vertex_size = 6 * sizeof(float);
+    const size_t face_size = 1 + 3 * sizeof(uint32_t);
+    std::vector<char> records(vertices.size() * vertex_size + num_triangles * face_size);
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        char* record = records.data() + i * vertex_size;
+        std::memcpy(record, &vertices[i].x, 3 * sizeof(float));
+        std::memcpy(record + 3 * sizeof(float), &normals[i].x, 3 * sizeof(float));
+    }
+
+    char* faces = records.data() + vertices.size() * vertex_size;
+    for (size_t t = 0; t < num_triangles; ++t) {
+        char* record = faces + t * face_size;
+        record[0] = 3;
+        std::memcpy(record + 1, &triangles[t * 3], 3 * sizeof(uint32_t));
+    }
+
+    stream.write(records.data(), static_cast<std::streamsize>(records.size()));
+    return static_cast<bool>(stream);
+}
+
+// Or a brick row into a padded row, shifted by one voxel along X
+static void shift_row(uint64_t bits, OccupancyGrid& padded, int y, int z) {
+    uint64_t* words = padded.row(y, z);
+    words[0] |= bits << 1;
+    if (padded.words_per_row() > 1) {
+        words[1] |= bits >> 63;
+    }
+}
+
+// Copy one layer of a brick into a padded brick grid, shifted by one voxel along X
+static void pad_layer(const OccupancyGrid& brick, OccupancyGrid& padded, int axis, int from, int to) {
+    const Grid& layout = brick.grid();
+    const int num_y = axis == 1 ? 1 : layout.num_y;
+    const int num_z = axis == 2 ? 1 : layout.num_z;
+
+    for (int z = 0; z < num_z; ++z) {
+        for (int y = 0; y < num_y; ++y) {
+            const int src_y = axis == 1 ? from : y;
+            const int src_z = axis == 2 ? from : z;
+            const int dst_y = axis == 1 ? to : y + 1;
+            const int dst_z = axis == 2 ? to : z + 1;
+
+            uint64_t bits = brick.row(src_y, src_z)[0];
+            if (axis == 0) {
+                // Only the voxel at X = from, placed at X = to
+                bits = (bits >> from) & 1;
+                padded.row(dst_y, dst_z)[to >> 6] |= bits << (to & 63);
+            }
+            else {
+                shift_row(bits, padded, dst_y, dst_z);
+            }
+        }
+    }
+}
+
+bool export_bricks_ply(const std::filesystem::path& file, BrickStore& store, bool shell) {
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Could not open export file: " << file << std::endl;
+        return false;
+    }
+
+    // The shell size is only known once every brick has been visited, so the count is patched in afterwards
+    stream << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex ";
+    const std::streampos count_position = stream.tellp();
+    stream << std::string(EXPORT_COUNT_WIDTH, ' ') << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n";
+    if (shell) {
+        stream << "property uchar faces\n";
+    }
+    stream << "end_header\n";
+
+    const size_t record_size = 3 * sizeof(float) + (shell ? 1 : 0);
+    const glm::ivec3 counts = store.brick_counts();
+    size_t written = 0;
+
+    std::vector<char> records;
+    SurfaceShell surface;
+    OccupancyGrid padded;
+
+    for (const glm::ivec3& brick : store.stored_bricks()) {
+        std::shared_ptr<const OccupancyGrid> occupancy = store.load(brick);
+        if (!occupancy) {
+            continue;
+        }
+        const Grid& layout = occupancy->grid();
+        records.clear();
+
+        if (!shell) {
+            records.resize(occupancy->count() * record_size);
+            char* record = records.data();
+            occupancy->for_each([&](int x, int y, int z) {
+                const glm::vec3 position = layout.position(x, y, z);
+                std::memcpy(record, &position.x, 3 * sizeof(float));
+                record += record_size;
+            });
+        }
+        else {
+            // Brick with a one-voxel border holding the facing layers of the neighbor bricks
+            padded.reset(layout.subgrid(glm::ivec3(-1), glm::ivec3(layout.num_x + 1, layout.num_y + 1, layout.num_z + 1)));
+            for (int z = 0; z < layout.num_z; ++z) {
+                for (int y = 0; y < layout.num_y; ++y) {
+                    shift_row(occupancy->row(y, z)[0], padded, y + 1, z + 1);
+                }
+            }
+
+            for (int axis = 0; axis < 3; ++axis) {
+                for (int side = -1; side <= 1; side += 2) {
+                    glm::ivec3 neighbor = brick;
+                    neighbor[axis] += side;
+                    if (neighbor[axis] < 0 || neighbor[axis] >= counts[axis]) {
+                        continue;
+                    }
+
+                    std::shared_ptr<const OccupancyGrid> other = store.load(neighbor);
+                    if (!other) {
+                        continue;
+                    }
+
+                    const int size = axis == 0 ? layout.num_x : axis == 1 ? layout.num_y : layout.num_z;
+                    const int other_size = axis == 0 ? other->grid().num_x : axis == 1 ? other->grid().num_y : other->grid().num_z;
+                    pad_layer(*other, padded, axis, side < 0 ? other_size - 1 : 0, side < 0 ? 0 : size + 1);
+                }
+            }
+
+            surface.build(padded);
+
+            // Keep the shell voxels of the brick itself, not of its border
+            const Grid& pad = padded.grid();
+            const std::vector<uint32_t>& indices = surface.indices();
+            records.resize(indices.size() * record_size);
+            size_t kept = 0;
+            for (size_t i = 0; i < indices.size(); ++i) {
+                const int index = static_cast<int>(indices[i]);
+                const int x = index % pad.num_x;
+                const int y = (index / pad.num_x) % pad.num_y;
+                const int z = index / (pad.num_x * pad.num_y);
+                if (x < 1 || y < 1 || z < 1 || x > layout.num_x || y > layout.num_y || z > layout.num_z) {
+                    continue;
+                }
+
+                const glm::vec3 position = pad.position(x, y, z);
+                char* record = records.data() + kept * record_size;
+                std::memcpy(record, &position.x, 3 * sizeof(float));
+                record[3 * sizeof(float)] = static_cast<char>(surface.faces()[i]);
+                ++kept;
+            }
+            records.resize(kept * record_size);
+        }
+
+        stream.write(records.data(), static_cast<std::streamsize>(records.size()));
+        written += records.size() / record_size;
+    }
+
+    stream.seekp(count_position);
+    stream << written;
+    return static_cast<bool>(stream);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "recon/grid.hpp"
+#include "recon/brick.hpp"
+
+
+/**
+ * @brief Write voxel centers as a binary little-endian PLY point cloud.
+ *
+ * Positions are OpenCV world coordinates in millimeters. When face masks are given, every vertex also
+ * carries a "faces" byte with the exposed faces of the voxel (SHELL_FACE_* bits).
+ *
+ * @param file Output file.
+ * @param grid Grid layout of the voxel indices.
+ * @param indices Linear voxel indices (X fastest).
+ * @param faces Exposed-face mask per voxel, parallel to indices; may be null.
+ * @return True if the file was written.
+ */
+bool export_ply(const std::filesystem::path& file, const Grid& grid, const std::vector<uint32_t>& indices, const std::vector<uint8_t>* faces);
+
+/**
+ * @brief Write a triangle mesh as a binary little-endian PLY file.
+ *
+ * Positions are OpenCV world coordinates in millimeters; every vertex also carries its normal.
+ *
+ * @param file Output file.
+ * @param vertices Vertex positions.
+ * @param normals Vertex normals, parallel to vertices.
+ * @param triangles Vertex indices, three per triangle.
+ * @return True if the file was written.
+ */
+bool export_mesh_ply(const std::filesystem::path& file, const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals,
+    const std::vector<uint32_t>& triangles);
+
+/**
+ * @brief Write the voxels of a brick store as a binary little-endian PLY point cloud, brick by brick.
+ *
+ * Bricks are paged in one at a time through the store cache, so memory stays within its budget for any
+ * grid size. Shell exports pad every brick with the boundary layers of its six neighbor bricks to find
+ * the exposed faces across brick borders.
+ *
+ * @param file Output file.
+ * @param store Finished brick store.
+ * @param shell True to write only shell voxels with their "faces" byte, false to write all occupied voxels.
+ * @return True if the file was written.
+ */
+bool export_bricks_ply(const std::filesystem::path& file, BrickStore& store, bool shell);
@@ -16,6 +16,12 @@ std::string get_executable_dir() {
     return (std::string::npos == pos) ? "" : path.substr(0, pos);
 }
 
+std::string get_executable_path() {
+    char buffer[MAX_PATH];
+    ::GetModuleFileNameA(NULL, buffer, MAX_PATH);
+    return std::string(buffer);
+}
+
 std::string open_project_file_dialog() {
     char filename[MAX_PATH] = {0};
     OPENFILENAMEA ofn = {0};
@@ -34,6 +34,12 @@ struct AppContext {
  */
 std::string get_executable_dir();
 
+/**
+ * @brief Get the full path of the current executable.
+ * @return Path to the executable file.
+ */
+std::string get_executable_path();
+
 /**
  * @brief Open a file dialog to select a project file.
  * @return Path to the selected project file.
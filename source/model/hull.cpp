@@ -0,0 +1,45 @@
+#include "hull.hpp"
+
+#include "render/mesh.hpp"
+#include "render/shader.hpp"
+
+
+/* Constructors */
+
+Hull::Hull(const PolyhedralHull& hull) : Model(ModelType::MESH_BASED) {
+    // OpenCV X, Z, -Y become OpenGL X, Y, Z; this is a rotation, so the triangle winding is kept
+    positions_.reserve(hull.vertices().size());
+    normals_.reserve(hull.normals().size());
+    for (const glm::vec3& p : hull.vertices()) {
+        positions_.emplace_back(p.x, p.z, -p.y);
+    }
+    for (const glm::vec3& n : hull.normals()) {
+        normals_.emplace_back(n.x, n.z, -n.y);
+    }
+    indices_.assign(hull.triangles().begin(), hull.triangles().end());
+}
+
+
+/* Public methods */
+
+void Hull::initialize() {
+    build_hull_mesh();
+}
+
+
+/* Private methods */
+
+void Hull::build_hull_mesh() {
+    clear_meshes();
+
+    if (indices_.empty()) {
+        return;
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->set_vertices(positions_, normals_);
+    mesh->set_indices(indices_);
+    mesh->set_primitive_type(PrimitiveType::TRIANGLES);
+    mesh->upload_to_gpu();
+    add_mesh(mesh);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "model.hpp"
+#include "recon/polyhedral.hpp"
+
+
+/**
+ * @class Hull
+ * @brief Triangle mesh of a polyhedral visual hull, rendered with lighting.
+ */
+class Hull : public Model {
+public: // Constructors
+    /**
+     * @brief Construct a hull model from a polyhedral hull mesh.
+     * @param hull Hull mesh in OpenCV world coordinates.
+     */
+    Hull(const PolyhedralHull& hull);
+
+    /** @brief Destructor. Cleans up resources. */
+    ~Hull() = default;
+
+public: // Methods
+    /** @brief Initialize the hull model. */
+    void initialize() override;
+
+public: // Getters
+    /** @brief Get the number of triangles. */
+    size_t triangle_count() const { return indices_.size() / 3; }
+
+private: // Methods
+    /** @brief Build the hull mesh for rendering. */
+    void build_hull_mesh();
+
+private: // Variables
+    std::vector<glm::vec3> positions_;      // Vertex positions (OpenGL coordinates)
+    std::vector<glm::vec3> normals_;        // Vertex normals (OpenGL coordinates)
+    std::vector<unsigned int> indices_;     // Triangle indices
+};
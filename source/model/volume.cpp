@@ -43,7 +43,12 @@ std::unique_ptr<Volume> Volume::create_plane(int width, int height, const glm::v
 
 /* Constructors */
 
-Volume::Volume(int width, int height, int depth, float voxel_size) 
+Volume::Volume(int width, int height, int depth, float voxel_size)
+: Volume(width, height, depth, voxel_size, glm::vec3(-width * 0.5f * voxel_size, -height * 0.5f * voxel_size, 0.0f))
+{
+}
+
+Volume::Volume(int width, int height, int depth, float voxel_size, const glm::vec3& origin)
 : Model(ModelType::VOLUME_BASED)
 , gpu_data_dirty_(true)
 , volume_texture_dirty_(true)
@@ -51,8 +56,12 @@ Volume::Volume(int width, int height, int depth, float voxel_size)
 , height_(height)
 , depth_(depth)
 , voxel_size_(voxel_size)
+, origin_(origin)
+, active_voxel_count_(0)
+, active_indices_dirty_(false)
 , rendered_voxel_count_(0)
 , render_mode_(VolumeRenderMode::VOXEL_CUBES)
+, render_source_(VolumeRenderSource::ALL)
 {
     voxels_.resize(width_ * height_ * depth_);
     for (int z = 0; z < depth_; ++z) {
@@ -86,6 +95,11 @@ void Volume::set_voxel(int x, int y, int z, const Voxel &voxel) {
     }
 
     size_t index = get_index(x, y, z);
+    active_voxel_count_ += static_cast<size_t>(voxel.active) - static_cast<size_t>(voxels_[index].active);
+    if (voxel.active != voxels_[index].active) {
+        active_indices_dirty_ = true;
+        shell_indices_.clear();
+    }
     voxels_[index] = voxel;
     voxels_[index].position = voxel_to_world(x, y, z); // Ensure position is correct
     gpu_data_dirty_ = true;
@@ -98,6 +112,11 @@ void Volume::set_voxel_active(int x, int y, int z, bool active) {
     }
 
     size_t index = get_index(x, y, z);
+    active_voxel_count_ += static_cast<size_t>(active) - static_cast<size_t>(voxels_[index].active);
+    if (active != voxels_[index].active) {
+        active_indices_dirty_ = true;
+        shell_indices_.clear();
+    }
     voxels_[index].active = active;
 
     gpu_data_dirty_ = true;
@@ -125,12 +144,55 @@ void Volume::set_voxel_density(int x, int y, int z, float density) {
     volume_texture_dirty_ = true;
 }
 
+void Volume::commit() {
+    rebuild_active_indices();
+    shell_indices_.clear();
+
+    active_voxel_count_ = active_indices_.size();
+    gpu_data_dirty_ = true;
+    volume_texture_dirty_ = true;
+}
+
+void Volume::assign_active(std::vector<uint32_t> indices, const glm::vec4 &color) {
+    for (uint32_t index : active_indices()) {
+        voxels_[index].active = false;
+    }
+
+    for (uint32_t index : indices) {
+        voxels_[index].active = true;
+        voxels_[index].color = color;
+    }
+
+    active_indices_ = std::move(indices);
+    active_indices_dirty_ = false;
+    shell_indices_.clear();
+    active_voxel_count_ = active_indices_.size();
+    gpu_data_dirty_ = true;
+    volume_texture_dirty_ = true;
+}
+
+void Volume::assign_colors(const std::vector<uint32_t> &indices, const std::vector<glm::vec4> &colors) {
+    const int count = static_cast<int>(std::min(indices.size(), colors.size()));
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; ++i) {
+        voxels_[indices[i]].color = colors[i];
+    }
+
+    gpu_data_dirty_ = true;
+    volume_texture_dirty_ = true;
+}
+
 void Volume::clear_all() {
     for (auto &voxel : voxels_) {
         voxel.active = false;
         voxel.color = glm::vec4(1.0f);
         voxel.density = 0.0f;
     }
+    active_voxel_count_ = 0;
+    active_indices_.clear();
+    active_indices_dirty_ = false;
+    shell_indices_.clear();
 
     gpu_data_dirty_ = true;
     volume_texture_dirty_ = true;
@@ -140,6 +202,9 @@ void Volume::activate_all() {
     for (auto &voxel : voxels_) {
         voxel.active = true;
     }
+    active_voxel_count_ = voxels_.size();
+    active_indices_dirty_ = true;
+    shell_indices_.clear();
     gpu_data_dirty_ = true;
 }
 
@@ -147,6 +212,10 @@ void Volume::deactivate_all() {
     for (auto &voxel : voxels_) {
         voxel.active = false;
     }
+    active_voxel_count_ = 0;
+    active_indices_.clear();
+    active_indices_dirty_ = false;
+    shell_indices_.clear();
     gpu_data_dirty_ = true;
 }
 
@@ -161,47 +230,34 @@ void Volume::set_all_color(const glm::vec4 &color) {
 void Volume::fill_sphere(const glm::vec3 &center, float radius, const glm::vec4 &color) {
     float radius_squared = radius * radius;
 
-    for (int z = 0; z < depth_; ++z) {
-        for (int y = 0; y < height_; ++y) {
-            for (int x = 0; x < width_; ++x) {
-                glm::vec3 voxel_pos = voxel_to_world(x, y, z);
-                glm::vec3 diff = voxel_pos - center;
-                float distance_squared = glm::dot(diff, diff);
-
-                if (distance_squared <= radius_squared) {
-                    size_t index = get_index(x, y, z);
-                    voxels_[index].active = true;
-                    voxels_[index].color = color;
-                    voxels_[index].density = 1.0f - (std::sqrt(distance_squared) / radius);
-                }
+    fill_rows([&](int, int, Voxel *row) {
+        for (int x = 0; x < width_; ++x) {
+            glm::vec3 diff = row[x].position - center;
+            float distance_squared = glm::dot(diff, diff);
+
+            if (distance_squared <= radius_squared) {
+                row[x].active = true;
+                row[x].color = color;
+                row[x].density = 1.0f - (std::sqrt(distance_squared) / radius);
             }
         }
-    }
-
-    gpu_data_dirty_ = true;
-    volume_texture_dirty_ = true;
+    });
 }
 
 void Volume::fill_box(const glm::vec3 &min_pos, const glm::vec3 &max_pos, const glm::vec4 &color) {
-    for (int z = 0; z < depth_; ++z) {
-        for (int y = 0; y < height_; ++y) {
-            for (int x = 0; x < width_; ++x) {
-                glm::vec3 voxel_pos = voxel_to_world(x, y, z);
-
-                if (voxel_pos.x >= min_pos.x && voxel_pos.x <= max_pos.x 
-                ||  voxel_pos.y >= min_pos.y && voxel_pos.y <= max_pos.y
-                ||  voxel_pos.z >= min_pos.z && voxel_pos.z <= max_pos.z) {
-                    size_t index = get_index(x, y, z);
-                    voxels_[index].active = true;
-                    voxels_[index].color = color;
-                    voxels_[index].density = 1.0f;
-                }
+    fill_rows([&](int, int, Voxel *row) {
+        for (int x = 0; x < width_; ++x) {
+            const glm::vec3 &voxel_pos = row[x].position;
+
+            if (voxel_pos.x >= min_pos.x && voxel_pos.x <= max_pos.x 
+            ||  voxel_pos.y >= min_pos.y && voxel_pos.y <= max_pos.y
+            ||  voxel_pos.z >= min_pos.z && voxel_pos.z <= max_pos.z) {
+                row[x].active = true;
+                row[x].color = color;
+                row[x].density = 1.0f;
             }
         }
-    }
-
-    gpu_data_dirty_ = true;
-    volume_texture_dirty_ = true;
+    });
 }
 
 void Volume::upload_to_gpu() {
@@ -237,7 +293,7 @@ void Volume::upload_to_gpu() {
 }
 
 void Volume::update_active_voxels() {
-    rendered_voxel_count_ = std::count_if(voxels_.begin(), voxels_.end(), [](const Voxel& v) { return v.active; });
+    rendered_voxel_count_ = render_indices().size();
     gpu_data_dirty_ = true;
 }
 
@@ -248,6 +304,21 @@ void Volume::set_render_mode(VolumeRenderMode mode) {
     }
 }
 
+void Volume::set_shell(std::vector<uint32_t> indices) {
+    shell_indices_ = std::move(indices);
+
+    if (render_source_ == VolumeRenderSource::SHELL) {
+        gpu_data_dirty_ = true;
+    }
+}
+
+void Volume::set_render_source(VolumeRenderSource source) {
+    if (render_source_ != source) {
+        render_source_ = source;
+        gpu_data_dirty_ = true; // Mark for re-upload with the new voxel subset
+    }
+}
+
 void Volume::bind() const {
     // Check if OpenGL context is available
     if (!glewIsSupported("GL_VERSION_3_0")) {
@@ -316,9 +387,9 @@ glm::vec3 Volume::voxel_to_world(int x, int y, int z) const {
     // OpenGL X = OpenCV X
     // OpenGL Y = OpenCV Z (OpenCV Z+ becomes OpenGL Y+)
     // OpenGL Z = -OpenCV Y (OpenCV Y+ becomes OpenGL Z-)
-    float world_x = (x - width_ * 0.5f) * voxel_size_;
-    float world_y = z * voxel_size_ + voxel_size_ * 0.5f; // OpenCV Z becomes OpenGL Y (up), raised by half voxel to sit on floor
-    float world_z = -(y - height_ * 0.5f) * voxel_size_; // OpenCV Y becomes -OpenGL Z
+    float world_x = origin_.x + x * voxel_size_;
+    float world_y = origin_.z + z * voxel_size_ + voxel_size_ * 0.5f; // OpenCV Z becomes OpenGL Y (up), raised by half voxel to sit on floor
+    float world_z = -(origin_.y + y * voxel_size_); // OpenCV Y becomes -OpenGL Z
     return glm::vec3(world_x, world_y, world_z);
 }
 
@@ -333,9 +404,9 @@ glm::ivec3 Volume::world_to_voxel(const glm::vec3 &world_pos) const {
     float world_z = world_pos.z;
     
     // Convert to voxel indices
-    int x = static_cast<int>(std::round(world_x / voxel_size_ + width_ * 0.5f));
-    int z = static_cast<int>(std::round(world_y / voxel_size_)); // OpenGL Y becomes OpenCV Z
-    int y = static_cast<int>(std::round(-world_z / voxel_size_ + height_ * 0.5f)); // OpenGL Z becomes OpenCV Y
+    int x = static_cast<int>(std::round((world_x - origin_.x) / voxel_size_));
+    int z = static_cast<int>(std::round((world_y - origin_.z) / voxel_size_)); // OpenGL Y becomes OpenCV Z
+    int y = static_cast<int>(std::round((-world_z - origin_.y) / voxel_size_)); // OpenGL Z becomes OpenCV Y
     return glm::ivec3(x, y, z);
 }
 
@@ -364,15 +435,61 @@ bool Volume::is_voxel_active(int x, int y, int z) const {
     return voxels_[index].active;
 }
 
-size_t Volume::active_voxel_count() const {
-    return std::ranges::count_if(voxels_, [](const Voxel &v) {
-        return v.active;
-    });
+
+const std::vector<uint32_t>& Volume::active_indices() const {
+    if (active_indices_dirty_) {
+        rebuild_active_indices();
+    }
+    return active_indices_;
 }
 
 
 /* Private methods */
 
+const std::vector<uint32_t>& Volume::render_indices() const {
+    // An empty shell means none was set since the last change, not an empty volume
+    if (render_source_ == VolumeRenderSource::SHELL && !shell_indices_.empty()) {
+        return shell_indices_;
+    }
+    return active_indices();
+}
+
+void Volume::rebuild_active_indices() const {
+    const int num_rows = height_ * depth_;
+
+    // Count per row, then let every row write at its prefix offset: sorted and lock-free
+    std::vector<size_t> offsets(num_rows + 1, 0);
+
+    #pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const Voxel *row = voxels_.data() + static_cast<size_t>(r) * width_;
+        size_t count = 0;
+        for (int x = 0; x < width_; ++x) {
+            count += row[x].active;
+        }
+        offsets[r + 1] = count;
+    }
+
+    for (int r = 0; r < num_rows; ++r) {
+        offsets[r + 1] += offsets[r];
+    }
+
+    active_indices_.resize(offsets[num_rows]);
+
+    #pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const size_t row_start = static_cast<size_t>(r) * width_;
+        uint32_t *out = active_indices_.data() + offsets[r];
+        for (int x = 0; x < width_; ++x) {
+            if (voxels_[row_start + x].active) {
+                *out++ = static_cast<uint32_t>(row_start + x);
+            }
+        }
+    }
+
+    active_indices_dirty_ = false;
+}
+
 size_t Volume::get_index(int x, int y, int z) const {
     return z * width_ * height_ + y * width_ + x;
 }
@@ -513,15 +630,18 @@ void Volume::setup_instanced_rendering() {
 }
 
 void Volume::generate_active_voxel_data(std::vector<glm::vec3> &positions, std::vector<glm::vec4> &colors) const {
-    positions.clear();
-    colors.clear();
-    
-    // Use only active voxels for rendering
-    for (const auto &voxel : voxels_) {
-        if (voxel.active) {
-            positions.push_back(voxel.position);
-            colors.push_back(voxel.color);
-        }
+    const std::vector<uint32_t> &indices = render_indices();
+
+    positions.resize(indices.size());
+    colors.resize(indices.size());
+
+    // Use only active voxels (or their shell) for rendering
+    const int count = static_cast<int>(indices.size());
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; ++i) {
+        const Voxel &voxel = voxels_[indices[i]];
+        positions[i] = voxel.position;
+        colors[i] = voxel.color;
     }
 
     // Update the rendered voxel count (cast away const for this internal tracking)
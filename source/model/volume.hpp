@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <vector>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 #include "model.hpp"
@@ -27,6 +28,19 @@ enum class VolumeRenderMode {
 };
 
 
+/**
+ * @enum VolumeRenderSource
+ * @brief Specifies which active voxels are uploaded for rendering.
+ *
+ * - ALL: Render every active voxel
+ * - SHELL: Render only the surface shell set with Volume::set_shell (all active voxels while none is set)
+ */
+enum class VolumeRenderSource {
+    ALL,
+    SHELL
+};
+
+
 /**
  * @class Volume
  * @brief Represents volumetric data for rendering, manipulation, and GPU upload.
@@ -72,6 +86,16 @@ public: // Constructors
      */
     Volume(int width, int height, int depth, float voxel_size = VOLUME_VOXEL_SIZE);
 
+    /**
+     * @brief Construct a new Volume object with an explicit grid origin.
+     * @param width Volume width in voxels.
+     * @param height Volume height in voxels.
+     * @param depth Volume depth in voxels.
+     * @param voxel_size Size of each voxel.
+     * @param origin OpenCV world position of voxel (0, 0, 0).
+     */
+    Volume(int width, int height, int depth, float voxel_size, const glm::vec3& origin);
+
     /** @brief Destructor. Cleans up resources. */
     ~Volume() = default;
 
@@ -115,6 +139,48 @@ public: // Methods
      */
     void set_voxel_density(int x, int y, int z, float density);
 
+    /**
+     * @brief Fill the volume in parallel, one X row at a time.
+     *
+     * Rows are split into contiguous chunks, one per thread, so every voxel is written by exactly one
+     * thread. The callback writes voxels directly without bounds checks or dirty-flag updates; a single
+     * commit() at the end marks the volume dirty and refreshes the active count. The callback must not
+     * call other Volume methods.
+     *
+     * @param fn Callable taking (int y, int z, Voxel* row), where row holds width() voxels.
+     */
+    template <typename Fn>
+    void fill_rows(Fn&& fn) {
+        const int num_rows = height_ * depth_;
+
+        #pragma omp parallel for schedule(static)
+        for (int r = 0; r < num_rows; ++r) {
+            fn(r % height_, r / height_, voxels_.data() + static_cast<size_t>(r) * width_);
+        }
+
+        commit();
+    }
+
+    /** @brief Mark the volume dirty and rebuild the active voxel list after direct voxel writes. */
+    void commit();
+
+    /**
+     * @brief Replace the active voxels by a sorted list of voxel indices.
+     *
+     * Only the previously and newly active voxels are touched, so the cost is O(occupied) rather than O(grid).
+     *
+     * @param indices Sorted linear voxel indices (X fastest) to activate.
+     * @param color Color assigned to the activated voxels.
+     */
+    void assign_active(std::vector<uint32_t> indices, const glm::vec4& color);
+
+    /**
+     * @brief Set the colors of a list of voxels.
+     * @param indices Linear voxel indices (X fastest).
+     * @param colors Color per voxel, parallel to indices.
+     */
+    void assign_colors(const std::vector<uint32_t>& indices, const std::vector<glm::vec4>& colors);
+
     /** @brief Clear all voxels. */
     void clear_all();
 
@@ -158,6 +224,21 @@ public: // Methods
      */
     void set_render_mode(VolumeRenderMode mode);
 
+    /**
+     * @brief Set the surface shell of the active voxels, used by the SHELL render source.
+     *
+     * The shell is dropped by every change of the active voxels and has to be set again afterwards.
+     *
+     * @param indices Sorted linear indices of the active voxels with an empty 6-neighbor.
+     */
+    void set_shell(std::vector<uint32_t> indices);
+
+    /**
+     * @brief Select which active voxels are rendered.
+     * @param source Render source.
+     */
+    void set_render_source(VolumeRenderSource source);
+
     /** @brief Bind the volume for rendering. */
     void bind() const;
 
@@ -208,6 +289,14 @@ public: // Getters
      */
     bool is_voxel_active(int x, int y, int z) const;
 
+    /**
+     * @brief Get the voxels of X row (y, z) for direct reads.
+     * @param y Y coordinate.
+     * @param z Z coordinate.
+     * @return Pointer to width() voxels.
+     */
+    const Voxel* row_data(int y, int z) const { return voxels_.data() + get_index(0, y, z); }
+
     /** @brief Get the volume texture. */
     std::shared_ptr<Texture> volume_texture() const { return volume_texture_; }
 
@@ -223,6 +312,9 @@ public: // Getters
     /** @brief Get the size of each voxel. */
     float voxel_size() const { return voxel_size_; }
 
+    /** @brief Get the OpenCV world position of voxel (0, 0, 0). */
+    const glm::vec3& origin() const { return origin_; }
+
     /** @brief Get the grid size in world units. */
     glm::vec3 grid_size() const { return glm::vec3(width_ * voxel_size_, height_ * voxel_size_, depth_ * voxel_size_); }
 
@@ -230,7 +322,10 @@ public: // Getters
     size_t voxel_count() const { return voxels_.size(); }
 
     /** @brief Get the number of active voxels. */
-    size_t active_voxel_count() const;
+    size_t active_voxel_count() const { return active_voxel_count_; }
+
+    /** @brief Get the sorted linear indices of all active voxels. */
+    const std::vector<uint32_t>& active_indices() const;
     
     /** @brief Get the number of rendered voxels. */
     size_t rendered_voxel_count() const { return rendered_voxel_count_; }
@@ -238,6 +333,9 @@ public: // Getters
     /** @brief Get the current volume render mode. */
     VolumeRenderMode render_mode() const { return render_mode_; }
 
+    /** @brief Get the current volume render source. */
+    VolumeRenderSource render_source() const { return render_source_; }
+
 private: // Methods
     /** @brief Get the index in the voxel array for given coordinates. */
     size_t get_index(int x, int y, int z) const;
@@ -251,6 +349,12 @@ private: // Methods
      */
     bool is_valid_coordinate(int x, int y, int z) const;
 
+    /** @brief Rebuild the active voxel list from the voxel array. */
+    void rebuild_active_indices() const;
+
+    /** @brief Get the sorted indices of the voxels to render for the current render source. */
+    const std::vector<uint32_t>& render_indices() const;
+
     /** @brief Setup point cloud rendering for the volume. */
     void setup_point_rendering();
 
@@ -270,10 +374,16 @@ private: // Variables
 
     int width_, height_, depth_;
     float voxel_size_;
+    glm::vec3 origin_; // OpenCV world position of voxel (0, 0, 0)
+    size_t active_voxel_count_; // Number of active voxels, kept in sync by all writers
+    mutable std::vector<uint32_t> active_indices_; // Sorted indices of active voxels
+    mutable bool active_indices_dirty_; // Whether single-voxel writes invalidated the active list
+    std::vector<uint32_t> shell_indices_; // Sorted indices of active voxels with an empty 6-neighbor
     size_t rendered_voxel_count_; // Track how many voxels are actually rendered
 
     std::vector<Voxel> voxels_;
     VolumeRenderMode render_mode_;
+    VolumeRenderSource render_source_;
 
     std::unique_ptr<VertexArray> vao_;
     std::unique_ptr<VertexBuffer> vertex_buffer_;
@@ -297,7 +297,10 @@ void Overlay::render_control_window() {
         // Render sections in the control window
         render_camera_selection();
         render_background_toggle();
+        render_view_reload();
         render_volume_render_mode();
+        render_consensus();
+        render_sequence();
         render_scene_models();
     }
     ImGui::End();
@@ -367,6 +370,29 @@ void Overlay::render_background_toggle() {
     ImGui::Separator();
 }
 
+void Overlay::render_view_reload() {
+    // An edited image changes one mask, which consensus hulls apply from that view alone
+    bool in_static_view = camera_ && camera_->in_static_view();
+    bool can_reload = project_->initialized && in_static_view && scene_;
+
+    BeginDisabledIf(!can_reload);
+
+    if (ImGui::Button("Reload view image")) {
+        const int view_index = camera_->get_current_view_index();
+        if (camera_->load_view_frame(view_index, frame_)) {
+            scene_->update_view_mask(view_index, project_->views[view_index].mask);
+        }
+    }
+
+    EndDisabledIf(!can_reload);
+
+    if (!can_reload) {
+        ImGui::TextDisabled("(Only available in static camera views)");
+    }
+
+    ImGui::Separator();
+}
+
 void Overlay::render_volume_render_mode() {
     ImGui::Text("Volume Render Mode:");
 
@@ -386,6 +412,50 @@ void Overlay::render_volume_render_mode() {
         }
     }
 
+    // Interior voxels are hidden behind the shell, so rendering only the shell saves most instances
+    if (scene_ && !scene_->shell().empty()) {
+        bool shell_only = scene_->shell_only();
+        if (ImGui::Checkbox("Surface shell only", &shell_only)) {
+            scene_->set_shell_only(shell_only);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%zu of %zu voxels)", scene_->shell().size(), scene_->carver().stats().occupied);
+    }
+
+    ImGui::Separator();
+}
+
+void Overlay::render_consensus() {
+    if (!scene_ || scene_->carver().consensus().empty()) {
+        return;
+    }
+
+    ImGui::Text("Consensus (k of n views):");
+
+    // Thresholding the stored counters is instant, so the volume follows the slider directly
+    int num_views = scene_->carver().consensus().view_count();
+    min_views_ = scene_->carver().stats().min_views;
+    if (ImGui::SliderInt("##MinViews", &min_views_, 1, num_views, "%d views", ImGuiSliderFlags_AlwaysClamp)) {
+        scene_->set_min_views(min_views_);
+    }
+
+    ImGui::Separator();
+}
+
+void Overlay::render_sequence() {
+    if (!scene_ || !camera_ || project_->frame_count == 0) {
+        return;
+    }
+
+    ImGui::Text("Sequence frame:");
+
+    // The project images come before the first frame; each step re-carves seeded by the previous hull
+    if (ImGui::SliderInt("##Frame", &frame_, -1, project_->frame_count - 1, frame_ < 0 ? "Project images" : "Frame %d", ImGuiSliderFlags_AlwaysClamp)) {
+        if (camera_->load_frame(frame_)) {
+            scene_->update_frame();
+        }
+    }
+
     ImGui::Separator();
 }
 
@@ -414,6 +484,7 @@ void Overlay::reset_ui_state(bool project_loaded) {
     show_checkers_ = true;
     show_frustums_ = true;
     show_background_ = false;
+    frame_ = -1;
     
     active_camera_view_ = DEFAULT_CAMERA_VIEW;
     volume_render_mode_ = DEFAULT_VOLUME_RENDER_MODE;
@@ -152,9 +152,18 @@ private: // Methods
     /** @brief Render the background toggle UI. */
     void render_background_toggle();
 
+    /** @brief Render the button reloading the image and mask of the active static view. */
+    void render_view_reload();
+
     /** @brief Render the volume render mode UI. */
     void render_volume_render_mode();
 
+    /** @brief Render the k-of-n slider of consensus reconstructions. */
+    void render_consensus();
+
+    /** @brief Render the frame slider of capture sequences. */
+    void render_sequence();
+
     /** @brief Render the scene models UI. */
     void render_scene_models();
 
@@ -198,6 +207,8 @@ private: // Variables
 
     int active_camera_view_ = DEFAULT_CAMERA_VIEW;
     int volume_render_mode_ = DEFAULT_VOLUME_RENDER_MODE;
+    int min_views_ = 0;
+    int frame_ = -1;
 
     // Background overlay state
     bool show_background_ = false;
@@ -5,12 +5,15 @@
 #include <filesystem>
 
 #include "view.hpp"
+#include "recon/grid.hpp"
+#include "recon/carver.hpp"
 
 
 constexpr const int CHESS_COLS = 7;
 constexpr const int CHESS_ROWS = 7;
 constexpr const float CHESS_SQUARE = 22.0f;  // mm
 constexpr const float CHESS_PADDING = 100.0f;
+constexpr const float MOTION_MARGIN = 40.0f;  // mm
 
 
 /**
@@ -31,6 +34,20 @@ constexpr const float CHESS_PADDING = 100.0f;
  * - chess_cols: Number of columns in the chessboard.
  * - chess_rows: Number of rows in the chessboard.
  * - square_size: Size of a chessboard square in millimeters.
+ * - strategy: Reconstruction strategy used to carve the volume.
+ * - mask_model: How foreground masks are segmented from the backgrounds.
+ * - background_sigmas: Foreground distance of Gaussian masks in standard deviations.
+ * - min_views: Number of views that must see a voxel in consensus carves (0 = all views).
+ * - photo_threshold: Maximum color deviation of surface voxels across views, carving the photo hull (0 = off).
+ * - visibility_downsample: Image pixels per visibility buffer pixel when coloring surface voxels.
+ * - memory_budget: Memory budget of an in-core carve in bytes, covering the occupancy, the per-view projection tables,
+ *   packed masks or integral images, the consensus counters and, in the viewer, the voxels of the rendered volume;
+ *   larger grids are carved out of core (0 = unlimited).
+ * - brick_dir: Directory of the brick store of out-of-core carves.
+ * - grid: Reconstruction grid (extent and voxel size).
+ * - tight_bounds: Whether to carve only the part of the grid that can contain the visual hull (ignored by consensus carves).
+ * - frame_count: Number of frames of the capture sequence (0 for single captures).
+ * - motion_margin: Maximum subject motion between consecutive frames in millimeters.
  * - views: Collection of views containing calibration data.
  */
 struct Project {
@@ -46,5 +63,18 @@ struct Project {
     int chess_rows = CHESS_ROWS;                    // Number of rows in the chessboard
     float square_size = CHESS_SQUARE;               // Size of a square in mm
 
+    CarveStrategy strategy = CarveStrategy::DENSE;  // Reconstruction strategy
+    MaskModel mask_model = MaskModel::DIFFERENCE;   // Foreground segmentation
+    float background_sigmas = BACKGROUND_SIGMAS;    // Gaussian mask threshold
+    int min_views = 0;                              // Views required in consensus carves
+    float photo_threshold = 0.0f;                   // Photo-consistency threshold
+    int visibility_downsample = 1;                  // Visibility buffer downsample factor
+    size_t memory_budget = 0;                       // In-core carve memory budget in bytes
+    std::filesystem::path brick_dir;                // Brick store of out-of-core carves
+    Grid grid;                                      // Reconstruction grid
+    bool tight_bounds = true;                       // Carve only the bounded part of the grid
+    int frame_count = 0;                            // Frames of the capture sequence
+    float motion_margin = MOTION_MARGIN;            // Motion between frames in mm
+
     std::vector<View> views;                        // Views with calibration data
 };
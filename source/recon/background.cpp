@@ -0,0 +1,247 @@
+#include "background.hpp"
+
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+#include <omp.h>
+
+#include "mask.hpp"
+#include "simd.hpp"
+
+
+// Mask value of foreground pixels
+constexpr const uint8_t BACKGROUND_FOREGROUND = std::numeric_limits<uint8_t>::max();
+
+
+/* Functions */
+
+#if defined(SIMD_AVX2)
+// Blend the leading pixels of a row into the running means and variances 8 at a time; returns the pixels done
+SIMD_TARGET_AVX2 static int update_row_avx2(int width, const float* b, const float* g, const float* r, float rate,
+                                            float* mean_b, float* mean_g, float* mean_r, float* variance) {
+    const __m256 rate8 = _mm256_set1_ps(rate);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m256 vb = _mm256_loadu_ps(b + x);
+        const __m256 vg = _mm256_loadu_ps(g + x);
+        const __m256 vr = _mm256_loadu_ps(r + x);
+
+        // Distances to the old mean, then to the new one
+        const __m256 db = _mm256_sub_ps(vb, _mm256_loadu_ps(mean_b + x));
+        const __m256 dg = _mm256_sub_ps(vg, _mm256_loadu_ps(mean_g + x));
+        const __m256 dr = _mm256_sub_ps(vr, _mm256_loadu_ps(mean_r + x));
+        const __m256 mb = _mm256_add_ps(_mm256_loadu_ps(mean_b + x), _mm256_mul_ps(rate8, db));
+        const __m256 mg = _mm256_add_ps(_mm256_loadu_ps(mean_g + x), _mm256_mul_ps(rate8, dg));
+        const __m256 mr = _mm256_add_ps(_mm256_loadu_ps(mean_r + x), _mm256_mul_ps(rate8, dr));
+        _mm256_storeu_ps(mean_b + x, mb);
+        _mm256_storeu_ps(mean_g + x, mg);
+        _mm256_storeu_ps(mean_r + x, mr);
+
+        __m256 spread = _mm256_mul_ps(db, _mm256_sub_ps(vb, mb));
+        spread = _mm256_add_ps(spread, _mm256_mul_ps(dg, _mm256_sub_ps(vg, mg)));
+        spread = _mm256_add_ps(spread, _mm256_mul_ps(dr, _mm256_sub_ps(vr, mr)));
+
+        const __m256 var = _mm256_loadu_ps(variance + x);
+        _mm256_storeu_ps(variance + x, _mm256_add_ps(var, _mm256_mul_ps(rate8, _mm256_sub_ps(spread, var))));
+    }
+    return x;
+}
+
+// Classify the leading pixels of a row 8 at a time; returns the pixels done
+SIMD_TARGET_AVX2 static int classify_row_avx2(int width, const float* b, const float* g, const float* r,
+                                              const float* mean_b, const float* mean_g, const float* mean_r, const float* variance,
+                                              float min_variance, float sigmas_sq, uint8_t* mask) {
+    const __m256 min_variance8 = _mm256_set1_ps(min_variance);
+    const __m256 sigmas_sq8 = _mm256_set1_ps(sigmas_sq);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m256 db = _mm256_sub_ps(_mm256_loadu_ps(b + x), _mm256_loadu_ps(mean_b + x));
+        const __m256 dg = _mm256_sub_ps(_mm256_loadu_ps(g + x), _mm256_loadu_ps(mean_g + x));
+        const __m256 dr = _mm256_sub_ps(_mm256_loadu_ps(r + x), _mm256_loadu_ps(mean_r + x));
+
+        __m256 dist = _mm256_mul_ps(db, db);
+        dist = _mm256_add_ps(dist, _mm256_mul_ps(dg, dg));
+        dist = _mm256_add_ps(dist, _mm256_mul_ps(dr, dr));
+        const __m256 limit = _mm256_mul_ps(sigmas_sq8, _mm256_max_ps(_mm256_loadu_ps(variance + x), min_variance8));
+
+        const int bits = _mm256_movemask_ps(_mm256_cmp_ps(dist, limit, _CMP_GT_OQ));
+        for (int i = 0; i < 8; ++i) {
+            mask[x + i] = (bits >> i) & 1 ? BACKGROUND_FOREGROUND : 0;
+        }
+    }
+    return x;
+}
+#endif
+
+bool parse_mask_model(const std::string& name, MaskModel& model) {
+    if (name == "difference") {
+        model = MaskModel::DIFFERENCE;
+        return true;
+    }
+    if (name == "gaussian") {
+        model = MaskModel::GAUSSIAN;
+        return true;
+    }
+    return false;
+}
+
+const char* mask_model_name(MaskModel model) {
+    switch (model) {
+        case MaskModel::DIFFERENCE:
+            return "difference";
+        case MaskModel::GAUSSIAN:
+            return "gaussian";
+    }
+    return "unknown";
+}
+
+// Split a row of interleaved BGR(A) bytes into float channel rows
+static void split_row(const uint8_t* pixels, int channels, int width, float* b, float* g, float* r) {
+    for (int x = 0; x < width; ++x) {
+        b[x] = pixels[x * channels + 0];
+        g[x] = pixels[x * channels + 1];
+        r[x] = pixels[x * channels + 2];
+    }
+}
+
+
+/* Public methods */
+
+bool BackgroundModel::add_frame(const cv::Mat& img) {
+    if (frames_ == 0 && !img.empty()) {
+        size_ = img.size();
+        region_ &= cv::Rect(0, 0, size_.width, size_.height);
+        const size_t num_pixels = static_cast<size_t>(region_.area());
+        mean_b_.assign(num_pixels, 0.0f);
+        mean_g_.assign(num_pixels, 0.0f);
+        mean_r_.assign(num_pixels, 0.0f);
+        variance_.assign(num_pixels, 0.0f);
+    }
+    if (!accepts(img)) {
+        return false;
+    }
+
+    // Welford's update: every frame enters with weight 1 / n, giving the exact mean and variance of all frames
+    ++frames_;
+    const float rate = 1.0f / static_cast<float>(frames_);
+    const int width = region_.width;
+    const int height = region_.height;
+    const int channels = img.channels();
+
+#pragma omp parallel
+    {
+        std::vector<float> b(width);
+        std::vector<float> g(width);
+        std::vector<float> r(width);
+
+#pragma omp for schedule(static)
+        for (int y = 0; y < height; ++y) {
+            split_row(img.ptr<uint8_t>(region_.y + y) + region_.x * channels, channels, width, b.data(), g.data(), r.data());
+            update_row(y, b.data(), g.data(), r.data(), rate);
+        }
+    }
+
+    return true;
+}
+
+cv::Mat BackgroundModel::segment(const cv::Mat& img) const {
+    if (!accepts(img)) {
+        return cv::Mat();
+    }
+
+    const int channels = img.channels();
+
+    // Channel rows per thread of the tiled kernel
+    const size_t row_floats = static_cast<size_t>(region_.width);
+    std::vector<std::vector<float>> rows(omp_get_max_threads(), std::vector<float>(3 * row_floats));
+
+    // The kernel also reads the halo around the region, which is background
+    return segment_mask(size_, region_, [&](int y, int x, int width, uint8_t* mask) {
+        std::memset(mask, 0, width);
+        const int begin = std::max(x, region_.x);
+        const int end = std::min(x + width, region_.x + region_.width);
+        if (y < region_.y || y >= region_.y + region_.height || begin >= end) {
+            return;
+        }
+
+        float* b = rows[omp_get_thread_num()].data();
+        float* g = b + row_floats;
+        float* r = g + row_floats;
+        split_row(img.ptr<uint8_t>(y) + begin * channels, channels, end - begin, b, g, r);
+        classify_row(y - region_.y, begin - region_.x, end - begin, b, g, r, mask + (begin - x));
+    });
+}
+
+void BackgroundModel::set_region(const cv::Rect& roi) {
+    reset();
+    region_ = roi;
+}
+
+void BackgroundModel::reset() {
+    size_ = cv::Size();
+    region_ = cv::Rect(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+    frames_ = 0;
+    mean_b_.clear();
+    mean_g_.clear();
+    mean_r_.clear();
+    variance_.clear();
+}
+
+
+/* Private methods */
+
+bool BackgroundModel::accepts(const cv::Mat& img) const {
+    return !img.empty() && img.depth() == CV_8U && (img.channels() == 3 || img.channels() == 4) && img.size() == size_;
+}
+
+void BackgroundModel::update_row(int y, const float* b, const float* g, const float* r, float rate) {
+    const size_t offset = static_cast<size_t>(y) * region_.width;
+    float* mean_b = mean_b_.data() + offset;
+    float* mean_g = mean_g_.data() + offset;
+    float* mean_r = mean_r_.data() + offset;
+    float* variance = variance_.data() + offset;
+
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = update_row_avx2(region_.width, b, g, r, rate, mean_b, mean_g, mean_r, variance);
+    }
+#endif
+    for (; x < region_.width; ++x) {
+        const float db = b[x] - mean_b[x];
+        const float dg = g[x] - mean_g[x];
+        const float dr = r[x] - mean_r[x];
+        mean_b[x] += rate * db;
+        mean_g[x] += rate * dg;
+        mean_r[x] += rate * dr;
+
+        const float spread = db * (b[x] - mean_b[x]) + dg * (g[x] - mean_g[x]) + dr * (r[x] - mean_r[x]);
+        variance[x] += rate * (spread - variance[x]);
+    }
+}
+
+void BackgroundModel::classify_row(int y, int x0, int width, const float* b, const float* g, const float* r, uint8_t* mask) const {
+    const size_t offset = static_cast<size_t>(y) * region_.width + x0;
+    const float* mean_b = mean_b_.data() + offset;
+    const float* mean_g = mean_g_.data() + offset;
+    const float* mean_r = mean_r_.data() + offset;
+    const float* variance = variance_.data() + offset;
+
+    const float min_variance = 3.0f * BACKGROUND_MIN_SIGMA * BACKGROUND_MIN_SIGMA;
+    const float sigmas_sq = sigmas_ * sigmas_;
+
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = classify_row_avx2(width, b, g, r, mean_b, mean_g, mean_r, variance, min_variance, sigmas_sq, mask);
+    }
+#endif
+    for (; x < width; ++x) {
+        const float db = b[x] - mean_b[x];
+        const float dg = g[x] - mean_g[x];
+        const float dr = r[x] - mean_r[x];
+        const float dist = db * db + dg * dg + dr * dr;
+        mask[x] = dist > sigmas_sq * std::max(variance[x], min_variance) ? BACKGROUND_FOREGROUND : 0;
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+
+// Default distance of a foreground pixel from the background mean, in standard deviations
+constexpr const float BACKGROUND_SIGMAS = 3.0f;
+
+// Lower bound of the per-channel standard deviation, covering sensor noise a few frames do not show
+constexpr const float BACKGROUND_MIN_SIGMA = 8.0f;
+
+
+/**
+ * @enum MaskModel
+ * @brief How foreground masks are segmented from the background.
+ *
+ * - DIFFERENCE: Threshold the HSV difference to the single background image
+ * - GAUSSIAN: Distance test against a per-pixel Gaussian learned from all background frames
+ */
+enum class MaskModel {
+    DIFFERENCE,
+    GAUSSIAN
+};
+
+
+/**
+ * @brief Parse a mask model name ("difference", "gaussian").
+ * @param name Model name.
+ * @param model Output model.
+ * @return True if the name is known.
+ */
+bool parse_mask_model(const std::string& name, MaskModel& model);
+
+/**
+ * @brief Get the name of a mask model.
+ * @param model Model.
+ * @return Model name.
+ */
+const char* mask_model_name(MaskModel model);
+
+
+/**
+ * @class BackgroundModel
+ * @brief Per-pixel Gaussian color model of a static background learned from several frames.
+ *
+ * Every pixel keeps the running mean of its B, G and R values and the running variance of its color,
+ * i.e. the mean squared distance of the frames to the mean summed over the channels. The statistics
+ * are stored as separate float planes (structure of arrays), so training and classification stream
+ * through contiguous memory eight pixels per AVX2 instruction.
+ *
+ * A pixel is foreground when its squared color distance to the mean exceeds the squared threshold
+ * times the variance, which is floored at BACKGROUND_MIN_SIGMA per channel. The raw classification
+ * is cleaned with the morphology of compute_mask().
+ *
+ * The model can be restricted to a region of the image, e.g. the part a reconstruction grid projects
+ * into: only that region is stored, learned and classified, and everything else is background.
+ */
+class BackgroundModel {
+public: // Methods
+    /**
+     * @brief Add a background frame to the running statistics.
+     * @param img 8-bit BGR or BGRA frame; the first frame sets the model size.
+     * @return False if the frame is empty, not 8-bit BGR(A), or of a different size.
+     */
+    bool add_frame(const cv::Mat& img);
+
+    /**
+     * @brief Restrict the model to a region of the image and drop all statistics.
+     * @param roi Region to learn and segment; clipped to the image by the first frame.
+     */
+    void set_region(const cv::Rect& roi);
+
+    /**
+     * @brief Segment the foreground of an image against the model.
+     * @param img 8-bit BGR or BGRA image of the model size.
+     * @return 8-bit mask, 255 for foreground and 0 for background; empty if the image does not match.
+     */
+    cv::Mat segment(const cv::Mat& img) const;
+
+    /** @brief Drop all statistics. */
+    void reset();
+
+    /** @brief Set the foreground distance in standard deviations. */
+    void set_sigmas(float sigmas) { sigmas_ = sigmas; }
+
+public: // Getters
+    /** @brief Check whether the model has not seen any frame yet. */
+    bool empty() const { return frames_ == 0; }
+
+    /** @brief Get the number of frames learned. */
+    int frames() const { return frames_; }
+
+    /** @brief Get the image size of the model. */
+    const cv::Size& size() const { return size_; }
+
+    /** @brief Get the image region the model covers. */
+    const cv::Rect& region() const { return region_; }
+
+    /** @brief Get the foreground distance in standard deviations. */
+    float sigmas() const { return sigmas_; }
+
+    /** @brief Get the memory of the statistics in bytes. */
+    size_t memory_bytes() const {
+        return (mean_b_.size() + mean_g_.size() + mean_r_.size() + variance_.size()) * sizeof(float);
+    }
+
+private: // Methods
+    /** @brief Check whether an image can be learned or segmented by the model. */
+    bool accepts(const cv::Mat& img) const;
+
+    /** @brief Fold region row y of a frame into the statistics with weight rate. */
+    void update_row(int y, const float* b, const float* g, const float* r, float rate);
+
+    /** @brief Classify width pixels of region row y from region column x0 into 0/255 bytes. */
+    void classify_row(int y, int x0, int width, const float* b, const float* g, const float* r, uint8_t* mask) const;
+
+private: // Variables
+    cv::Size size_;                     // Image size
+    cv::Rect region_ = cv::Rect(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max()); // Modeled pixels
+    int frames_ = 0;                    // Frames learned
+    float sigmas_ = BACKGROUND_SIGMAS;  // Foreground distance in standard deviations
+
+    std::vector<float> mean_b_;         // Mean blue per region pixel
+    std::vector<float> mean_g_;         // Mean green per region pixel
+    std::vector<float> mean_r_;         // Mean red per region pixel
+    std::vector<float> variance_;       // Color variance per region pixel, summed over the channels
+};
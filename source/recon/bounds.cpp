@@ -0,0 +1,64 @@
+#include "bounds.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "carver.hpp"
+#include "occupancy.hpp"
+
+
+// Number of coarse voxels along the longest grid axis
+constexpr const int BOUNDS_RESOLUTION = 32;
+
+
+/* Functions */
+
+bool compute_hull_bounds(const std::vector<View>& views, const Grid& grid, Grid& bounded) {
+    const glm::vec3 extent = grid.extent();
+    const float coarse_size = std::max(grid.voxel_size, std::max({ extent.x, extent.y, extent.z }) / BOUNDS_RESOLUTION);
+
+    // Place coarse samples at cube centers so the cubes tile the grid extent starting at its origin
+    Grid coarse = Grid::from_extent(grid.origin, grid.origin + extent, coarse_size);
+    coarse.origin += glm::vec3(coarse_size * 0.5f);
+
+    Carver carver;
+    carver.set_strategy(CarveStrategy::FOOTPRINT);
+
+    OccupancyGrid occupancy;
+    carver.carve(views, coarse, occupancy);
+
+    glm::ivec3 lo(std::numeric_limits<int>::max());
+    glm::ivec3 hi(std::numeric_limits<int>::lowest());
+    occupancy.for_each([&](int x, int y, int z) {
+        lo = glm::min(lo, glm::ivec3(x, y, z));
+        hi = glm::max(hi, glm::ivec3(x, y, z));
+    });
+
+    if (lo.x > hi.x) {
+        return false;
+    }
+
+    // World box of the occupied cubes, grown by one coarse voxel to absorb lens distortion
+    glm::vec3 box_min = coarse.position(lo.x, lo.y, lo.z) - glm::vec3(coarse_size * 1.5f);
+    glm::vec3 box_max = coarse.position(hi.x, hi.y, hi.z) + glm::vec3(coarse_size * 1.5f);
+
+    // Snap outwards to the fine lattice and clip to the grid
+    glm::vec3 first = glm::floor((box_min - grid.origin) / grid.voxel_size);
+    glm::vec3 last = glm::ceil((box_max - grid.origin) / grid.voxel_size);
+
+    glm::ivec3 begin = glm::max(glm::ivec3(first), glm::ivec3(0));
+    glm::ivec3 end = glm::min(glm::ivec3(last) + glm::ivec3(1), glm::ivec3(grid.num_x, grid.num_y, grid.num_z));
+
+    bounded = grid.subgrid(begin, end);
+    return bounded.is_valid();
+}
+
+Grid carve_bounds(const std::vector<View>& views, const Grid& grid, bool tight_bounds, CarveStrategy strategy) {
+    Grid bounded = grid;
+    if (tight_bounds && strategy != CarveStrategy::CONSENSUS && !compute_hull_bounds(views, grid, bounded)) {
+        bounded = grid;
+    }
+
+    return bounded;
+}
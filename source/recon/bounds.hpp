@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "carver.hpp"
+
+
+/**
+ * @brief Find the part of a grid that can contain the visual hull.
+ *
+ * Carves a coarse copy of the grid with the conservative footprint test, whose voxel cubes tile the
+ * full extent, and bounds the occupied cubes plus a margin of one coarse voxel. Every fine voxel the
+ * exact carve could keep lies inside the returned subgrid, whose samples coincide with those of the grid.
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Full reconstruction grid.
+ * @param bounded Output subgrid of grid enclosing the hull.
+ * @return False if the hull is empty and no bound exists.
+ */
+bool compute_hull_bounds(const std::vector<View>& views, const Grid& grid, Grid& bounded);
+
+/**
+ * @brief Get the part of a grid to carve.
+ *
+ * The bounds enclose the voxels all views agree on, so consensus carves, which keep voxels some views
+ * reject and can be re-extracted for any view count, always get the full grid.
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Full reconstruction grid.
+ * @param tight_bounds Whether to bound the grid to the visual hull.
+ * @param strategy Carve strategy the grid is carved with.
+ * @return Hull bounds when enabled, supported by the strategy and the hull is not empty, the full grid otherwise.
+ */
+Grid carve_bounds(const std::vector<View>& views, const Grid& grid, bool tight_bounds, CarveStrategy strategy);
@@ -0,0 +1,371 @@
+#include "brick.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+
+
+// Store file names inside the store directory
+constexpr const char* BRICK_DATA_FILE = "bricks.dat";
+constexpr const char* BRICK_INDEX_FILE = "bricks.idx";
+
+// Index file signature and format version
+constexpr const uint32_t BRICK_MAGIC = 0x4b524256; // "VBRK"
+constexpr const uint32_t BRICK_VERSION = 1;
+
+
+/* Types */
+
+/** @brief Fixed-size header of a brick index file. */
+struct BrickIndexHeader {
+    uint32_t magic = BRICK_MAGIC;       // File signature
+    uint32_t version = BRICK_VERSION;   // Format version
+    int32_t num_x = 0;                  // Grid size X
+    int32_t num_y = 0;                  // Grid size Y
+    int32_t num_z = 0;                  // Grid size Z
+    float voxel_size = 0.0f;            // Voxel size in mm
+    float origin[3] = {};               // Grid origin
+    uint64_t count = 0;                 // Stored bricks
+};
+
+/** @brief Index record of a stored brick. */
+struct BrickIndexRecord {
+    uint64_t index = 0;     // Linear brick index
+    uint64_t offset = 0;    // Byte offset in the data file
+    uint64_t occupied = 0;  // Occupied voxels
+};
+
+
+/* Functions */
+
+void BrickStats::print() const {
+    std::cout << "Bricks: " << stored << " of " << bricks << " stored (" << culled << " culled), " << occupied
+              << " occupied voxels, " << stored_bytes / 1024 << " KiB on disk in " << carve_ms << " ms" << std::endl;
+}
+
+size_t occupancy_bytes(const Grid& grid) {
+    return grid.row_count() * static_cast<size_t>((grid.num_x + 63) / 64) * sizeof(uint64_t);
+}
+
+size_t carve_bytes(const std::vector<View>& views, const Grid& grid, CarveStrategy strategy) {
+    if (strategy == CarveStrategy::POLYHEDRAL) {
+        return 0;
+    }
+
+    size_t bytes = occupancy_bytes(grid);
+
+    const bool hierarchical = strategy == CarveStrategy::OCTREE || strategy == CarveStrategy::FOOTPRINT;
+    for (const View& view : views) {
+        const size_t packed = static_cast<size_t>(PackedMask::tiles_per_row(view.mask.cols)) * ((view.mask.rows + 7) / 8) * sizeof(uint64_t);
+        if (hierarchical) {
+            bytes += static_cast<size_t>(view.mask.cols + 1) * (view.mask.rows + 1) * sizeof(int32_t);
+        }
+        else {
+            bytes += grid.voxel_count() * sizeof(uint32_t) + packed;
+        }
+        if (strategy == CarveStrategy::CONSENSUS) {
+            bytes += packed;
+        }
+    }
+
+    if (strategy == CarveStrategy::CONSENSUS) {
+        bytes += grid.voxel_count() * (views.size() > CONSENSUS_BYTE_VIEWS ? sizeof(uint16_t) : sizeof(uint8_t));
+    }
+    return bytes;
+}
+
+bool carve_bricks(Carver& carver, const std::vector<View>& views, const Grid& grid, const std::filesystem::path& dir,
+    BrickStore& store, BrickStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    stats = BrickStats();
+
+    if (!store.create(dir, grid)) {
+        return false;
+    }
+
+    // One coarse footprint cube per brick, centered on the brick; its cube covers every sample of the brick
+    const glm::ivec3 counts = store.brick_counts();
+    Grid coarse;
+    coarse.num_x = counts.x;
+    coarse.num_y = counts.y;
+    coarse.num_z = counts.z;
+    coarse.voxel_size = grid.voxel_size * BRICK_SIZE;
+    coarse.origin = grid.origin + glm::vec3(grid.voxel_size * (BRICK_SIZE - 1) * 0.5f);
+
+    Carver culler;
+    culler.set_strategy(CarveStrategy::FOOTPRINT);
+    OccupancyGrid candidates;
+    culler.carve(views, coarse, candidates);
+
+    stats.bricks = coarse.voxel_count();
+    stats.culled = stats.bricks - candidates.count();
+
+    // Bricks are carved in store order, each with the carver's own parallelism
+    OccupancyGrid occupancy;
+    bool written = true;
+    candidates.for_each([&](int x, int y, int z) {
+        const glm::ivec3 brick(x, y, z);
+        carver.carve(views, store.brick_grid(brick), occupancy);
+        written = store.write(brick, occupancy) && written;
+    });
+
+    written = store.finish() && written;
+
+    // The carver only holds the tables and result of the last brick
+    carver.reset();
+
+    stats.stored = store.stored_bricks().size();
+    stats.occupied = store.occupied();
+    stats.stored_bytes = 0;
+    for (const glm::ivec3& brick : store.stored_bricks()) {
+        stats.stored_bytes += occupancy_bytes(store.brick_grid(brick));
+    }
+    stats.carve_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return written;
+}
+
+
+/* Public methods */
+
+bool BrickStore::create(const std::filesystem::path& dir, const Grid& grid) {
+    close();
+
+    dir_ = dir;
+    grid_ = grid;
+    counts_ = glm::ivec3((grid.num_x + BRICK_SIZE - 1) / BRICK_SIZE, (grid.num_y + BRICK_SIZE - 1) / BRICK_SIZE,
+        (grid.num_z + BRICK_SIZE - 1) / BRICK_SIZE);
+
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    std::filesystem::remove(dir / BRICK_INDEX_FILE, error);
+
+    writer_.open(dir / BRICK_DATA_FILE, std::ios::binary | std::ios::trunc);
+    if (!writer_) {
+        std::cerr << "Could not create brick store: " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BrickStore::open(const std::filesystem::path& dir) {
+    close();
+
+    std::ifstream stream(dir / BRICK_INDEX_FILE, std::ios::binary);
+    BrickIndexHeader header;
+    if (!stream || !stream.read(reinterpret_cast<char*>(&header), sizeof(header))
+    ||  header.magic != BRICK_MAGIC || header.version != BRICK_VERSION) {
+        std::cerr << "Could not read brick index: " << dir << std::endl;
+        return false;
+    }
+
+    Grid grid;
+    grid.num_x = header.num_x;
+    grid.num_y = header.num_y;
+    grid.num_z = header.num_z;
+    grid.voxel_size = header.voxel_size;
+    grid.origin = glm::vec3(header.origin[0], header.origin[1], header.origin[2]);
+
+    dir_ = dir;
+    grid_ = grid;
+    counts_ = glm::ivec3((grid.num_x + BRICK_SIZE - 1) / BRICK_SIZE, (grid.num_y + BRICK_SIZE - 1) / BRICK_SIZE,
+        (grid.num_z + BRICK_SIZE - 1) / BRICK_SIZE);
+
+    std::vector<BrickIndexRecord> records(header.count);
+    if (!stream.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(BrickIndexRecord)))) {
+        std::cerr << "Brick index is truncated: " << dir << std::endl;
+        close();
+        return false;
+    }
+    for (const BrickIndexRecord& record : records) {
+        index_[record.index] = { record.offset, record.occupied };
+        occupied_ += record.occupied;
+    }
+
+    reader_.open(dir / BRICK_DATA_FILE, std::ios::binary);
+    if (!reader_) {
+        std::cerr << "Could not open brick data: " << dir << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool BrickStore::write(const glm::ivec3& brick, const OccupancyGrid& occupancy) {
+    const size_t occupied = occupancy.count();
+    if (occupied == 0) {
+        return true;
+    }
+
+    // Brick rows fit one word, so the words of a brick are contiguous in grid order
+    const size_t bytes = occupancy.grid().row_count() * occupancy.words_per_row() * sizeof(uint64_t);
+    writer_.write(reinterpret_cast<const char*>(occupancy.row(0, 0)), static_cast<std::streamsize>(bytes));
+    if (!writer_) {
+        std::cerr << "Could not write brick to store: " << dir_ << std::endl;
+        return false;
+    }
+
+    index_[brick_index(brick)] = { data_size_, occupied };
+    occupied_ += occupied;
+    data_size_ += bytes;
+    return true;
+}
+
+bool BrickStore::finish() {
+    writer_.close();
+
+    std::ofstream stream(dir_ / BRICK_INDEX_FILE, std::ios::binary | std::ios::trunc);
+    BrickIndexHeader header;
+    header.num_x = grid_.num_x;
+    header.num_y = grid_.num_y;
+    header.num_z = grid_.num_z;
+    header.voxel_size = grid_.voxel_size;
+    header.origin[0] = grid_.origin.x;
+    header.origin[1] = grid_.origin.y;
+    header.origin[2] = grid_.origin.z;
+    header.count = index_.size();
+
+    std::vector<BrickIndexRecord> records;
+    records.reserve(index_.size());
+    for (const auto& [index, entry] : index_) {
+        records.push_back({ index, entry.offset, entry.occupied });
+    }
+    std::sort(records.begin(), records.end(), [](const BrickIndexRecord& a, const BrickIndexRecord& b) { return a.index < b.index; });
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(BrickIndexRecord)));
+    if (!stream) {
+        std::cerr << "Could not write brick index: " << dir_ << std::endl;
+        return false;
+    }
+
+    reader_.open(dir_ / BRICK_DATA_FILE, std::ios::binary);
+    return static_cast<bool>(reader_);
+}
+
+void BrickStore::close() {
+    writer_.close();
+    reader_.close();
+    reader_.clear();
+    index_.clear();
+    cache_.clear();
+    lru_.clear();
+    cache_bytes_ = 0;
+    occupied_ = 0;
+    data_size_ = 0;
+}
+
+std::shared_ptr<const OccupancyGrid> BrickStore::load(const glm::ivec3& brick) {
+    const size_t index = brick_index(brick);
+
+    auto cached = cache_.find(index);
+    if (cached != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, cached->second.recency);
+        return cached->second.occupancy;
+    }
+
+    auto entry = index_.find(index);
+    if (entry == index_.end()) {
+        return nullptr;
+    }
+
+    auto occupancy = std::make_shared<OccupancyGrid>(brick_grid(brick));
+    const size_t bytes = occupancy->memory_bytes();
+    reader_.seekg(static_cast<std::streamoff>(entry->second.offset));
+    if (!reader_.read(reinterpret_cast<char*>(occupancy->row(0, 0)), static_cast<std::streamsize>(bytes))) {
+        std::cerr << "Could not read brick from store: " << dir_ << std::endl;
+        reader_.clear();
+        return nullptr;
+    }
+
+    // Evict the least recently used bricks until the new one fits the budget
+    while (!lru_.empty() && cache_bytes_ + bytes > budget_) {
+        auto evicted = cache_.find(lru_.back());
+        cache_bytes_ -= evicted->second.occupancy->memory_bytes();
+        cache_.erase(evicted);
+        lru_.pop_back();
+    }
+
+    lru_.push_front(index);
+    cache_[index] = { occupancy, lru_.begin() };
+    cache_bytes_ += bytes;
+    return occupancy;
+}
+
+OccupancyGrid BrickStore::downsample(int factor) {
+    factor = std::max(factor, 1);
+
+    Grid coarse;
+    coarse.num_x = (grid_.num_x + factor - 1) / factor;
+    coarse.num_y = (grid_.num_y + factor - 1) / factor;
+    coarse.num_z = (grid_.num_z + factor - 1) / factor;
+    coarse.voxel_size = grid_.voxel_size * factor;
+    coarse.origin = grid_.origin + glm::vec3(grid_.voxel_size * (factor - 1) * 0.5f);
+
+    OccupancyGrid result(coarse);
+
+    for (const glm::ivec3& brick : stored_bricks()) {
+        std::shared_ptr<const OccupancyGrid> occupancy = load(brick);
+        if (!occupancy) {
+            continue;
+        }
+
+        const Grid& layout = occupancy->grid();
+        const glm::ivec3 begin = brick * BRICK_SIZE;
+
+        // Every coarse cell overlapping the brick row is set from the bits of the row it covers
+        for (int z = 0; z < layout.num_z; ++z) {
+            for (int y = 0; y < layout.num_y; ++y) {
+                const uint64_t bits = occupancy->row(y, z)[0];
+                if (!bits) {
+                    continue;
+                }
+
+                const int cy = (begin.y + y) / factor;
+                const int cz = (begin.z + z) / factor;
+                for (int cx = begin.x / factor; cx * factor < begin.x + layout.num_x; ++cx) {
+                    const int lo = std::max(cx * factor - begin.x, 0);
+                    const int hi = std::min((cx + 1) * factor - begin.x, layout.num_x);
+                    const uint64_t mask = (hi - lo >= 64 ? ~uint64_t(0) : ((uint64_t(1) << (hi - lo)) - 1)) << lo;
+                    if (bits & mask) {
+                        result.set(cx, cy, cz);
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+
+/* Getters */
+
+Grid BrickStore::brick_grid(const glm::ivec3& brick) const {
+    const glm::ivec3 begin = brick * BRICK_SIZE;
+    const glm::ivec3 end = glm::min(begin + BRICK_SIZE, glm::ivec3(grid_.num_x, grid_.num_y, grid_.num_z));
+    return grid_.subgrid(begin, end);
+}
+
+std::vector<glm::ivec3> BrickStore::stored_bricks() const {
+    std::vector<size_t> indices;
+    indices.reserve(index_.size());
+    for (const auto& [index, entry] : index_) {
+        indices.push_back(index);
+    }
+    std::sort(indices.begin(), indices.end());
+
+    std::vector<glm::ivec3> bricks;
+    bricks.reserve(indices.size());
+    for (size_t index : indices) {
+        bricks.push_back(brick_coords(index));
+    }
+    return bricks;
+}
+
+
+/* Private methods */
+
+glm::ivec3 BrickStore::brick_coords(size_t index) const {
+    const size_t slice = static_cast<size_t>(counts_.x) * counts_.y;
+    return glm::ivec3(static_cast<int>(index % counts_.x), static_cast<int>((index / counts_.x) % counts_.y), static_cast<int>(index / slice));
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "carver.hpp"
+#include "occupancy.hpp"
+
+
+// Edge length of a brick in voxels; a brick row is exactly one occupancy word
+constexpr const int BRICK_SIZE = 64;
+
+
+/**
+ * @struct BrickStats
+ * @brief Work and storage counters of the last out-of-core carve.
+ *
+ * Members:
+ * - bricks: Number of bricks in the grid.
+ * - culled: Bricks dropped by the coarse footprint test without carving.
+ * - stored: Non-empty bricks written to the store.
+ * - occupied: Number of occupied voxels over all bricks.
+ * - stored_bytes: Size of the written brick data.
+ * - carve_ms: Wall time of the carve in milliseconds.
+ */
+struct BrickStats {
+    size_t bricks = 0;          // Bricks in the grid
+    size_t culled = 0;          // Bricks culled before carving
+    size_t stored = 0;          // Non-empty bricks stored
+    size_t occupied = 0;        // Occupied voxels
+    size_t stored_bytes = 0;    // Brick data on disk
+    double carve_ms = 0.0;      // Carve wall time
+
+    /** @brief Print the statistics to standard output. */
+    void print() const;
+};
+
+
+/**
+ * @class BrickStore
+ * @brief Chunked on-disk occupancy of a grid too large to hold in memory.
+ *
+ * The grid is split into BRICK_SIZE^3 bricks (smaller at the far edges). Only non-empty bricks are
+ * stored: their occupancy words are appended to a data file and located through an index, which is
+ * written when the store is finished so it can be reopened later. Bricks are paged back in on demand
+ * through a least-recently-used cache whose size stays within the memory budget.
+ */
+class BrickStore {
+public: // Methods
+    /**
+     * @brief Create an empty store for a grid, replacing any store in the directory.
+     * @param dir Store directory; created if missing.
+     * @param grid Full grid layout.
+     * @return True if the store files could be created.
+     */
+    bool create(const std::filesystem::path& dir, const Grid& grid);
+
+    /**
+     * @brief Open a finished store for reading.
+     * @param dir Store directory.
+     * @return False if the index is missing or invalid.
+     */
+    bool open(const std::filesystem::path& dir);
+
+    /**
+     * @brief Append a carved brick; empty bricks are dropped without writing.
+     * @param brick Brick coordinates.
+     * @param occupancy Occupancy of the brick, laid out as brick_grid(brick).
+     * @return False if the brick could not be written.
+     */
+    bool write(const glm::ivec3& brick, const OccupancyGrid& occupancy);
+
+    /**
+     * @brief Write the index and switch the store to reading.
+     * @return False if the index could not be written.
+     */
+    bool finish();
+
+    /** @brief Close the store files and drop the cache. */
+    void close();
+
+    /**
+     * @brief Page a brick in through the cache.
+     *
+     * The least recently used bricks are evicted once the cache exceeds the budget; bricks still held
+     * by the caller stay valid.
+     *
+     * @param brick Brick coordinates.
+     * @return Occupancy of the brick, or null if the brick is empty.
+     */
+    std::shared_ptr<const OccupancyGrid> load(const glm::ivec3& brick);
+
+    /**
+     * @brief Downsample the stored occupancy, paging in every stored brick once.
+     *
+     * A coarse voxel is occupied when any fine voxel of its factor^3 block is occupied; its sample
+     * lies at the center of the block.
+     *
+     * @param factor Fine voxels per coarse voxel along each axis.
+     * @return Coarse occupancy.
+     */
+    OccupancyGrid downsample(int factor);
+
+    /**
+     * @brief Set the memory budget of the brick cache.
+     * @param bytes Budget in bytes; at least one brick is always cached.
+     */
+    void set_budget(size_t bytes) { budget_ = bytes; }
+
+public: // Getters
+    /** @brief Get the full grid layout. */
+    const Grid& grid() const { return grid_; }
+
+    /** @brief Get the number of bricks along each axis. */
+    const glm::ivec3& brick_counts() const { return counts_; }
+
+    /** @brief Get the grid layout of a brick; its samples coincide with those of the full grid. */
+    Grid brick_grid(const glm::ivec3& brick) const;
+
+    /** @brief Get the bricks stored, in brick order. */
+    std::vector<glm::ivec3> stored_bricks() const;
+
+    /** @brief Check whether a brick is stored, i.e. not empty. */
+    bool contains(const glm::ivec3& brick) const { return index_.count(brick_index(brick)) > 0; }
+
+    /** @brief Get the number of occupied voxels of all stored bricks. */
+    size_t occupied() const { return occupied_; }
+
+    /** @brief Get the memory used by the cached bricks in bytes. */
+    size_t cache_bytes() const { return cache_bytes_; }
+
+    /** @brief Get the memory budget of the brick cache in bytes. */
+    size_t budget() const { return budget_; }
+
+private: // Types
+    /** @brief Location of a stored brick in the data file. */
+    struct Entry {
+        uint64_t offset = 0;    // Byte offset of the words
+        uint64_t occupied = 0;  // Occupied voxels
+    };
+
+    /** @brief Cached brick and its position in the recency list. */
+    struct CacheSlot {
+        std::shared_ptr<const OccupancyGrid> occupancy; // Brick occupancy
+        std::list<size_t>::iterator recency;            // Position in lru_
+    };
+
+private: // Methods
+    /** @brief Get the linear index of a brick. */
+    size_t brick_index(const glm::ivec3& brick) const {
+        return (static_cast<size_t>(brick.z) * counts_.y + brick.y) * counts_.x + brick.x;
+    }
+
+    /** @brief Get the brick coordinates of a linear index. */
+    glm::ivec3 brick_coords(size_t index) const;
+
+private: // Variables
+    std::filesystem::path dir_;                         // Store directory
+    Grid grid_;                                         // Full grid layout
+    glm::ivec3 counts_ = glm::ivec3(0);                 // Bricks per axis
+    std::unordered_map<size_t, Entry> index_;           // Stored bricks by linear index
+    size_t occupied_ = 0;                               // Occupied voxels of all bricks
+    uint64_t data_size_ = 0;                            // Bytes written to the data file
+
+    std::ofstream writer_;                              // Data file while carving
+    std::ifstream reader_;                              // Data file once finished
+
+    std::unordered_map<size_t, CacheSlot> cache_;       // Paged-in bricks
+    std::list<size_t> lru_;                             // Cached bricks, most recent first
+    size_t cache_bytes_ = 0;                            // Memory of the cached bricks
+    size_t budget_ = size_t(256) << 20;                 // Cache budget in bytes
+};
+
+
+/**
+ * @brief Carve a grid brick by brick into a store, holding only one brick in memory.
+ *
+ * A footprint carve with one coarse voxel per brick culls bricks that cannot contain the hull. The
+ * remaining bricks are carved one at a time with the carver's strategy through a single reused
+ * occupancy buffer and streamed to the store; empty ones are dropped. The store is finished and the
+ * carver reset on return.
+ *
+ * @param carver Carver providing the strategy and the per-brick carves.
+ * @param views Calibrated views with masks.
+ * @param grid Grid to carve.
+ * @param dir Store directory.
+ * @param store Output store.
+ * @param stats Output statistics.
+ * @return False if the store could not be written.
+ */
+bool carve_bricks(Carver& carver, const std::vector<View>& views, const Grid& grid, const std::filesystem::path& dir,
+    BrickStore& store, BrickStats& stats);
+
+/**
+ * @brief Get the bytes of a full in-memory occupancy grid.
+ * @param grid Grid layout.
+ * @return Memory of OccupancyGrid(grid).
+ */
+size_t occupancy_bytes(const Grid& grid);
+
+/**
+ * @brief Estimate the peak memory of carving a grid in core.
+ *
+ * Counts the occupancy and the per-view data the strategy builds: a projection table (4 bytes per
+ * voxel) and a packed mask per view for dense and consensus carves, plus the view counters (1 byte per
+ * voxel, 2 beyond 255 views) and packed mask copies of consensus carves, and a 32-bit integral image
+ * per view for octree and footprint carves. Polyhedral carves allocate no voxels: their silhouette polygons and mesh do not grow with the
+ * grid, so they count as zero.
+ *
+ * @param views Views with masks.
+ * @param grid Grid to carve.
+ * @param strategy Carve strategy.
+ * @return Estimated bytes.
+ */
+size_t carve_bytes(const std::vector<View>& views, const Grid& grid, CarveStrategy strategy);
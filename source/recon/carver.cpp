@@ -0,0 +1,714 @@
+#include "carver.hpp"
+
+#include <array>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+
+#include <omp.h>
+#include <glm/glm.hpp>
+
+#include "ordering.hpp"
+
+
+// Mask value of foreground pixels
+constexpr const uint8_t MASK_FOREGROUND = std::numeric_limits<uint8_t>::max();
+
+// Octree configuration: root blocks of 16^3 voxels give five levels (16, 8, 4, 2, 1)
+constexpr const int OCTREE_ROOT_SIZE = 16;
+constexpr const int OCTREE_LEVELS = 5;
+constexpr const int OCTREE_MAX_VIEWS = 64;
+
+// Extra pixels around projected block footprints to absorb rounding and lens distortion
+constexpr const int FOOTPRINT_MARGIN = 2;
+
+
+/* Functions */
+
+bool parse_carve_strategy(const std::string& name, CarveStrategy& strategy) {
+    if (name == "dense") {
+        strategy = CarveStrategy::DENSE;
+        return true;
+    }
+    if (name == "octree") {
+        strategy = CarveStrategy::OCTREE;
+        return true;
+    }
+    if (name == "footprint") {
+        strategy = CarveStrategy::FOOTPRINT;
+        return true;
+    }
+    if (name == "consensus") {
+        strategy = CarveStrategy::CONSENSUS;
+        return true;
+    }
+    if (name == "polyhedral") {
+        strategy = CarveStrategy::POLYHEDRAL;
+        return true;
+    }
+    return false;
+}
+
+const char* carve_strategy_name(CarveStrategy strategy) {
+    switch (strategy) {
+        case CarveStrategy::DENSE:
+            return "dense";
+        case CarveStrategy::OCTREE:
+            return "octree";
+        case CarveStrategy::FOOTPRINT:
+            return "footprint";
+        case CarveStrategy::CONSENSUS:
+            return "consensus";
+        case CarveStrategy::POLYHEDRAL:
+            return "polyhedral";
+    }
+    return "unknown";
+}
+
+
+/* CarveStats */
+
+void CarveStats::print() const {
+    if (strategy == CarveStrategy::POLYHEDRAL) {
+        std::cout << "Carve (polyhedral): " << mesh_triangles << " triangles in " << carve_ms << " ms" << std::endl;
+        std::cout << "  mesh: " << contour_vertices << " contour vertices, " << viewing_edges << " viewing edges, "
+                  << open_faces << " open faces, " << mesh_bytes / 1024 << " KiB" << std::endl;
+        return;
+    }
+
+    std::cout << "Carve (" << carve_strategy_name(strategy) << "): " << occupied << " occupied voxels in "
+              << carve_ms << " ms";
+    if (strategy == CarveStrategy::CONSENSUS) {
+        std::cout << ", at least " << min_views << " of " << views.size() << " views";
+    }
+    std::cout << std::endl;
+
+    for (size_t level = 0; level < tested_per_level.size(); ++level) {
+        std::cout << "  level " << level << ": " << tested_per_level[level] << " cells tested" << std::endl;
+    }
+
+    for (size_t v = 0; v < views.size(); ++v) {
+        const ViewProfile& view = views[v];
+        std::cout << "  view " << v << ": table " << view.table_bytes / 1024 << " KiB in " << view.table_ms << " ms, "
+                  << "integral " << view.integral_bytes / 1024 << " KiB in " << view.integral_ms << " ms, "
+                  << "packed " << view.packed_bytes / 1024 << " KiB in " << view.pack_ms << " ms";
+
+        if (view.tested > 0) {
+            std::cout << ", rejected " << view.rejected << " of " << view.tested << " tests ("
+                      << 100.0 * view.rejected / view.tested << "%)";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!view_order.empty()) {
+        std::cout << "  view order:";
+        for (int v : view_order) {
+            std::cout << " " << v;
+        }
+        std::cout << std::endl;
+    }
+}
+
+
+/* Public methods */
+
+void Carver::carve(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy) {
+    auto start = std::chrono::steady_clock::now();
+
+    stats_ = CarveStats();
+    stats_.strategy = strategy_;
+    stats_.views.resize(views.size());
+
+    // Polyhedral carves produce a mesh only; their occupancy keeps the grid placement without voxels
+    Grid layout = grid;
+    if (strategy_ == CarveStrategy::POLYHEDRAL) {
+        layout.num_x = layout.num_y = layout.num_z = 0;
+    }
+    occupancy.reset(layout);
+    consensus_.clear();
+    consensus_masks_.clear();
+    hull_.clear();
+
+    // An empty mask rejects every voxel
+    bool all_masks = !views.empty() && std::ranges::none_of(views, [](const View& view) { return view.mask.empty(); });
+
+    if (all_masks) {
+        if (strategy_ == CarveStrategy::OCTREE && views.size() <= OCTREE_MAX_VIEWS) {
+            carve_octree(views, grid, occupancy);
+        }
+        else if (strategy_ == CarveStrategy::FOOTPRINT) {
+            carve_footprint(views, grid, occupancy);
+        }
+        else if (strategy_ == CarveStrategy::CONSENSUS && views.size() <= CONSENSUS_MAX_VIEWS) {
+            carve_consensus(views, grid, occupancy);
+        }
+        else if (strategy_ == CarveStrategy::POLYHEDRAL) {
+            carve_polyhedral(views, grid);
+        }
+        else {
+            stats_.strategy = CarveStrategy::DENSE;
+            carve_dense(views, grid, occupancy);
+        }
+    }
+
+    stats_.occupied = occupancy.count();
+    stats_.carve_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Carver::extract(int min_views, OccupancyGrid& occupancy) {
+    if (consensus_.empty()) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    min_views_ = min_views;
+    stats_.min_views = min_views_ > 0 ? std::min(min_views_, consensus_.view_count()) : consensus_.view_count();
+    consensus_.threshold(stats_.min_views, occupancy);
+
+    stats_.occupied = occupancy.count();
+    stats_.carve_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool Carver::update_view(const std::vector<View>& views, int view_index, OccupancyGrid& occupancy) {
+    const Grid& grid = consensus_.grid();
+
+    if (consensus_.empty() || view_index < 0 || view_index >= static_cast<int>(views.size())
+    ||  consensus_.view_count() != static_cast<int>(views.size()) || !(occupancy.grid() == grid)
+    ||  views[view_index].mask.size() != consensus_masks_[view_index].size()
+    ||  !tables_[view_index].is_valid_for(views[view_index], grid)) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Keep a private copy: the caller may edit the view mask in place before the next update
+    PackedMask new_mask;
+    new_mask.build(views[view_index].mask);
+    const uint64_t* old_data = consensus_masks_[view_index].data();
+    const uint64_t* new_data = new_mask.data();
+    const uint32_t* table = tables_[view_index].data();
+    const int num_rows = static_cast<int>(grid.row_count());
+
+#pragma omp parallel
+    {
+        std::vector<uint8_t> old_hits(grid.num_x);
+        std::vector<uint8_t> new_hits(grid.num_x);
+
+#pragma omp for schedule(static)
+        for (int row = 0; row < num_rows; ++row) {
+            const int yi = row % grid.num_y;
+            const int zi = row / grid.num_y;
+            const uint32_t* row_table = table + grid.index(0, yi, zi);
+
+            bool changed = false;
+            for (int xi = 0; xi < grid.num_x; ++xi) {
+                uint32_t pixel = row_table[xi];
+                old_hits[xi] = pixel != ProjectionTable::OUTSIDE && PackedMask::test(old_data, pixel);
+                new_hits[xi] = pixel != ProjectionTable::OUTSIDE && PackedMask::test(new_data, pixel);
+                changed |= old_hits[xi] != new_hits[xi];
+            }
+
+            if (changed) {
+                consensus_.update_row(yi, zi, old_hits.data(), new_hits.data());
+            }
+        }
+    }
+
+    consensus_masks_[view_index] = std::move(new_mask);
+    consensus_.threshold(stats_.min_views, occupancy);
+
+    stats_.occupied = occupancy.count();
+    stats_.tested_per_level = { grid.voxel_count() };
+    stats_.carve_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool Carver::carve_band(const std::vector<View>& views, int margin, bool bounded, OccupancyGrid& occupancy) {
+    const Grid grid = occupancy.grid();
+
+    bool all_masks = !views.empty() && std::ranges::none_of(views, [](const View& view) { return view.mask.empty(); });
+    // The band is tested per voxel sample: polyhedral hulls are rebuilt with their mesh, and footprint hulls keep
+    // voxels whose cube only overlaps the foreground, which the samples cannot tell
+    const bool sampled = strategy_ != CarveStrategy::POLYHEDRAL && strategy_ != CarveStrategy::FOOTPRINT;
+    if (!all_masks || margin < 1 || !sampled || occupancy.count() == 0) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Shells of the previous hull: reach..outer is the outermost tested shell, inner..core the innermost
+    OccupancyGrid reach = occupancy;
+    reach.dilate(margin - 1);
+    OccupancyGrid outer = reach;
+    outer.dilate(1);
+    OccupancyGrid inner = occupancy;
+    inner.erode(margin);
+    OccupancyGrid core = inner;
+    core.erode(1);
+
+    stats_ = CarveStats();
+    stats_.strategy = strategy_;
+    stats_.views.resize(views.size());
+    consensus_.clear();
+    consensus_masks_.clear();
+    update_tables(views, grid);
+    update_packed(views);
+
+    std::vector<const uint64_t*> mask_data(views.size());
+    std::vector<const uint32_t*> table_data(views.size());
+
+    for (size_t i = 0; i < views.size(); ++i) {
+        mask_data[i] = packed_[i].data();
+        table_data[i] = tables_[i].data();
+    }
+
+    const int num_views = static_cast<int>(views.size());
+    const int num_rows = static_cast<int>(grid.row_count());
+    const int words_per_row = occupancy.words_per_row();
+
+    int min_views = num_views;
+    if (strategy_ == CarveStrategy::CONSENSUS) {
+        min_views = min_views_ > 0 ? std::min(min_views_, num_views) : num_views;
+        stats_.min_views = min_views;
+    }
+
+    // The core is kept untested; the band is tested on top of it
+    occupancy = core;
+    long long tested = 0;
+    int failures = 0;
+
+#pragma omp parallel for reduction(+:tested, failures) schedule(dynamic, 4)
+    for (int row = 0; row < num_rows; ++row) {
+        const int yi = row % grid.num_y;
+        const int zi = row / grid.num_y;
+        const size_t row_start = grid.index(0, yi, zi);
+        const bool face_row = bounded && (yi == 0 || zi == 0 || yi == grid.num_y - 1 || zi == grid.num_z - 1);
+        uint64_t* words = occupancy.row(yi, zi);
+
+        for (int w = 0; w < words_per_row; ++w) {
+            uint64_t bits = outer.row(yi, zi)[w] & ~core.row(yi, zi)[w];
+
+            while (bits) {
+                const int xi = w * 64 + std::countr_zero(bits);
+                const uint64_t bit = bits & (~bits + 1);
+                const size_t idx = row_start + xi;
+                bits &= bits - 1;
+
+                // Stop as soon as k hits are found or can no longer be reached
+                int hits = 0;
+                for (int v = 0; v < num_views && hits < min_views && hits + num_views - v >= min_views; ++v) {
+                    uint32_t pixel = table_data[v][idx];
+                    hits += pixel != ProjectionTable::OUTSIDE && PackedMask::test(mask_data[v], pixel);
+                }
+                ++tested;
+
+                if (hits >= min_views) {
+                    words[w] |= bit;
+                    const bool face = face_row || (bounded && (xi == 0 || xi == grid.num_x - 1));
+                    failures += !(reach.row(yi, zi)[w] & bit) || face;
+                }
+                else {
+                    failures += (inner.row(yi, zi)[w] & bit) != 0;
+                }
+            }
+        }
+    }
+
+    stats_.tested_per_level = { static_cast<size_t>(tested) };
+    stats_.occupied = occupancy.count();
+    stats_.carve_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return failures == 0;
+}
+
+void Carver::reset() {
+    tables_.clear();
+    integrals_.clear();
+    packed_.clear();
+    consensus_.clear();
+    consensus_masks_.clear();
+    hull_.clear();
+    stats_ = CarveStats();
+}
+
+
+/* Private methods */
+
+void Carver::record_rejections(const std::vector<size_t>& tested, const std::vector<size_t>& rejected) {
+    for (size_t v = 0; v < stats_.views.size(); ++v) {
+        stats_.views[v].tested = tested[v];
+        stats_.views[v].rejected = rejected[v];
+    }
+    stats_.view_order = order_by_rejection(tested, rejected);
+}
+
+void Carver::update_tables(const std::vector<View>& views, const Grid& grid) {
+    tables_.resize(views.size());
+
+    // Stale tables are built one view per thread when they fill all threads; fewer are built one after the
+    // other with the parallel slab loop of the table build, as nested regions would run on one thread
+    std::vector<int> stale;
+    for (size_t i = 0; i < views.size(); ++i) {
+        if (!tables_[i].is_valid_for(views[i], grid)) {
+            stale.push_back(static_cast<int>(i));
+        }
+    }
+
+    const int num_stale = static_cast<int>(stale.size());
+#pragma omp parallel for schedule(dynamic, 1) if (num_stale >= omp_get_max_threads())
+    for (int s = 0; s < num_stale; ++s) {
+        const int i = stale[s];
+        auto start = std::chrono::steady_clock::now();
+        tables_[i].build(views[i], grid);
+        stats_.views[i].table_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    for (size_t i = 0; i < views.size(); ++i) {
+        stats_.views[i].table_bytes = tables_[i].memory_bytes();
+    }
+}
+
+void Carver::update_integrals(const std::vector<View>& views) {
+    integrals_.resize(views.size());
+
+    // Masks may be edited between carves, so the integrals are always rebuilt
+    const int num_views = static_cast<int>(views.size());
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int v = 0; v < num_views; ++v) {
+        auto start = std::chrono::steady_clock::now();
+        integrals_[v].build(views[v].mask);
+        stats_.views[v].integral_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats_.views[v].integral_bytes = integrals_[v].memory_bytes();
+    }
+}
+
+void Carver::update_packed(const std::vector<View>& views) {
+    packed_.resize(views.size());
+
+    // Masks may be edited between carves, so they are always re-packed, one view per thread when the views
+    // fill all threads and with the parallel row loop of the packing otherwise
+    const int num_views = static_cast<int>(views.size());
+
+#pragma omp parallel for schedule(dynamic, 1) if (num_views >= omp_get_max_threads())
+    for (int v = 0; v < num_views; ++v) {
+        auto start = std::chrono::steady_clock::now();
+        packed_[v].build(views[v].mask);
+        stats_.views[v].pack_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats_.views[v].packed_bytes = packed_[v].memory_bytes();
+    }
+}
+
+void Carver::carve_dense(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy) {
+    update_tables(views, grid);
+    update_packed(views);
+
+    // Collect mask and table pointers so the inner loop is a plain gather-and-AND
+    std::vector<const uint64_t*> mask_data(views.size());
+    std::vector<const uint32_t*> table_data(views.size());
+
+    for (size_t i = 0; i < views.size(); ++i) {
+        mask_data[i] = packed_[i].data();
+        table_data[i] = tables_[i].data();
+    }
+
+    const int num_views = static_cast<int>(views.size());
+    const int num_rows = static_cast<int>(grid.row_count());
+
+    std::vector<size_t> tested(views.size(), 0);
+    std::vector<size_t> rejected(views.size(), 0);
+
+#pragma omp parallel
+    {
+        ViewOrder view_order(tested, rejected);
+
+#pragma omp for schedule(dynamic, 4)
+        for (int row = 0; row < num_rows; ++row) {
+            const int yi = row % grid.num_y;
+            const int zi = row / grid.num_y;
+            const size_t row_start = grid.index(0, yi, zi);
+            const int* order = view_order.order();
+            uint64_t* words = occupancy.row(yi, zi);
+
+            for (int xi = 0; xi < grid.num_x; ++xi) {
+                const size_t idx = row_start + xi;
+
+                bool all_visible = true;
+                for (int k = 0; k < num_views && all_visible; ++k) {
+                    const int v = order[k];
+                    uint32_t pixel = table_data[v][idx];
+                    all_visible = pixel != ProjectionTable::OUTSIDE && PackedMask::test(mask_data[v], pixel);
+                    view_order.record(v, !all_visible);
+                }
+
+                if (all_visible) {
+                    words[xi >> 6] |= uint64_t(1) << (xi & 63);
+                }
+            }
+
+            view_order.row_done();
+        }
+
+        view_order.synchronize();
+    }
+
+    record_rejections(tested, rejected);
+    stats_.tested_per_level = { grid.voxel_count() };
+}
+
+void Carver::carve_consensus(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy) {
+    update_tables(views, grid);
+    update_packed(views);
+
+    // Counted masks are copied so later mask edits can be applied incrementally
+    consensus_masks_ = packed_;
+    std::vector<const uint64_t*> mask_data(views.size());
+
+    for (size_t i = 0; i < views.size(); ++i) {
+        mask_data[i] = consensus_masks_[i].data();
+    }
+
+    const int num_views = static_cast<int>(views.size());
+    const int num_rows = static_cast<int>(grid.row_count());
+    consensus_.reset(grid, num_views);
+
+#pragma omp parallel
+    {
+        std::vector<uint8_t> hits(grid.num_x);
+
+#pragma omp for schedule(dynamic, 4)
+        for (int row = 0; row < num_rows; ++row) {
+            const int yi = row % grid.num_y;
+            const int zi = row / grid.num_y;
+            const size_t row_start = grid.index(0, yi, zi);
+
+            // Every view is tested for every voxel, so the counters support any k afterwards
+            for (int v = 0; v < num_views; ++v) {
+                const uint32_t* table = tables_[v].data() + row_start;
+                for (int xi = 0; xi < grid.num_x; ++xi) {
+                    hits[xi] = table[xi] != ProjectionTable::OUTSIDE && PackedMask::test(mask_data[v], table[xi]);
+                }
+                consensus_.add_row(yi, zi, hits.data());
+            }
+        }
+    }
+
+    stats_.min_views = min_views_ > 0 ? std::min(min_views_, num_views) : num_views;
+    consensus_.threshold(stats_.min_views, occupancy);
+    stats_.tested_per_level = { grid.voxel_count() * views.size() };
+}
+
+void Carver::carve_octree(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy) {
+    update_integrals(views);
+
+    const int roots_x = (grid.num_x + OCTREE_ROOT_SIZE - 1) / OCTREE_ROOT_SIZE;
+    const int roots_y = (grid.num_y + OCTREE_ROOT_SIZE - 1) / OCTREE_ROOT_SIZE;
+    const int roots_z = (grid.num_z + OCTREE_ROOT_SIZE - 1) / OCTREE_ROOT_SIZE;
+    const int num_columns = roots_y * roots_z;
+
+    const uint64_t all_views = views.size() == OCTREE_MAX_VIEWS
+        ? std::numeric_limits<uint64_t>::max()
+        : (uint64_t(1) << views.size()) - 1;
+
+    std::vector<std::vector<size_t>> thread_tested(omp_get_max_threads(), std::vector<size_t>(OCTREE_LEVELS, 0));
+
+#pragma omp parallel
+    {
+        auto& tested = thread_tested[omp_get_thread_num()];
+
+        // Each task owns a full run of root blocks along X, so no two threads write the same occupancy word
+#pragma omp for schedule(dynamic, 1) nowait
+        for (int column = 0; column < num_columns; ++column) {
+            for (int rx = 0; rx < roots_x; ++rx) {
+                glm::ivec3 begin(
+                    rx * OCTREE_ROOT_SIZE,
+                    (column % roots_y) * OCTREE_ROOT_SIZE,
+                    (column / roots_y) * OCTREE_ROOT_SIZE
+                );
+                glm::ivec3 end = glm::min(begin + glm::ivec3(OCTREE_ROOT_SIZE), glm::ivec3(grid.num_x, grid.num_y, grid.num_z));
+
+                carve_block(views, grid, occupancy, begin, end, all_views, 0, tested);
+            }
+        }
+    }
+
+    stats_.tested_per_level.assign(OCTREE_LEVELS, 0);
+    for (const auto& tested : thread_tested) {
+        for (int level = 0; level < OCTREE_LEVELS; ++level) {
+            stats_.tested_per_level[level] += tested[level];
+        }
+    }
+}
+
+void Carver::carve_polyhedral(const std::vector<View>& views, const Grid& grid) {
+    hull_.build(views, grid);
+
+    stats_.contour_vertices = hull_.contour_vertex_count();
+    stats_.viewing_edges = hull_.viewing_edge_count();
+    stats_.open_faces = hull_.open_face_count();
+    stats_.mesh_triangles = hull_.triangles().size() / 3;
+    stats_.mesh_bytes = hull_.memory_bytes();
+}
+
+void Carver::carve_footprint(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy) {
+    update_integrals(views);
+
+    // Voxel cubes share their corners, so project the lattice of corners once per slab
+    Grid corners = grid;
+    corners.num_x = grid.num_x + 1;
+    corners.num_y = grid.num_y + 1;
+    corners.num_z = grid.num_z + 1;
+    corners.origin = grid.origin - glm::vec3(grid.voxel_size * 0.5f);
+
+    const int num_views = static_cast<int>(views.size());
+    const size_t corner_slice = static_cast<size_t>(corners.num_x) * corners.num_y;
+    const size_t view_stride = corner_slice * 2;
+
+    // Offsets of the eight cube corners relative to the lower corner, within a two-layer slab
+    std::array<size_t, 8> offsets;
+    for (int corner = 0; corner < 8; ++corner) {
+        offsets[corner] = ((corner & 4) ? corner_slice : 0) + ((corner & 2) ? corners.num_x : 0) + ((corner & 1) ? 1 : 0);
+    }
+
+    std::vector<size_t> tested(views.size(), 0);
+    std::vector<size_t> rejected(views.size(), 0);
+
+#pragma omp parallel
+    {
+        std::vector<float> px(view_stride * num_views);
+        std::vector<float> py(view_stride * num_views);
+        ViewOrder view_order(tested, rejected);
+
+#pragma omp for schedule(dynamic, 1)
+        for (int zi = 0; zi < grid.num_z; ++zi) {
+            for (int v = 0; v < num_views; ++v) {
+                project_grid(views[v].pinhole, corners, zi, zi + 2, px.data() + v * view_stride, py.data() + v * view_stride);
+            }
+
+            for (int yi = 0; yi < grid.num_y; ++yi) {
+                const int* order = view_order.order();
+
+                for (int xi = 0; xi < grid.num_x; ++xi) {
+                    const size_t base = static_cast<size_t>(yi) * corners.num_x + xi;
+
+                    bool overlaps = true;
+                    for (int k = 0; k < num_views && overlaps; ++k) {
+                        const int v = order[k];
+                        const float* vx = px.data() + v * view_stride + base;
+                        const float* vy = py.data() + v * view_stride + base;
+
+                        std::array<cv::Point2f, 8> pixels;
+                        for (int corner = 0; corner < 8; ++corner) {
+                            pixels[corner] = cv::Point2f(vx[offsets[corner]], vy[offsets[corner]]);
+                        }
+
+                        // The cube is already conservative, so no margin beyond pixel rounding is added
+                        Footprint footprint = bound_footprint(pixels.data(), static_cast<int>(pixels.size()), 0);
+                        overlaps = integrals_[v].classify(footprint) != Coverage::EMPTY;
+                        view_order.record(v, !overlaps);
+                    }
+
+                    if (overlaps) {
+                        occupancy.set(xi, yi, zi);
+                    }
+                }
+
+                view_order.row_done();
+            }
+        }
+
+        view_order.synchronize();
+    }
+
+    record_rejections(tested, rejected);
+
+    stats_.tested_per_level = { grid.voxel_count() };
+}
+
+void Carver::carve_block(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy,
+    const glm::ivec3& begin, const glm::ivec3& end, uint64_t active, int level, std::vector<size_t>& tested) const {
+    tested[level]++;
+
+    const glm::ivec3 size = end - begin;
+
+    // Single voxel: test its sample point directly against the remaining views
+    if (size.x == 1 && size.y == 1 && size.z == 1) {
+        glm::vec3 pos = grid.position(begin.x, begin.y, begin.z);
+
+        for (size_t v = 0; v < views.size(); ++v) {
+            if (!(active & (uint64_t(1) << v))) {
+                continue;
+            }
+
+            const cv::Mat& mask = views[v].mask;
+            cv::Point2f pixel = views[v].pinhole.project(pos);
+            if (!(pixel.x > -1.0f && pixel.x < mask.cols && pixel.y > -1.0f && pixel.y < mask.rows)) {
+                return;
+            }
+
+            int px = cvRound(pixel.x);
+            int py = cvRound(pixel.y);
+            if (px < 0 || px >= mask.cols || py < 0 || py >= mask.rows || mask.at<uint8_t>(py, px) != MASK_FOREGROUND) {
+                return;
+            }
+        }
+
+        occupancy.set(begin.x, begin.y, begin.z);
+        return;
+    }
+
+    // Classify the block footprint in every view that is not yet known to cover it
+    glm::vec3 box_min = grid.position(begin.x, begin.y, begin.z);
+    glm::vec3 box_max = grid.position(end.x - 1, end.y - 1, end.z - 1);
+
+    for (size_t v = 0; v < views.size(); ++v) {
+        if (!(active & (uint64_t(1) << v))) {
+            continue;
+        }
+
+        Footprint footprint = project_footprint(views[v].pinhole, box_min, box_max, FOOTPRINT_MARGIN);
+        Coverage coverage = integrals_[v].classify(footprint);
+
+        if (coverage == Coverage::EMPTY) {
+            return;
+        }
+        if (coverage == Coverage::FULL) {
+            active &= ~(uint64_t(1) << v);
+        }
+    }
+
+    // Block is inside the silhouette of every view: occupy it without further tests
+    if (active == 0) {
+        for (int z = begin.z; z < end.z; ++z) {
+            for (int y = begin.y; y < end.y; ++y) {
+                occupancy.set_run(begin.x, end.x, y, z);
+            }
+        }
+        return;
+    }
+
+    // Boundary block: recurse into the (up to eight) children
+    const glm::ivec3 half = glm::max((size + glm::ivec3(1)) / 2, glm::ivec3(1));
+
+    for (int child = 0; child < 8; ++child) {
+        glm::ivec3 child_begin(
+            begin.x + ((child & 1) ? half.x : 0),
+            begin.y + ((child & 2) ? half.y : 0),
+            begin.z + ((child & 4) ? half.z : 0)
+        );
+        glm::ivec3 child_end(
+            (child & 1) ? end.x : std::min(begin.x + half.x, end.x),
+            (child & 2) ? end.y : std::min(begin.y + half.y, end.y),
+            (child & 4) ? end.z : std::min(begin.z + half.z, end.z)
+        );
+
+        if (child_begin.x >= child_end.x || child_begin.y >= child_end.y || child_begin.z >= child_end.z) {
+            continue;
+        }
+
+        carve_block(views, grid, occupancy, child_begin, child_end, active, std::min(level + 1, OCTREE_LEVELS - 1), tested);
+    }
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "consensus.hpp"
+#include "footprint.hpp"
+#include "occupancy.hpp"
+#include "packed.hpp"
+#include "polyhedral.hpp"
+#include "projection.hpp"
+
+
+/**
+ * @enum CarveStrategy
+ * @brief Selects the algorithm used to carve the visual hull.
+ *
+ * - DENSE: Test every voxel against every view through cached projection tables
+ * - OCTREE: Classify coarse blocks first and only recurse into blocks on the silhouette boundary
+ * - FOOTPRINT: Keep every voxel whose projected cube overlaps the foreground of every view
+ * - CONSENSUS: Count the views that see each voxel as foreground and keep voxels seen by at least k views
+ * - POLYHEDRAL: Build the exact polyhedral hull of vectorized silhouettes as a watertight mesh, without voxels
+ */
+enum class CarveStrategy {
+    DENSE,
+    OCTREE,
+    FOOTPRINT,
+    CONSENSUS,
+    POLYHEDRAL
+};
+
+
+/**
+ * @brief Parse a carve strategy name ("dense", "octree", "footprint", "consensus", "polyhedral").
+ * @param name Strategy name.
+ * @param strategy Output strategy.
+ * @return True if the name is known.
+ */
+bool parse_carve_strategy(const std::string& name, CarveStrategy& strategy);
+
+/**
+ * @brief Get the name of a carve strategy.
+ * @param strategy Strategy.
+ * @return Strategy name.
+ */
+const char* carve_strategy_name(CarveStrategy strategy);
+
+
+/**
+ * @struct ViewProfile
+ * @brief Precompute cost and memory of the per-view carve data.
+ *
+ * Members:
+ * - table_ms: Time spent building the projection table (0 when reused).
+ * - table_bytes: Memory used by the projection table.
+ * - integral_ms: Time spent building the mask integral image.
+ * - integral_bytes: Memory used by the mask integral image.
+ * - pack_ms: Time spent packing the mask into bit tiles.
+ * - packed_bytes: Memory used by the packed mask.
+ * - tested: Number of voxel tests against the view.
+ * - rejected: Number of voxels the view rejected.
+ */
+struct ViewProfile {
+    double table_ms = 0.0;          // Projection table build time
+    size_t table_bytes = 0;         // Projection table memory
+    double integral_ms = 0.0;       // Integral image build time
+    size_t integral_bytes = 0;      // Integral image memory
+    double pack_ms = 0.0;           // Mask packing time
+    size_t packed_bytes = 0;        // Packed mask memory
+    size_t tested = 0;              // Voxel tests
+    size_t rejected = 0;            // Voxel rejections
+};
+
+
+/**
+ * @struct CarveStats
+ * @brief Work and timing counters of the last carve.
+ *
+ * Members:
+ * - strategy: Strategy used.
+ * - carve_ms: Wall time of the carve in milliseconds.
+ * - occupied: Number of occupied voxels.
+ * - min_views: Number of views required to keep a voxel (consensus carves only).
+ * - tested_per_level: Number of cells tested per level (level 0 is the coarsest; dense carves have one level).
+ * - views: Precompute cost, memory and rejection counts per view.
+ * - view_order: Final view test order, most selective first (per-voxel strategies only).
+ * - contour_vertices: Silhouette polygon vertices over all views (polyhedral carves only).
+ * - viewing_edges: Hull edges on the viewing rays of contour vertices (polyhedral carves only).
+ * - open_faces: Hull faces left open by degenerate configurations (polyhedral carves only).
+ * - mesh_triangles: Triangles of the hull mesh (polyhedral carves only).
+ * - mesh_bytes: Memory used by the polygons and the hull mesh (polyhedral carves only).
+ */
+struct CarveStats {
+    CarveStrategy strategy = CarveStrategy::DENSE;  // Strategy used
+    double carve_ms = 0.0;                          // Carve wall time
+    size_t occupied = 0;                            // Occupied voxels
+    int min_views = 0;                              // Views required per voxel
+    std::vector<size_t> tested_per_level;           // Cells tested per level
+    std::vector<ViewProfile> views;                 // Per-view profile
+    std::vector<int> view_order;                    // Final view test order
+    size_t contour_vertices = 0;                    // Silhouette polygon vertices
+    size_t viewing_edges = 0;                       // Hull edges on viewing rays
+    size_t open_faces = 0;                          // Hull faces left open
+    size_t mesh_triangles = 0;                      // Hull mesh triangles
+    size_t mesh_bytes = 0;                          // Polygon and mesh memory
+
+    /** @brief Print the statistics to standard output. */
+    void print() const;
+};
+
+
+/**
+ * @class Carver
+ * @brief Reconstructs the visual hull of a set of calibrated views by voxel carving.
+ *
+ * A voxel is kept when its sample point projects onto the foreground of every view mask.
+ * Per-view projection tables are cached between carves and only rebuilt when the grid or
+ * the calibration of a view changes, so re-carving after a mask update is a pure gather from
+ * bit-packed masks, which are re-packed from the view masks on every carve.
+ * The hierarchical strategies classify projected footprints through per-view mask integral images.
+ * Consensus carves keep per-voxel view counts and a packed copy of every mask, so a change to one
+ * mask is applied incrementally.
+ * Per-voxel strategies test the views in order of decreasing rejection rate, learned during the carve.
+ * Polyhedral carves skip the tables and voxels altogether and build the exact hull mesh from vectorized silhouettes.
+ * Sequences of slowly moving subjects are carved frame to frame by only testing a band around the last hull.
+ */
+class Carver {
+public: // Methods
+    /**
+     * @brief Carve the visual hull of the views into an occupancy grid.
+     * @param views Calibrated views with masks.
+     * @param grid Voxel grid to carve.
+     * @param occupancy Output occupancy; reset to the grid layout before carving (without voxels for polyhedral carves, whose result is hull()).
+     */
+    void carve(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy);
+
+    /** @brief Drop all cached per-view data. */
+    void reset();
+
+    /**
+     * @brief Select the carve strategy.
+     * @param strategy Strategy to use for subsequent carves.
+     */
+    void set_strategy(CarveStrategy strategy) { strategy_ = strategy; }
+
+    /**
+     * @brief Set the number of views that must see a voxel as foreground in consensus carves.
+     * @param min_views Number of views k; 0 or less requires all views.
+     */
+    void set_min_views(int min_views) { min_views_ = min_views; }
+
+    /**
+     * @brief Re-extract the hull of the last consensus carve for a new k without projecting again.
+     * @param min_views Number of views k; 0 or less requires all views.
+     * @param occupancy Output occupancy.
+     * @return False if the last carve did not produce consensus counters.
+     */
+    bool extract(int min_views, OccupancyGrid& occupancy);
+
+    /**
+     * @brief Update the last consensus carve after the mask of a single view changed.
+     *
+     * Only the changed view is looked up again: its hits under the previous mask are replaced by its
+     * hits under the new mask in the consensus counters, after which the hull is re-extracted.
+     *
+     * @param views Calibrated views, identical to the last carve except for the mask of one view.
+     * @param view_index Index of the view whose mask changed.
+     * @param occupancy Occupancy of the last carve, updated in place.
+     * @return False if no incremental update is possible and a full carve is needed.
+     */
+    bool update_view(const std::vector<View>& views, int view_index, OccupancyGrid& occupancy);
+
+    /**
+     * @brief Carve the next frame of a sequence, seeded by the hull of the previous frame.
+     *
+     * Assuming the subject moved less than the margin, the new hull contains the previous hull eroded
+     * by the margin and is contained in the previous hull dilated by the margin. Only the band between
+     * the two (plus the innermost shell, for validation) is tested, per voxel sample as in dense carves
+     * (at least k views in consensus carves). The seed is rejected when a tested voxel on the outer
+     * shell is occupied or one on the inner shell is empty, i.e. when the subject moved too far.
+     * Footprint carves test whole voxel cubes rather than samples and are never seeded.
+     *
+     * @param views Calibrated views with the masks of the new frame.
+     * @param margin Motion margin in voxels (at least 1).
+     * @param bounded Whether the grid is a tight bound of a larger grid; occupied voxels on its faces then also reject the seed.
+     * @param occupancy Hull of the previous frame, replaced by the hull of the new frame.
+     * @return False if the seed was empty or rejected, or the strategy is polyhedral or footprint; the occupancy is then undefined and a full carve is needed.
+     */
+    bool carve_band(const std::vector<View>& views, int margin, bool bounded, OccupancyGrid& occupancy);
+
+public: // Getters
+    /** @brief Get the selected carve strategy. */
+    CarveStrategy strategy() const { return strategy_; }
+
+    /** @brief Get the number of views required in consensus carves (0 = all views). */
+    int min_views() const { return min_views_; }
+
+    /** @brief Get the consensus counters of the last consensus carve (empty otherwise). */
+    const ConsensusGrid& consensus() const { return consensus_; }
+
+    /** @brief Get the hull mesh of the last polyhedral carve (empty otherwise). */
+    const PolyhedralHull& hull() const { return hull_; }
+
+    /** @brief Get the statistics of the last carve. */
+    const CarveStats& stats() const { return stats_; }
+
+private: // Methods
+    /**
+     * @brief Store the merged rejection counts and the resulting view order in the statistics.
+     * @param tested Tests per view.
+     * @param rejected Rejections per view.
+     */
+    void record_rejections(const std::vector<size_t>& tested, const std::vector<size_t>& rejected);
+
+    /**
+     * @brief Rebuild the projection tables of views whose calibration or grid changed.
+     * @param views Calibrated views.
+     * @param grid Voxel grid.
+     */
+    void update_tables(const std::vector<View>& views, const Grid& grid);
+
+    /**
+     * @brief Rebuild the mask integral images of all views.
+     * @param views Views with masks.
+     */
+    void update_integrals(const std::vector<View>& views);
+
+    /**
+     * @brief Re-pack the masks of all views into bit tiles.
+     * @param views Views with masks.
+     */
+    void update_packed(const std::vector<View>& views);
+
+    /** @brief Test every voxel through the projection tables. */
+    void carve_dense(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy);
+
+    /** @brief Classify blocks coarse-to-fine and only test voxels of boundary blocks. */
+    void carve_octree(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy);
+
+    /** @brief Count the foreground views per voxel and threshold the counters. */
+    void carve_consensus(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy);
+
+    /** @brief Build the hull mesh from the silhouette polygons, clipped to the grid box. */
+    void carve_polyhedral(const std::vector<View>& views, const Grid& grid);
+
+    /** @brief Keep every voxel whose projected cube is not empty in any view. */
+    void carve_footprint(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy);
+
+    /**
+     * @brief Recursively carve one octree block.
+     * @param views Calibrated views.
+     * @param grid Voxel grid.
+     * @param occupancy Output occupancy.
+     * @param begin First voxel of the block.
+     * @param end One past the last voxel of the block (clipped to the grid).
+     * @param active Bitmask of views for which the block is not yet known to be fully foreground.
+     * @param level Depth of the block (0 = root block).
+     * @param tested Per-level test counters of the calling thread.
+     */
+    void carve_block(const std::vector<View>& views, const Grid& grid, OccupancyGrid& occupancy,
+        const glm::ivec3& begin, const glm::ivec3& end, uint64_t active, int level, std::vector<size_t>& tested) const;
+
+private: // Variables
+    CarveStrategy strategy_ = CarveStrategy::DENSE; // Selected strategy
+    int min_views_ = 0;                             // Views required in consensus carves (0 = all)
+    CarveStats stats_;                              // Statistics of the last carve
+    std::vector<ProjectionTable> tables_;           // Cached projection table per view
+    std::vector<MaskIntegral> integrals_;           // Mask integral image per view
+    std::vector<PackedMask> packed_;                // Bit-packed mask per view
+    ConsensusGrid consensus_;                       // Foreground view counts of the last consensus carve
+    std::vector<PackedMask> consensus_masks_;       // Masks counted in the consensus, for incremental updates
+    PolyhedralHull hull_;                           // Hull mesh of the last polyhedral carve
+};
@@ -0,0 +1,156 @@
+#include "coloring.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+
+
+// Depth slack, in voxel sizes, within which a voxel still counts as visible at its pixel
+constexpr const float VISIBILITY_TOLERANCE = 1.5f;
+
+// Minimum blend weight of a visible view, so views at grazing angles still count when nothing better sees a voxel
+constexpr const float MIN_VIEW_WEIGHT = 0.05f;
+
+// Photo hull iterations before the remaining shell is accepted
+constexpr const int PHOTO_HULL_MAX_ITERATIONS = 8;
+
+
+/* Functions */
+
+/** @brief Get the outward normal of a shell voxel from its exposed faces (zero if none). */
+static glm::vec3 face_normal(uint8_t faces) {
+    glm::vec3 normal(
+        ((faces & SHELL_FACE_POS_X) ? 1.0f : 0.0f) - ((faces & SHELL_FACE_NEG_X) ? 1.0f : 0.0f),
+        ((faces & SHELL_FACE_POS_Y) ? 1.0f : 0.0f) - ((faces & SHELL_FACE_NEG_Y) ? 1.0f : 0.0f),
+        ((faces & SHELL_FACE_POS_Z) ? 1.0f : 0.0f) - ((faces & SHELL_FACE_NEG_Z) ? 1.0f : 0.0f)
+    );
+    float length = glm::length(normal);
+    return length > 0.0f ? normal / length : normal;
+}
+
+
+/* ColorStats */
+
+void ColorStats::print() const {
+    std::cout << "Coloring: " << colored << " shell voxels colored, " << unseen << " unseen in " << color_ms << " ms";
+    if (iterations > 0) {
+        std::cout << ", " << removed << " photo-inconsistent voxels carved in " << iterations << " iterations";
+    }
+    std::cout << std::endl;
+}
+
+
+/* Public methods */
+
+void VoxelColorer::color(const std::vector<View>& views, OccupancyGrid& occupancy, SurfaceShell& shell, const glm::vec4& fallback) {
+    auto start = std::chrono::steady_clock::now();
+    stats_ = ColorStats();
+
+    std::vector<uint32_t> inconsistent;
+    for (;;) {
+        shade(views, shell, fallback, inconsistent);
+        if (inconsistent.empty() || stats_.iterations >= PHOTO_HULL_MAX_ITERATIONS) {
+            break;
+        }
+
+        // Carving exposes the voxels behind, which are colored and checked in the next iteration
+        const Grid& grid = shell.grid();
+        for (uint32_t i : inconsistent) {
+            const glm::ivec3 voxel = grid.coordinates(shell.indices()[i]);
+            occupancy.unset(voxel.x, voxel.y, voxel.z);
+        }
+
+        stats_.removed += inconsistent.size();
+        stats_.iterations++;
+        shell.build(occupancy);
+    }
+
+    stats_.color_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void VoxelColorer::clear() {
+    colors_.clear();
+    visibility_.clear();
+}
+
+
+/* Private methods */
+
+void VoxelColorer::shade(const std::vector<View>& views, const SurfaceShell& shell, const glm::vec4& fallback, std::vector<uint32_t>& inconsistent) {
+    const Grid& grid = shell.grid();
+    const int count = static_cast<int>(shell.size());
+
+    // Running sums per voxel: weighted color for the blend, plain moments for the consistency test
+    std::vector<glm::vec4> blend(count, glm::vec4(0.0f));
+    std::vector<glm::vec4> sum(count, glm::vec4(0.0f));
+    std::vector<glm::vec3> sum_sq(count, glm::vec3(0.0f));
+
+    for (const View& view : views) {
+        if (view.fg.empty() || view.fg.depth() != CV_8U || view.fg.size() != view.mask.size()) {
+            continue;
+        }
+
+        visibility_.render(view, grid, shell.indices(), &shell.faces());
+
+        const glm::vec3 center = view.pinhole.center();
+        const int channels = view.fg.channels();
+        const float slack = grid.voxel_size * VISIBILITY_TOLERANCE;
+
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < count; ++i) {
+            if (!visibility_.is_visible(i, slack)) {
+                continue;
+            }
+
+            const cv::Point2f& pixel = visibility_.pixel(i);
+            const int px = std::clamp(static_cast<int>(std::floor(pixel.x + 0.5f)), 0, view.fg.cols - 1);
+            const int py = std::clamp(static_cast<int>(std::floor(pixel.y + 0.5f)), 0, view.fg.rows - 1);
+
+            // Images are BGR(A) or grayscale
+            const uint8_t* p = view.fg.ptr<uint8_t>(py) + static_cast<size_t>(px) * channels;
+            const glm::vec3 rgb = channels >= 3 ? glm::vec3(p[2], p[1], p[0]) : glm::vec3(p[0]);
+
+            const glm::vec3 position = grid.position(grid.coordinates(shell.indices()[i]));
+            const glm::vec3 normal = face_normal(shell.faces()[i]);
+            const float facing = glm::dot(normal, glm::normalize(center - position));
+            const float weight = glm::length(normal) > 0.0f ? std::max(facing, MIN_VIEW_WEIGHT) : 1.0f;
+
+            blend[i] += glm::vec4(rgb * weight, weight);
+            sum[i] += glm::vec4(rgb, 1.0f);
+            sum_sq[i] += rgb * rgb;
+        }
+    }
+
+    colors_.resize(count);
+    std::vector<uint8_t> rejected(count, 0);
+    long long colored = 0;
+
+#pragma omp parallel for reduction(+:colored) schedule(static)
+    for (int i = 0; i < count; ++i) {
+        if (blend[i].w <= 0.0f) {
+            colors_[i] = fallback;
+            continue;
+        }
+
+        colors_[i] = glm::vec4(glm::vec3(blend[i]) / (blend[i].w * 255.0f), fallback.a);
+        ++colored;
+
+        // Standard deviation of the samples, averaged over the channels
+        if (threshold_ > 0.0f && sum[i].w >= 2.0f) {
+            const glm::vec3 mean = glm::vec3(sum[i]) / sum[i].w;
+            const glm::vec3 variance = glm::max(sum_sq[i] / sum[i].w - mean * mean, glm::vec3(0.0f));
+            rejected[i] = std::sqrt((variance.x + variance.y + variance.z) / 3.0f) > threshold_;
+        }
+    }
+
+    stats_.colored = static_cast<size_t>(colored);
+    stats_.unseen = shell.size() - stats_.colored;
+
+    inconsistent.clear();
+    for (int i = 0; i < count; ++i) {
+        if (rejected[i]) {
+            inconsistent.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "shell.hpp"
+#include "occupancy.hpp"
+#include "visibility.hpp"
+
+
+/**
+ * @struct ColorStats
+ * @brief Work and timing counters of the last coloring.
+ *
+ * Members:
+ * - color_ms: Wall time of the coloring (including photo hull iterations) in milliseconds.
+ * - colored: Shell voxels seen by at least one view.
+ * - unseen: Shell voxels occluded in or outside of every view.
+ * - removed: Voxels carved as photo-inconsistent.
+ * - iterations: Photo hull iterations run.
+ */
+struct ColorStats {
+    double color_ms = 0.0;          // Coloring wall time
+    size_t colored = 0;             // Colored shell voxels
+    size_t unseen = 0;              // Shell voxels without a visible view
+    size_t removed = 0;             // Photo-inconsistent voxels carved
+    int iterations = 0;             // Photo hull iterations
+
+    /** @brief Print the statistics to standard output. */
+    void print() const;
+};
+
+
+/**
+ * @class VoxelColorer
+ * @brief Colors the surface shell of a carved volume from the foreground images of the views.
+ *
+ * For every view the shell voxels are splatted into a CPU visibility buffer, so each voxel is only
+ * sampled by the views in which it is unoccluded. The samples are blended with
+ * weights given by the angle between the exposed faces of the voxel and the viewing direction.
+ * Optionally, voxels whose samples disagree by more than a threshold are carved away and the new
+ * shell is colored again until it is photo-consistent (photo hull).
+ */
+class VoxelColorer {
+public: // Methods
+    /**
+     * @brief Color the shell, carving photo-inconsistent voxels first if a threshold is set.
+     * @param views Calibrated views with foreground images and masks.
+     * @param occupancy Carved occupancy; photo-inconsistent voxels are removed from it.
+     * @param shell Surface shell of the occupancy; rebuilt when voxels are removed.
+     * @param fallback Color of shell voxels no view sees; its alpha is used for all voxels.
+     */
+    void color(const std::vector<View>& views, OccupancyGrid& occupancy, SurfaceShell& shell, const glm::vec4& fallback);
+
+    /**
+     * @brief Set the photo-consistency threshold of the photo hull.
+     * @param threshold Maximum standard deviation of a voxel's samples (0-255 scale); 0 or less disables carving.
+     */
+    void set_consistency_threshold(float threshold) { threshold_ = threshold; }
+
+    /**
+     * @brief Set the downsample factor of the visibility buffers.
+     * @param downsample Image pixels per buffer pixel along each axis (at least 1).
+     */
+    void set_visibility_downsample(int downsample) { visibility_.set_downsample(downsample); }
+
+    /** @brief Release the per-view buffers and colors. */
+    void clear();
+
+public: // Getters
+    /** @brief Get the color of every shell voxel, parallel to SurfaceShell::indices(). */
+    const std::vector<glm::vec4>& colors() const { return colors_; }
+
+    /** @brief Get the photo-consistency threshold (0 = disabled). */
+    float consistency_threshold() const { return threshold_; }
+
+    /** @brief Get the statistics of the last coloring. */
+    const ColorStats& stats() const { return stats_; }
+
+private: // Methods
+    /**
+     * @brief Sample every view at the shell voxels it sees and blend the colors.
+     * @param views Calibrated views.
+     * @param shell Surface shell.
+     * @param fallback Color of unseen voxels.
+     * @param inconsistent Output indices (into the shell) of photo-inconsistent voxels; filled only with a threshold.
+     */
+    void shade(const std::vector<View>& views, const SurfaceShell& shell, const glm::vec4& fallback, std::vector<uint32_t>& inconsistent);
+
+private: // Variables
+    float threshold_ = 0.0f;                // Photo-consistency threshold
+    ColorStats stats_;                      // Statistics of the last coloring
+    std::vector<glm::vec4> colors_;         // Color per shell voxel
+    VisibilityBuffer visibility_;           // Visibility buffer of the current view
+};
@@ -0,0 +1,123 @@
+#include "consensus.hpp"
+
+#include <algorithm>
+
+#include "simd.hpp"
+
+
+/* Functions */
+
+#if defined(SIMD_AVX2)
+// Threshold the leading multiple of 32 counters of a row, 32 per compare; returns the counters done
+SIMD_TARGET_AVX2 static int threshold_row_avx2(const uint8_t* counts, int count, uint8_t k, uint64_t* words) {
+    // count >= k  <=>  max(count, k) == count
+    const __m256i kv = _mm256_set1_epi8(static_cast<char>(k));
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + x));
+        __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(c, kv), c);
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(ge));
+        words[x >> 6] |= static_cast<uint64_t>(bits) << (x & 63);
+    }
+    return x;
+}
+#endif
+
+// Add one view's hits to a row of counters
+template <typename Count>
+static void add_hits(Count* counts, int count, const uint8_t* hits) {
+    // Plain adds; compilers turn this into 16- or 32-wide vector adds
+    for (int x = 0; x < count; ++x) {
+        counts[x] += hits[x];
+    }
+}
+
+// Replace one view's hits in a row of counters
+template <typename Count>
+static void replace_hits(Count* counts, int count, const uint8_t* old_hits, const uint8_t* new_hits) {
+    for (int x = 0; x < count; ++x) {
+        counts[x] = static_cast<Count>(counts[x] - old_hits[x] + new_hits[x]);
+    }
+}
+
+
+/* Public methods */
+
+void ConsensusGrid::reset(const Grid& grid, int num_views) {
+    grid_ = grid;
+    num_views_ = std::min(num_views, CONSENSUS_MAX_VIEWS);
+    counts_.clear();
+    wide_counts_.clear();
+
+    if (wide()) {
+        wide_counts_.assign(grid.voxel_count(), 0);
+    }
+    else {
+        counts_.assign(grid.voxel_count(), 0);
+    }
+}
+
+void ConsensusGrid::clear() {
+    counts_.clear();
+    counts_.shrink_to_fit();
+    wide_counts_.clear();
+    wide_counts_.shrink_to_fit();
+    num_views_ = 0;
+}
+
+void ConsensusGrid::add_row(int y, int z, const uint8_t* hits) {
+    if (wide()) {
+        add_hits(wide_counts_.data() + grid_.index(0, y, z), grid_.num_x, hits);
+    }
+    else {
+        add_hits(counts_.data() + grid_.index(0, y, z), grid_.num_x, hits);
+    }
+}
+
+void ConsensusGrid::update_row(int y, int z, const uint8_t* old_hits, const uint8_t* new_hits) {
+    if (wide()) {
+        replace_hits(wide_counts_.data() + grid_.index(0, y, z), grid_.num_x, old_hits, new_hits);
+    }
+    else {
+        replace_hits(counts_.data() + grid_.index(0, y, z), grid_.num_x, old_hits, new_hits);
+    }
+}
+
+void ConsensusGrid::threshold(int min_views, OccupancyGrid& occupancy) const {
+    occupancy.reset(grid_);
+
+    if (empty()) {
+        return;
+    }
+
+    const int k = std::clamp(min_views, 1, std::max(num_views_, 1));
+    const int num_rows = static_cast<int>(grid_.row_count());
+    const bool wide_counts = wide();
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const int y = r % grid_.num_y;
+        const int z = r / grid_.num_y;
+        uint64_t* words = occupancy.row(y, z);
+
+        // Rigs with more than CONSENSUS_BYTE_VIEWS views are rare enough for a scalar pass
+        if (wide_counts) {
+            const uint16_t* counts = wide_counts_.data() + grid_.index(0, y, z);
+            for (int x = 0; x < grid_.num_x; ++x) {
+                words[x >> 6] |= static_cast<uint64_t>(counts[x] >= k) << (x & 63);
+            }
+            continue;
+        }
+
+        const uint8_t* counts = counts_.data() + grid_.index(0, y, z);
+        int x = 0;
+#if defined(SIMD_AVX2)
+        if (cpu_has_avx2()) {
+            x = threshold_row_avx2(counts, grid_.num_x, static_cast<uint8_t>(k), words);
+        }
+#endif
+        for (; x < grid_.num_x; ++x) {
+            words[x >> 6] |= static_cast<uint64_t>(counts[x] >= k) << (x & 63);
+        }
+    }
+}
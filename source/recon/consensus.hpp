@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "grid.hpp"
+#include "occupancy.hpp"
+
+
+// Maximum number of views a byte counter can hold; larger rigs count in 16 bits
+constexpr const int CONSENSUS_BYTE_VIEWS = 255;
+
+// Maximum number of views a consensus counter can hold
+constexpr const int CONSENSUS_MAX_VIEWS = 65535;
+
+
+/**
+ * @class ConsensusGrid
+ * @brief Per-voxel count of the views whose silhouette contains the voxel.
+ *
+ * One byte per voxel in grid order, or two for more than CONSENSUS_BYTE_VIEWS views. Once filled, the hull of any "at least k of n views" rule is a
+ * single threshold pass over the counters, without projecting voxels again.
+ */
+class ConsensusGrid {
+public: // Methods
+    /**
+     * @brief Resize to a grid layout and zero all counters.
+     * @param grid Voxel grid layout.
+     * @param num_views Number of views that will be counted (at most CONSENSUS_MAX_VIEWS).
+     */
+    void reset(const Grid& grid, int num_views);
+
+    /** @brief Release the counters. */
+    void clear();
+
+    /**
+     * @brief Add one view's hits to a row of counters.
+     * @param y Row Y coordinate.
+     * @param z Row Z coordinate.
+     * @param hits One byte per voxel of the row, 1 if the view sees foreground and 0 otherwise.
+     */
+    void add_row(int y, int z, const uint8_t* hits);
+
+    /**
+     * @brief Replace one view's hits in a row of counters.
+     * @param y Row Y coordinate.
+     * @param z Row Z coordinate.
+     * @param old_hits Hits of the view that were previously added.
+     * @param new_hits New hits of the view.
+     */
+    void update_row(int y, int z, const uint8_t* old_hits, const uint8_t* new_hits);
+
+    /**
+     * @brief Extract the voxels seen as foreground by at least k views.
+     * @param min_views Number of views k (clamped to 1..view_count()).
+     * @param occupancy Output occupancy, reset to the grid layout.
+     */
+    void threshold(int min_views, OccupancyGrid& occupancy) const;
+
+public: // Getters
+    /** @brief Check whether the counters have been filled. */
+    bool empty() const { return counts_.empty() && wide_counts_.empty(); }
+
+    /** @brief Check whether the counters are 16 bits wide. */
+    bool wide() const { return num_views_ > CONSENSUS_BYTE_VIEWS; }
+
+    /** @brief Get the number of views counted. */
+    int view_count() const { return num_views_; }
+
+    /** @brief Get the grid layout. */
+    const Grid& grid() const { return grid_; }
+
+    /** @brief Get the memory used by the counters in bytes. */
+    size_t memory_bytes() const { return counts_.size() + wide_counts_.size() * sizeof(uint16_t); }
+
+private: // Variables
+    Grid grid_;                         // Grid layout
+    int num_views_ = 0;                 // Number of views counted
+    std::vector<uint8_t> counts_;       // Foreground view count per voxel (up to CONSENSUS_BYTE_VIEWS views)
+    std::vector<uint16_t> wide_counts_; // Foreground view count per voxel (more views)
+};
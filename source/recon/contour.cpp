@@ -0,0 +1,130 @@
+#include "contour.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+// Mask value of foreground pixels
+constexpr const uint8_t MASK_FOREGROUND = std::numeric_limits<uint8_t>::max();
+
+// Image rows per edge bucket
+constexpr const int CONTOUR_BAND_HEIGHT = 8;
+
+
+/* Public methods */
+
+void SilhouettePolygon::build(const cv::Mat& mask, double epsilon) {
+    clear();
+    if (mask.empty()) {
+        return;
+    }
+
+    // Only full foreground counts, as in the carver
+    cv::Mat foreground = mask == MASK_FOREGROUND;
+    std::vector<std::vector<cv::Point>> raw;
+    cv::findContours(foreground, raw, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+
+    for (const auto& contour : raw) {
+        std::vector<cv::Point> polygon;
+        cv::approxPolyDP(contour, polygon, epsilon, true);
+        if (polygon.size() >= 3) {
+            contours_.push_back(std::move(polygon));
+        }
+    }
+
+    // Half-open Y ranges count every crossing once, also at shared vertices
+    for (const auto& polygon : contours_) {
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            const cv::Point& a = polygon[i];
+            const cv::Point& b = polygon[(i + 1) % polygon.size()];
+            if (a.y == b.y) {
+                continue;
+            }
+            const cv::Point& lo = a.y < b.y ? a : b;
+            const cv::Point& hi = a.y < b.y ? b : a;
+            edges_.push_back({
+                static_cast<float>(lo.y), static_cast<float>(hi.y), static_cast<float>(lo.x),
+                static_cast<float>(hi.x - lo.x) / static_cast<float>(hi.y - lo.y)
+            });
+        }
+    }
+
+    // Bucket the edges by the row bands they span
+    band_height_ = CONTOUR_BAND_HEIGHT;
+    const int num_bands = (mask.rows + band_height_ - 1) / band_height_;
+    bucket_offsets_.assign(num_bands + 1, 0);
+
+    auto band_range = [&](const Edge& edge, int& first, int& last) {
+        first = std::clamp(static_cast<int>(edge.y_min) / band_height_, 0, num_bands - 1);
+        last = std::clamp(static_cast<int>(std::ceil(edge.y_max)) / band_height_, 0, num_bands - 1);
+    };
+
+    for (const Edge& edge : edges_) {
+        int first, last;
+        band_range(edge, first, last);
+        for (int b = first; b <= last; ++b) {
+            bucket_offsets_[b + 1]++;
+        }
+    }
+    for (int b = 0; b < num_bands; ++b) {
+        bucket_offsets_[b + 1] += bucket_offsets_[b];
+    }
+
+    bucket_edges_.resize(bucket_offsets_[num_bands]);
+    std::vector<uint32_t> fill(bucket_offsets_.begin(), bucket_offsets_.end() - 1);
+    for (size_t e = 0; e < edges_.size(); ++e) {
+        int first, last;
+        band_range(edges_[e], first, last);
+        for (int b = first; b <= last; ++b) {
+            bucket_edges_[fill[b]++] = static_cast<uint32_t>(e);
+        }
+    }
+}
+
+void SilhouettePolygon::clear() {
+    contours_.clear();
+    edges_.clear();
+    bucket_offsets_.clear();
+    bucket_edges_.clear();
+}
+
+
+/* Getters */
+
+bool SilhouettePolygon::contains(const cv::Point2f& point) const {
+    if (!(point.y >= 0.0f) || !std::isfinite(point.x) || bucket_offsets_.size() < 2) {
+        return false;
+    }
+
+    const int band = static_cast<int>(point.y) / band_height_;
+    if (band >= static_cast<int>(bucket_offsets_.size()) - 1) {
+        return false;
+    }
+
+    // Even-odd rule: count the edges crossing the row to the left of the point
+    bool inside = false;
+    for (uint32_t k = bucket_offsets_[band]; k < bucket_offsets_[band + 1]; ++k) {
+        const Edge& edge = edges_[bucket_edges_[k]];
+        if (point.y >= edge.y_min && point.y < edge.y_max && point.x < edge.x + (point.y - edge.y_min) * edge.slope) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+size_t SilhouettePolygon::vertex_count() const {
+    size_t count = 0;
+    for (const auto& polygon : contours_) {
+        count += polygon.size();
+    }
+    return count;
+}
+
+size_t SilhouettePolygon::memory_bytes() const {
+    size_t bytes = edges_.size() * sizeof(Edge) + (bucket_offsets_.size() + bucket_edges_.size()) * sizeof(uint32_t);
+    for (const auto& polygon : contours_) {
+        bytes += polygon.size() * sizeof(cv::Point);
+    }
+    return bytes;
+}
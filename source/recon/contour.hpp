@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+
+/**
+ * @class SilhouettePolygon
+ * @brief Vectorized silhouette of a view mask, as simplified polygon contours.
+ *
+ * The contours of the foreground (outer boundaries and holes) are traced with cv::findContours and
+ * simplified with cv::approxPolyDP. Inside tests use the even-odd rule over all contours, so holes
+ * need no special handling; the polygon edges are bucketed by image rows so a test only visits the
+ * edges crossing its row band. Vertices lie at pixel centers, the same convention as
+ * PinholeModel::project.
+ */
+class SilhouettePolygon {
+public: // Methods
+    /**
+     * @brief Trace and simplify the foreground contours of a mask.
+     * @param mask Foreground mask (CV_8U, 255 = foreground).
+     * @param epsilon Maximum distance in pixels between a contour and its simplified polygon.
+     */
+    void build(const cv::Mat& mask, double epsilon);
+
+    /** @brief Release the polygons. */
+    void clear();
+
+    /**
+     * @brief Check whether an image point lies inside the silhouette.
+     * @param point Image position in pixels.
+     * @return True if the point is inside an odd number of contours; false for NaN points.
+     */
+    bool contains(const cv::Point2f& point) const;
+
+public: // Getters
+    /** @brief Get the simplified contours. */
+    const std::vector<std::vector<cv::Point>>& contours() const { return contours_; }
+
+    /** @brief Get the total number of polygon vertices. */
+    size_t vertex_count() const;
+
+    /** @brief Get the memory used by the polygons and their row buckets in bytes. */
+    size_t memory_bytes() const;
+
+private: // Types
+    /** @brief Non-horizontal polygon edge, stored for scanline crossing tests. */
+    struct Edge {
+        float y_min;    // Lower end Y (inclusive)
+        float y_max;    // Upper end Y (exclusive)
+        float x;        // X at y_min
+        float slope;    // dX/dY
+    };
+
+private: // Variables
+    std::vector<std::vector<cv::Point>> contours_;  // Simplified contours
+    std::vector<Edge> edges_;                       // Non-horizontal edges of all contours
+    std::vector<uint32_t> bucket_offsets_;          // First bucket entry per row band, plus the end
+    std::vector<uint32_t> bucket_edges_;            // Edge indices per row band
+    int band_height_ = 1;                           // Image rows per band
+};
@@ -0,0 +1,110 @@
+#include "footprint.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+// Mask values above this threshold are foreground
+constexpr const double FOREGROUND_THRESHOLD = 254.0;
+
+// Projected coordinates beyond this magnitude cannot be bounded by an int rectangle
+constexpr const float FOOTPRINT_LIMIT = 1e7f;
+
+
+/* Functions */
+
+Footprint project_footprint(const PinholeModel& model, const glm::vec3& box_min, const glm::vec3& box_max, int margin) {
+    // The projection of a box in front of the camera lies inside the hull of its projected corners
+    std::array<cv::Point2f, 8> corners;
+    for (int corner = 0; corner < 8; ++corner) {
+        corners[corner] = model.project(glm::vec3(
+            (corner & 1) ? box_max.x : box_min.x,
+            (corner & 2) ? box_max.y : box_min.y,
+            (corner & 4) ? box_max.z : box_min.z
+        ));
+    }
+
+    return bound_footprint(corners.data(), static_cast<int>(corners.size()), margin);
+}
+
+Footprint bound_footprint(const cv::Point2f* corners, int count, int margin) {
+    Footprint footprint;
+
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+
+    for (int i = 0; i < count; ++i) {
+        if (std::isnan(corners[i].x) || std::isnan(corners[i].y)) {
+            return footprint;
+        }
+
+        min_x = std::min(min_x, corners[i].x);
+        min_y = std::min(min_y, corners[i].y);
+        max_x = std::max(max_x, corners[i].x);
+        max_y = std::max(max_y, corners[i].y);
+    }
+
+    // Guard against int overflow for corners projecting near infinity
+    if (min_x < -FOOTPRINT_LIMIT || min_y < -FOOTPRINT_LIMIT || max_x > FOOTPRINT_LIMIT || max_y > FOOTPRINT_LIMIT) {
+        return footprint;
+    }
+
+    int x0 = cvRound(min_x) - margin;
+    int y0 = cvRound(min_y) - margin;
+    int x1 = cvRound(max_x) + margin + 1;
+    int y1 = cvRound(max_y) + margin + 1;
+
+    footprint.rect = cv::Rect(x0, y0, x1 - x0, y1 - y0);
+    footprint.bounded = true;
+    return footprint;
+}
+
+
+/* MaskIntegral */
+
+void MaskIntegral::build(const cv::Mat& mask) {
+    size_ = mask.size();
+
+    // Count foreground pixels as ones so the sums stay within 32 bits for any image size
+    cv::Mat ones;
+    cv::threshold(mask, ones, FOREGROUND_THRESHOLD, 1, cv::THRESH_BINARY);
+    cv::integral(ones, sums_, CV_32S);
+}
+
+void MaskIntegral::clear() {
+    sums_.release();
+    size_ = cv::Size();
+}
+
+int MaskIntegral::count(const cv::Rect& rect) const {
+    const int x0 = rect.x;
+    const int y0 = rect.y;
+    const int x1 = rect.x + rect.width;
+    const int y1 = rect.y + rect.height;
+
+    return sums_.at<int>(y1, x1) - sums_.at<int>(y0, x1) - sums_.at<int>(y1, x0) + sums_.at<int>(y0, x0);
+}
+
+Coverage MaskIntegral::classify(const Footprint& footprint) const {
+    if (!footprint.bounded || sums_.empty()) {
+        return Coverage::PARTIAL;
+    }
+
+    cv::Rect inside = footprint.rect & cv::Rect(0, 0, size_.width, size_.height);
+    if (inside.empty()) {
+        return Coverage::EMPTY;
+    }
+
+    int foreground = count(inside);
+    if (foreground == 0) {
+        return Coverage::EMPTY;
+    }
+    if (foreground == inside.area() && inside == footprint.rect) {
+        return Coverage::FULL;
+    }
+    return Coverage::PARTIAL;
+}
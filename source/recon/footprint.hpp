@@ -0,0 +1,105 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "pinhole.hpp"
+
+
+/**
+ * @enum Coverage
+ * @brief Classification of an image region against a silhouette mask.
+ *
+ * - EMPTY: No foreground pixel in the region
+ * - PARTIAL: Mixed or unknown coverage
+ * - FULL: Every pixel of the region is foreground
+ */
+enum class Coverage {
+    EMPTY,
+    PARTIAL,
+    FULL
+};
+
+
+/**
+ * @struct Footprint
+ * @brief Pixel rectangle bounding the projection of an axis-aligned world box.
+ *
+ * Members:
+ * - rect: Pixel rectangle (may extend beyond the image).
+ * - bounded: False when part of the box lies behind the camera and no rectangle can bound it.
+ */
+struct Footprint {
+    cv::Rect rect;          // Bounding pixel rectangle
+    bool bounded = false;   // Whether rect bounds the projection
+};
+
+
+/**
+ * @brief Project the corners of a world box and bound them with a pixel rectangle.
+ * @param model Pinhole model of the view.
+ * @param box_min Minimum world corner (OpenCV coordinates).
+ * @param box_max Maximum world corner (OpenCV coordinates).
+ * @param margin Extra pixels added on every side to absorb rounding and lens distortion.
+ * @return Footprint of the box.
+ */
+Footprint project_footprint(const PinholeModel& model, const glm::vec3& box_min, const glm::vec3& box_max, int margin);
+
+/**
+ * @brief Bound already projected box corners with a pixel rectangle.
+ * @param corners Projected corners; NaN marks a corner behind the camera.
+ * @param count Number of corners.
+ * @param margin Extra pixels added on every side.
+ * @return Footprint of the corners, unbounded if any corner is NaN.
+ */
+Footprint bound_footprint(const cv::Point2f* corners, int count, int margin);
+
+/**
+ * @class MaskIntegral
+ * @brief Summed-area table of the foreground pixels of a silhouette mask.
+ *
+ * Counts the foreground pixels of any axis-aligned rectangle with four lookups, so footprints of
+ * voxels and octree blocks are classified in constant time regardless of their size.
+ */
+class MaskIntegral {
+public: // Methods
+    /**
+     * @brief Build the table from a binary mask.
+     * @param mask Binary mask (255 = foreground).
+     */
+    void build(const cv::Mat& mask);
+
+    /** @brief Release the table. */
+    void clear();
+
+public: // Getters
+    /**
+     * @brief Count the foreground pixels inside a rectangle.
+     * @param rect Pixel rectangle; must lie inside the mask.
+     * @return Number of foreground pixels.
+     */
+    int count(const cv::Rect& rect) const;
+
+    /**
+     * @brief Classify a footprint against the mask.
+     *
+     * Parts of the footprint outside the image count as background, so a clipped footprint is never FULL.
+     *
+     * @param footprint Footprint to classify.
+     * @return Coverage of the footprint.
+     */
+    Coverage classify(const Footprint& footprint) const;
+
+    /** @brief Check whether the table has been built. */
+    bool empty() const { return sums_.empty(); }
+
+    /** @brief Get the size of the mask the table was built from. */
+    cv::Size size() const { return size_; }
+
+    /** @brief Get the memory used by the table in bytes. */
+    size_t memory_bytes() const { return sums_.total() * sums_.elemSize(); }
+
+private: // Variables
+    cv::Size size_;     // Mask size
+    cv::Mat sums_;      // (rows + 1) x (cols + 1) foreground counts, CV_32S
+};
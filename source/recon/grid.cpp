@@ -0,0 +1,51 @@
+#include "grid.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+
+// Voxel size of the production preset in mm; the preview preset uses VOLUME_VOXEL_SIZE
+constexpr const float PRODUCTION_VOXEL_SIZE = 8.0f;
+
+// Tolerance for box sizes that are a whole multiple of the voxel size
+constexpr const float EXTENT_TOLERANCE = 1e-3f;
+
+
+/* Static functions */
+
+Grid Grid::from_extent(const glm::vec3& min_corner, const glm::vec3& max_corner, float voxel_size) {
+    auto count = [voxel_size](float length) {
+        return std::max(1, static_cast<int>(std::ceil(length / voxel_size - EXTENT_TOLERANCE)));
+    };
+
+    Grid grid;
+    grid.voxel_size = voxel_size;
+    grid.origin = min_corner;
+    grid.num_x = count(max_corner.x - min_corner.x);
+    grid.num_y = count(max_corner.y - min_corner.y);
+    grid.num_z = count(max_corner.z - min_corner.z);
+    return grid;
+}
+
+Grid Grid::preview() {
+    return Grid();
+}
+
+Grid Grid::production() {
+    return Grid().resampled(PRODUCTION_VOXEL_SIZE);
+}
+
+
+/* Functions */
+
+bool parse_grid_preset(const std::string& name, Grid& grid) {
+    if (name == "preview") {
+        grid = Grid::preview();
+        return true;
+    }
+    if (name == "production") {
+        grid = Grid::production();
+        return true;
+    }
+    return false;
+}
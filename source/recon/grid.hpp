@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "global.hpp"
+
+
+/**
+ * @struct Grid
+ * @brief Describes the regular voxel lattice sampled by the reconstruction.
+ *
+ * Voxel (x, y, z) is sampled at origin + (x, y, z) * voxel_size in OpenCV world coordinates
+ * (Z up, millimeters). Voxels are laid out X-fastest, matching the layout of Volume.
+ * The default grid is the preview preset.
+ *
+ * Members:
+ * - num_x, num_y, num_z: Number of voxels along each axis.
+ * - voxel_size: Edge length of a voxel.
+ * - origin: World position of voxel (0, 0, 0).
+ */
+struct Grid {
+    /**
+     * @brief Create a grid covering a world box.
+     * @param min_corner Minimum world corner; becomes the origin.
+     * @param max_corner Maximum world corner.
+     * @param voxel_size Voxel edge length in mm.
+     * @return Grid with enough voxels along each axis to cover the box.
+     */
+    static Grid from_extent(const glm::vec3& min_corner, const glm::vec3& max_corner, float voxel_size);
+
+    /** @brief Get the coarse preset for interactive previews. */
+    static Grid preview();
+
+    /** @brief Get the fine preset for batch reconstructions. */
+    static Grid production();
+
+    int num_x = (VOLUME_BOX_LENGTH * 2) / VOLUME_VOXEL_SIZE;               // Voxels along OpenCV X
+    int num_y = (VOLUME_BOX_LENGTH * 2) / VOLUME_VOXEL_SIZE;               // Voxels along OpenCV Y
+    int num_z = VOLUME_BOX_LENGTH / VOLUME_VOXEL_SIZE;                     // Voxels along OpenCV Z (up)
+    float voxel_size = static_cast<float>(VOLUME_VOXEL_SIZE);              // Voxel edge length in mm
+    glm::vec3 origin = glm::vec3(-VOLUME_BOX_LENGTH, -VOLUME_BOX_LENGTH, 0.0f); // Position of voxel (0, 0, 0)
+
+    /** @brief Get the total number of voxels in the grid. */
+    size_t voxel_count() const { return static_cast<size_t>(num_x) * num_y * num_z; }
+
+    /** @brief Get the number of X rows (one per (y, z) pair) in the grid. */
+    size_t row_count() const { return static_cast<size_t>(num_y) * num_z; }
+
+    /** @brief Get the linear index of voxel (x, y, z). */
+    size_t index(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * num_y + y) * num_x + x;
+    }
+
+    /** @brief Get the coordinates (x, y, z) of the voxel with a linear index; the inverse of index(). */
+    glm::ivec3 coordinates(size_t index) const {
+        const size_t row = index / num_x;
+        return glm::ivec3(static_cast<int>(index % num_x), static_cast<int>(row % num_y), static_cast<int>(row / num_y));
+    }
+
+    /** @brief Get the world position (OpenCV coordinates) of voxel (x, y, z). */
+    glm::vec3 position(int x, int y, int z) const {
+        return origin + glm::vec3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * voxel_size;
+    }
+
+    /** @brief Get the world position (OpenCV coordinates) of a voxel. */
+    glm::vec3 position(const glm::ivec3& voxel) const { return position(voxel.x, voxel.y, voxel.z); }
+
+    /** @brief Get the size of the grid in world units. */
+    glm::vec3 extent() const {
+        return glm::vec3(static_cast<float>(num_x), static_cast<float>(num_y), static_cast<float>(num_z)) * voxel_size;
+    }
+
+    /**
+     * @brief Get a grid covering the same extent with a different voxel size.
+     * @param size New voxel edge length in mm.
+     * @return Resampled grid.
+     */
+    Grid resampled(float size) const { return from_extent(origin, origin + extent(), size); }
+
+    /**
+     * @brief Get the part of the grid between two voxel corners; its samples coincide with those of this grid.
+     * @param begin First voxel of the region.
+     * @param end One past the last voxel of the region.
+     * @return Grid covering the region.
+     */
+    Grid subgrid(const glm::ivec3& begin, const glm::ivec3& end) const {
+        Grid grid = *this;
+        grid.num_x = end.x - begin.x;
+        grid.num_y = end.y - begin.y;
+        grid.num_z = end.z - begin.z;
+        grid.origin = position(begin.x, begin.y, begin.z);
+        return grid;
+    }
+
+    /** @brief Check whether the grid has a positive voxel size and at least one voxel. */
+    bool is_valid() const { return voxel_size > 0.0f && num_x > 0 && num_y > 0 && num_z > 0; }
+
+    /** @brief Compare two grids for identical lattice layout. */
+    bool operator==(const Grid& other) const {
+        return num_x == other.num_x && num_y == other.num_y && num_z == other.num_z
+            && voxel_size == other.voxel_size && origin == other.origin;
+    }
+};
+
+
+/**
+ * @brief Get a grid preset by name ("preview", "production").
+ * @param name Preset name.
+ * @param grid Output grid.
+ * @return True if the name is known.
+ */
+bool parse_grid_preset(const std::string& name, Grid& grid);
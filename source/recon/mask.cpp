@@ -0,0 +1,427 @@
+#include "mask.hpp"
+
+#include <limits>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "simd.hpp"
+
+
+// Fixed-point precision and hue range of OpenCV's 8-bit HSV conversion
+constexpr const int HSV_SHIFT = 12;
+constexpr const int HSV_HUE_RANGE = 180;
+
+// Mask rows per tile of the fused kernel
+constexpr const int MASK_TILE_ROWS = 64;
+
+// Reach of the morphology in rows: erosion, two 5x5 cross dilations, erosion
+constexpr const int MASK_ERODE_RADIUS = 1;
+constexpr const int MASK_DILATE_RADIUS = 4;
+constexpr const int MASK_HALO = 2 * MASK_ERODE_RADIUS + MASK_DILATE_RADIUS;
+
+// Mask value of foreground pixels
+constexpr const uint8_t MASK_FOREGROUND = std::numeric_limits<uint8_t>::max();
+
+
+/* Types */
+
+/** @brief Reciprocal tables of OpenCV's 8-bit HSV conversion, rounded the same way. */
+struct HsvTables {
+    int saturation[256] = {};   // (255 << HSV_SHIFT) / v
+    int hue[256] = {};          // (180 << HSV_SHIFT) / (6 * (max - min))
+
+    HsvTables() {
+        for (int i = 1; i < 256; ++i) {
+            saturation[i] = cv::saturate_cast<int>((255 << HSV_SHIFT) / (1.0 * i));
+            hue[i] = cv::saturate_cast<int>((HSV_HUE_RANGE << HSV_SHIFT) / (6.0 * i));
+        }
+    }
+};
+
+/** @brief Consecutive bit-packed mask rows of one stage of a tile, 64 pixels per word. */
+struct MaskRows {
+    int first = 0;                  // First image row
+    int last = 0;                   // One past the last image row
+    int words_per_row = 0;          // Words per row
+    std::vector<uint64_t> words;    // Row bits; bits past the image width are zero
+
+    /** @brief Hold the image rows [first_row, last_row). */
+    void assign(int first_row, int last_row, int row_words) {
+        first = first_row;
+        last = last_row;
+        words_per_row = row_words;
+        words.resize(static_cast<size_t>(std::max(last - first, 0)) * words_per_row);
+    }
+
+    /** @brief Get image row y. */
+    uint64_t* row(int y) { return words.data() + static_cast<size_t>(y - first) * words_per_row; }
+
+    /** @brief Get image row y. */
+    const uint64_t* row(int y) const { return words.data() + static_cast<size_t>(y - first) * words_per_row; }
+};
+
+
+/* Functions */
+
+static const HsvTables& hsv_tables() {
+    static const HsvTables tables;
+    return tables;
+}
+
+// Convert a pixel to 8-bit HSV exactly as cv::cvtColor(COLOR_BGR2HSV)
+static inline void to_hsv(int b, int g, int r, const HsvTables& tables, int& h, int& s, int& v) {
+    v = std::max({ b, g, r });
+    const int diff = v - std::min({ b, g, r });
+    const int vr = v == r ? -1 : 0;
+    const int vg = v == g ? -1 : 0;
+
+    s = (diff * tables.saturation[v] + (1 << (HSV_SHIFT - 1))) >> HSV_SHIFT;
+    h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + (~vg & (r - g + 4 * diff))));
+    h = (h * tables.hue[diff] + (1 << (HSV_SHIFT - 1))) >> HSV_SHIFT;
+    h += h < 0 ? HSV_HUE_RANGE : 0;
+}
+
+#if defined(SIMD_AVX2)
+// Convert 8 pixels to 8-bit HSV, one per 32-bit lane
+SIMD_TARGET_AVX2 static inline void to_hsv8(__m256i b, __m256i g, __m256i r, const HsvTables& tables, __m256i& h, __m256i& s, __m256i& v) {
+    const __m256i round = _mm256_set1_epi32(1 << (HSV_SHIFT - 1));
+
+    v = _mm256_max_epi32(b, _mm256_max_epi32(g, r));
+    const __m256i diff = _mm256_sub_epi32(v, _mm256_min_epi32(b, _mm256_min_epi32(g, r)));
+    const __m256i vr = _mm256_cmpeq_epi32(v, r);
+    const __m256i vg = _mm256_cmpeq_epi32(v, g);
+
+    const __m256i sdiv = _mm256_i32gather_epi32(tables.saturation, v, 4);
+    s = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(diff, sdiv), round), HSV_SHIFT);
+
+    const __m256i h_r = _mm256_sub_epi32(g, b);
+    const __m256i h_g = _mm256_add_epi32(_mm256_sub_epi32(b, r), _mm256_slli_epi32(diff, 1));
+    const __m256i h_b = _mm256_add_epi32(_mm256_sub_epi32(r, g), _mm256_slli_epi32(diff, 2));
+    h = _mm256_add_epi32(_mm256_and_si256(vg, h_g), _mm256_andnot_si256(vg, h_b));
+    h = _mm256_add_epi32(_mm256_and_si256(vr, h_r), _mm256_andnot_si256(vr, h));
+
+    const __m256i hdiv = _mm256_i32gather_epi32(tables.hue, diff, 4);
+    h = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(h, hdiv), round), HSV_SHIFT);
+    h = _mm256_add_epi32(h, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), h), _mm256_set1_epi32(HSV_HUE_RANGE)));
+}
+
+// Load the blue, green and red bytes of 8 pixels into 32-bit lanes
+SIMD_TARGET_AVX2 static inline void load_bgr8(const uint8_t* pixels, __m256i offsets, __m256i& b, __m256i& g, __m256i& r) {
+    const __m256i bytes = _mm256_set1_epi32(0xFF);
+    const __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(pixels), offsets, 1);
+    b = _mm256_and_si256(words, bytes);
+    g = _mm256_and_si256(_mm256_srli_epi32(words, 8), bytes);
+    r = _mm256_and_si256(_mm256_srli_epi32(words, 16), bytes);
+}
+
+// Classify the leading pixels of a row 8 at a time; returns the pixels done
+SIMD_TARGET_AVX2 static int classify_row_avx2(const uint8_t* fg, int fg_channels, const uint8_t* bg, int bg_channels, int width,
+                                              const HsvTables& tables, uint8_t* mask) {
+    // Gathers read 4 bytes per pixel, so the last pixel of a 3-channel row is left to the scalar loop
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i fg_offsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(fg_channels));
+    const __m256i bg_offsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(bg_channels));
+    const __m256i threshold_h = _mm256_set1_epi32(MASK_THRESHOLD_H);
+    const __m256i threshold_s = _mm256_set1_epi32(MASK_THRESHOLD_S);
+    const __m256i threshold_v = _mm256_set1_epi32(MASK_THRESHOLD_V);
+
+    int x = 0;
+    for (; x + 8 < width; x += 8) {
+        __m256i b, g, r;
+        __m256i fg_h, fg_s, fg_v, bg_h, bg_s, bg_v;
+        load_bgr8(fg + x * fg_channels, fg_offsets, b, g, r);
+        to_hsv8(b, g, r, tables, fg_h, fg_s, fg_v);
+        load_bgr8(bg + x * bg_channels, bg_offsets, b, g, r);
+        to_hsv8(b, g, r, tables, bg_h, bg_s, bg_v);
+
+        const __m256i over_h = _mm256_cmpgt_epi32(_mm256_abs_epi32(_mm256_sub_epi32(fg_h, bg_h)), threshold_h);
+        const __m256i over_s = _mm256_cmpgt_epi32(_mm256_abs_epi32(_mm256_sub_epi32(fg_s, bg_s)), threshold_s);
+        const __m256i over_v = _mm256_cmpgt_epi32(_mm256_abs_epi32(_mm256_sub_epi32(fg_v, bg_v)), threshold_v);
+        const __m256i over = _mm256_or_si256(_mm256_and_si256(over_h, over_s), over_v);
+
+        // Narrow the 0/-1 lanes to 0/255 bytes; each 128-bit half holds four of them
+        const __m256i narrow = _mm256_packs_epi16(_mm256_packs_epi32(over, over), _mm256_setzero_si256());
+        const uint32_t low = static_cast<uint32_t>(_mm256_extract_epi32(narrow, 0));
+        const uint32_t high = static_cast<uint32_t>(_mm256_extract_epi32(narrow, 4));
+        std::memcpy(mask + x, &low, sizeof(low));
+        std::memcpy(mask + x + 4, &high, sizeof(high));
+    }
+    return x;
+}
+
+// Pack the leading multiple of 32 mask bytes of a row into bits; returns the pixels done
+SIMD_TARGET_AVX2 static int pack_row_avx2(const uint8_t* bytes, int width, uint64_t* bits) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + x));
+        bits[x >> 6] |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(values))) << (x & 63);
+    }
+    return x;
+}
+
+// Expand the leading multiple of 32 bits of a row into bytes; returns the pixels done
+SIMD_TARGET_AVX2 static int unpack_row_avx2(const uint64_t* bits, int width, uint8_t* bytes) {
+    // Broadcast 32 bits, route byte i / 8 to byte i and test bit i % 8
+    const __m256i route = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                           2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i select = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ull));
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const uint32_t word = static_cast<uint32_t>(bits[x >> 6] >> (x & 63));
+        const __m256i spread = _mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(word)), route), select);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + x), _mm256_cmpeq_epi8(spread, select));
+    }
+    return x;
+}
+#endif
+
+// Classify a row of pixels: (H and S) or V differences above their thresholds
+static void classify_row(const uint8_t* fg, int fg_channels, const uint8_t* bg, int bg_channels, int width, uint8_t* mask) {
+    const HsvTables& tables = hsv_tables();
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = classify_row_avx2(fg, fg_channels, bg, bg_channels, width, tables, mask);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        const uint8_t* f = fg + x * fg_channels;
+        const uint8_t* k = bg + x * bg_channels;
+
+        int fg_h, fg_s, fg_v, bg_h, bg_s, bg_v;
+        to_hsv(f[0], f[1], f[2], tables, fg_h, fg_s, fg_v);
+        to_hsv(k[0], k[1], k[2], tables, bg_h, bg_s, bg_v);
+
+        const bool over = (std::abs(fg_h - bg_h) > MASK_THRESHOLD_H && std::abs(fg_s - bg_s) > MASK_THRESHOLD_S)
+            || std::abs(fg_v - bg_v) > MASK_THRESHOLD_V;
+        mask[x] = over ? MASK_FOREGROUND : 0;
+    }
+}
+
+// Pack a row of 0/255 mask bytes into bits
+static void pack_row(const uint8_t* bytes, int width, uint64_t* bits) {
+    const int num_words = (width + 63) / 64;
+    std::memset(bits, 0, num_words * sizeof(uint64_t));
+
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = pack_row_avx2(bytes, width, bits);
+    }
+#endif
+    for (; x < width; ++x) {
+        bits[x >> 6] |= static_cast<uint64_t>(bytes[x] != 0) << (x & 63);
+    }
+}
+
+// Expand a row of mask bits into 0/255 bytes
+static void unpack_row(const uint64_t* bits, int width, uint8_t* bytes) {
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = unpack_row_avx2(bits, width, bytes);
+    }
+#endif
+    for (; x < width; ++x) {
+        bytes[x] = (bits[x >> 6] >> (x & 63)) & 1 ? MASK_FOREGROUND : 0;
+    }
+}
+
+// Or the rows y - R to y + R, clipped to the image; inverted rows give the complement within the image width
+template <int R, bool INVERT>
+static void or_rows(const MaskRows& src, int y, int height, uint64_t last_mask, uint64_t* dst) {
+    const int num_words = src.words_per_row;
+    std::memset(dst, 0, num_words * sizeof(uint64_t));
+
+    for (int row = std::max(y - R, 0); row <= std::min(y + R, height - 1); ++row) {
+        const uint64_t* bits = src.row(row);
+        for (int w = 0; w < num_words; ++w) {
+            dst[w] |= INVERT ? ~bits[w] : bits[w];
+        }
+    }
+    dst[num_words - 1] &= last_mask;
+}
+
+// Or every pixel of a row with its neighbors up to R pixels left and right, clipped to the image width
+template <int R>
+static void or_columns(const uint64_t* src, int num_words, uint64_t last_mask, uint64_t* dst) {
+    for (int w = 0; w < num_words; ++w) {
+        const uint64_t prev = w > 0 ? src[w - 1] : 0;
+        const uint64_t next = w + 1 < num_words ? src[w + 1] : 0;
+
+        uint64_t bits = src[w];
+        for (int k = 1; k <= R; ++k) {
+            bits |= (src[w] << k) | (prev >> (64 - k));
+            bits |= (src[w] >> k) | (next << (64 - k));
+        }
+        dst[w] = bits;
+    }
+    dst[num_words - 1] &= last_mask;
+}
+
+// Erode a row with the 3x3 square: the complement of the dilated complement. Pixels outside the image
+// never contribute, as with the constant border of cv::erode.
+static void erode_row(const MaskRows& src, int y, int height, uint64_t last_mask, uint64_t* column, uint64_t* dst) {
+    or_rows<MASK_ERODE_RADIUS, true>(src, y, height, last_mask, column);
+    or_columns<MASK_ERODE_RADIUS>(column, src.words_per_row, last_mask, dst);
+
+    for (int w = 0; w < src.words_per_row; ++w) {
+        dst[w] = ~dst[w];
+    }
+    dst[src.words_per_row - 1] &= last_mask;
+}
+
+// Dilate a row twice with the 5x5 cross: the union of a 9-pixel horizontal arm, a 9-pixel vertical arm
+// and a 5x5 square. Pixels outside the image never contribute, as with the constant border of cv::dilate.
+static void dilate_row(const MaskRows& src, int y, int height, uint64_t last_mask, uint64_t* column, uint64_t* square, uint64_t* dst) {
+    const int num_words = src.words_per_row;
+
+    or_columns<MASK_DILATE_RADIUS>(src.row(y), num_words, last_mask, dst);
+
+    or_rows<MASK_DILATE_RADIUS, false>(src, y, height, last_mask, column);
+    for (int w = 0; w < num_words; ++w) {
+        dst[w] |= column[w];
+    }
+
+    or_rows<MASK_DILATE_RADIUS / 2, false>(src, y, height, last_mask, column);
+    or_columns<MASK_DILATE_RADIUS / 2>(column, num_words, last_mask, square);
+    for (int w = 0; w < num_words; ++w) {
+        dst[w] |= square[w];
+    }
+}
+
+cv::Mat segment_mask(const cv::Size& size, const cv::Rect& roi, const std::function<void(int, int, int, uint8_t*)>& classify) {
+    cv::Mat mask = cv::Mat::zeros(size, CV_8UC1);
+    const cv::Rect image(0, 0, size.width, size.height);
+    const cv::Rect inner = roi & image;
+    if (inner.empty()) {
+        return mask;
+    }
+
+    // The region read by the morphology of the ROI pixels; beyond it the image border rules apply,
+    // which leaves the ROI identical to a full-image segmentation
+    const cv::Rect region = cv::Rect(inner.x - MASK_HALO, inner.y - MASK_HALO, inner.width + 2 * MASK_HALO, inner.height + 2 * MASK_HALO) & image;
+    const int width = region.width;
+    const int height = region.height;
+    const int num_words = (width + 63) / 64;
+    const uint64_t last_mask = width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+
+    // Columns of the ROI within the region, so the halo columns stay background
+    std::vector<uint64_t> roi_columns(num_words, 0);
+    for (int x = inner.x - region.x; x < inner.x - region.x + inner.width; ++x) {
+        roi_columns[x >> 6] |= uint64_t(1) << (x & 63);
+    }
+
+    // Tiles cover the ROI rows, in region coordinates
+    const int rows_begin = inner.y - region.y;
+    const int rows_end = rows_begin + inner.height;
+    const int num_tiles = (inner.height + MASK_TILE_ROWS - 1) / MASK_TILE_ROWS;
+
+    // Every tile classifies and cleans its rows plus the halo the morphology reads, so tiles are independent.
+    // The morphology runs on bit rows, 64 pixels per operation.
+#pragma omp parallel
+    {
+        MaskRows raw;
+        MaskRows eroded;
+        MaskRows dilated;
+        std::vector<uint8_t> bytes(width);
+        std::vector<uint64_t> column(num_words);
+        std::vector<uint64_t> square(num_words);
+        std::vector<uint64_t> result(num_words);
+
+#pragma omp for schedule(dynamic)
+        for (int t = 0; t < num_tiles; ++t) {
+            const int begin = rows_begin + t * MASK_TILE_ROWS;
+            const int end = std::min(begin + MASK_TILE_ROWS, rows_end);
+
+            raw.assign(std::max(begin - MASK_HALO, 0), std::min(end + MASK_HALO, height), num_words);
+            for (int y = raw.first; y < raw.last; ++y) {
+                classify(region.y + y, region.x, width, bytes.data());
+                pack_row(bytes.data(), width, raw.row(y));
+            }
+
+            eroded.assign(std::max(begin - MASK_HALO + MASK_ERODE_RADIUS, 0), std::min(end + MASK_HALO - MASK_ERODE_RADIUS, height), num_words);
+            for (int y = eroded.first; y < eroded.last; ++y) {
+                erode_row(raw, y, height, last_mask, column.data(), eroded.row(y));
+            }
+
+            dilated.assign(std::max(begin - MASK_ERODE_RADIUS, 0), std::min(end + MASK_ERODE_RADIUS, height), num_words);
+            for (int y = dilated.first; y < dilated.last; ++y) {
+                dilate_row(eroded, y, height, last_mask, column.data(), square.data(), dilated.row(y));
+            }
+
+            for (int y = begin; y < end; ++y) {
+                erode_row(dilated, y, height, last_mask, column.data(), result.data());
+                for (int w = 0; w < num_words; ++w) {
+                    result[w] &= roi_columns[w];
+                }
+                unpack_row(result.data(), width, mask.ptr<uint8_t>(region.y + y) + region.x);
+            }
+        }
+    }
+
+    return mask;
+}
+
+cv::Mat compute_mask(const cv::Mat& fg_img, const cv::Mat& bg_img) {
+    return compute_mask(fg_img, bg_img, cv::Rect(0, 0, fg_img.cols, fg_img.rows));
+}
+
+cv::Mat compute_mask(const cv::Mat& fg_img, const cv::Mat& bg_img, const cv::Rect& roi) {
+    const int fg_channels = fg_img.channels();
+    const int bg_channels = bg_img.channels();
+    if (fg_img.depth() != CV_8U || bg_img.depth() != CV_8U || fg_img.size() != bg_img.size() || fg_img.empty()
+    ||  (fg_channels != 3 && fg_channels != 4) || (bg_channels != 3 && bg_channels != 4)) {
+        // Segment everything and clear the pixels outside the ROI
+        cv::Mat mask = compute_mask_reference(fg_img, bg_img);
+        cv::Mat inside = cv::Mat::zeros(mask.size(), CV_8UC1);
+        mask(roi & cv::Rect(0, 0, mask.cols, mask.rows)).copyTo(inside(roi & cv::Rect(0, 0, mask.cols, mask.rows)));
+        return inside;
+    }
+
+    return segment_mask(fg_img.size(), roi, [&](int y, int x, int width, uint8_t* row) {
+        classify_row(fg_img.ptr<uint8_t>(y) + x * fg_channels, fg_channels, bg_img.ptr<uint8_t>(y) + x * bg_channels, bg_channels, width, row);
+    });
+}
+
+cv::Mat compute_mask_reference(const cv::Mat& fg_img, const cv::Mat& bg_img) {
+    cv::Mat mask;
+    cv::Mat fg_hsv, bg_hsv;
+    cv::Mat diff_h, diff_s, diff_v;
+    cv::Mat mask_h, mask_s, mask_v;
+    std::vector<cv::Mat> fg_channels, bg_channels;
+
+    // Convert images to HSV
+    cv::cvtColor(fg_img, fg_hsv, cv::COLOR_BGR2HSV);
+    cv::cvtColor(bg_img, bg_hsv, cv::COLOR_BGR2HSV);
+
+    // Split HSV channels
+    cv::split(fg_hsv, fg_channels);
+    cv::split(bg_hsv, bg_channels);
+
+    // Compute absolute differences for each channel
+    cv::absdiff(fg_channels[0], bg_channels[0], diff_h);
+    cv::absdiff(fg_channels[1], bg_channels[1], diff_s);
+    cv::absdiff(fg_channels[2], bg_channels[2], diff_v);
+
+    // Threshold each channel
+    double maxval = static_cast<double>(std::numeric_limits<uint8_t>::max());
+    cv::threshold(diff_h, mask_h, MASK_THRESHOLD_H, maxval, cv::THRESH_BINARY);
+    cv::threshold(diff_s, mask_s, MASK_THRESHOLD_S, maxval, cv::THRESH_BINARY);
+    cv::threshold(diff_v, mask_v, MASK_THRESHOLD_V, maxval, cv::THRESH_BINARY);
+
+    // Combine masks: (H AND S) OR V
+    cv::bitwise_and(mask_h, mask_s, mask);
+    cv::bitwise_or(mask, mask_v, mask);
+
+    // Morphological operations to clean up the mask
+    cv::erode(mask, mask, cv::Mat());
+    cv::dilate(mask, mask, cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(5, 5)), cv::Point(-1, -1), 2);
+    cv::erode(mask, mask, cv::Mat());
+
+    return mask;
+}
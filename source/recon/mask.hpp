@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include <opencv2/opencv.hpp>
+
+
+// Minimum HSV channel differences between foreground and background of a foreground pixel
+constexpr const int MASK_THRESHOLD_H = 20;
+constexpr const int MASK_THRESHOLD_S = 20;
+constexpr const int MASK_THRESHOLD_V = 40;
+
+
+/**
+ * @brief Segment the foreground of an image against a background image.
+ *
+ * A pixel is foreground when its HSV difference to the background exceeds the hue and saturation
+ * thresholds, or the value threshold. The mask is then cleaned with an erosion (3x3), two dilations
+ * (5x5 cross) and another erosion (3x3).
+ *
+ * BGR or BGRA 8-bit images go through a fused kernel: every tile of rows is converted, compared and
+ * cleaned in cache-sized bit-packed buffers, so the images are read once and only the mask is written.
+ * The result is bit-identical to compute_mask_reference(). Other formats fall back to the reference.
+ *
+ * @param fg_img Foreground image.
+ * @param bg_img Background image of the same size and type.
+ * @return 8-bit mask, 255 for foreground and 0 for background.
+ */
+cv::Mat compute_mask(const cv::Mat& fg_img, const cv::Mat& bg_img);
+
+/**
+ * @brief Segment the foreground of an image region against a background image.
+ *
+ * Only the ROI and the few pixels around it that its morphology reads are processed; the rest of the
+ * mask is background. Inside the ROI the mask is identical to compute_mask().
+ *
+ * @param fg_img Foreground image.
+ * @param bg_img Background image of the same size and type.
+ * @param roi Region to segment; clipped to the image.
+ * @return 8-bit mask of the image size, 255 for foreground and 0 for background.
+ */
+cv::Mat compute_mask(const cv::Mat& fg_img, const cv::Mat& bg_img, const cv::Rect& roi);
+
+/**
+ * @brief Classify an image region row by row and clean the result with the morphology of compute_mask().
+ *
+ * Runs the tiled kernel of compute_mask() with a custom per-pixel classification: the rows of each
+ * tile and its halo are classified, packed into bits and cleaned while still in cache. The region
+ * classified is the ROI grown by the reach of the morphology, clipped to the image.
+ *
+ * @param size Image size.
+ * @param roi Region to segment; pixels outside it are background.
+ * @param classify Writes the raw classification (255 foreground, 0 background) of the width pixels from
+ *                 column x of image row y into a buffer; called concurrently from several threads.
+ * @return 8-bit mask of the image size, 255 for foreground and 0 for background.
+ */
+cv::Mat segment_mask(const cv::Size& size, const cv::Rect& roi, const std::function<void(int, int, int, uint8_t*)>& classify);
+
+/**
+ * @brief Segment the foreground of an image with separate OpenCV passes.
+ *
+ * Reference for compute_mask(): full-resolution HSV conversion, channel split, differences,
+ * thresholds and morphology.
+ *
+ * @param fg_img Foreground image.
+ * @param bg_img Background image of the same size and type.
+ * @return 8-bit mask, 255 for foreground and 0 for background.
+ */
+cv::Mat compute_mask_reference(const cv::Mat& fg_img, const cv::Mat& bg_img);
@@ -0,0 +1,220 @@
+#include "occupancy.hpp"
+
+#include <limits>
+#include <algorithm>
+
+#include <omp.h>
+
+#include "model/volume.hpp"
+
+
+/* Constructors */
+
+OccupancyGrid::OccupancyGrid(const Grid& grid) {
+    reset(grid);
+}
+
+
+/* Static functions */
+
+OccupancyGrid OccupancyGrid::from_volume(const Volume& volume, const Grid& grid) {
+    OccupancyGrid occupancy(grid);
+
+    const int num_rows = static_cast<int>(grid.row_count());
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const int y = r % grid.num_y;
+        const int z = r / grid.num_y;
+        const Voxel* voxels = volume.row_data(y, z);
+        uint64_t* words = occupancy.row(y, z);
+
+        for (int x = 0; x < grid.num_x; ++x) {
+            words[x >> 6] |= uint64_t(voxels[x].active) << (x & 63);
+        }
+    }
+
+    return occupancy;
+}
+
+
+/* Public methods */
+
+void OccupancyGrid::reset(const Grid& grid) {
+    grid_ = grid;
+    words_per_row_ = (grid.num_x + 63) / 64;
+    words_.assign(grid.row_count() * words_per_row_, 0);
+}
+
+void OccupancyGrid::clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+}
+
+void OccupancyGrid::fill() {
+    const int num_rows = static_cast<int>(grid_.row_count());
+
+    // Keep the padding bits past num_x zero so counts stay exact
+    for (int r = 0; r < num_rows; ++r) {
+        set_run(0, grid_.num_x, r % grid_.num_y, r / grid_.num_y);
+    }
+}
+
+void OccupancyGrid::set_run(int x_begin, int x_end, int y, int z) {
+    if (x_begin >= x_end) {
+        return;
+    }
+
+    uint64_t* words = row(y, z);
+    const int first = x_begin >> 6;
+    const int last = (x_end - 1) >> 6;
+
+    const uint64_t head = std::numeric_limits<uint64_t>::max() << (x_begin & 63);
+    const uint64_t tail = std::numeric_limits<uint64_t>::max() >> (63 - ((x_end - 1) & 63));
+
+    if (first == last) {
+        words[first] |= head & tail;
+        return;
+    }
+
+    words[first] |= head;
+    for (int w = first + 1; w < last; ++w) {
+        words[w] = std::numeric_limits<uint64_t>::max();
+    }
+    words[last] |= tail;
+}
+
+void OccupancyGrid::dilate(int radius) {
+    morph(radius, true);
+}
+
+void OccupancyGrid::erode(int radius) {
+    morph(radius, false);
+}
+
+void OccupancyGrid::to_volume(Volume& volume, const glm::vec4& color) const {
+    volume.assign_active(active_indices(), color);
+}
+
+
+/* Private methods */
+
+void OccupancyGrid::morph(int radius, bool grow) {
+    if (radius <= 0 || words_.empty()) {
+        return;
+    }
+
+    const int num_rows = static_cast<int>(grid_.row_count());
+    const int last = words_per_row_ - 1;
+    const uint64_t tail = (grid_.num_x & 63) ? (uint64_t(1) << (grid_.num_x & 63)) - 1 : std::numeric_limits<uint64_t>::max();
+
+    // X: one voxel per step, carrying bits across word boundaries; the zero padding acts as empty space
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        uint64_t* words = words_.data() + static_cast<size_t>(r) * words_per_row_;
+
+        for (int step = 0; step < radius; ++step) {
+            uint64_t prev = 0;
+            for (int w = 0; w <= last; ++w) {
+                const uint64_t cur = words[w];
+                const uint64_t next = w < last ? words[w + 1] : 0;
+                const uint64_t lower = (cur << 1) | (prev >> 63);
+                const uint64_t upper = (cur >> 1) | (next << 63);
+                words[w] = grow ? (cur | lower | upper) : (cur & lower & upper);
+                prev = cur;
+            }
+            words[last] &= tail;
+        }
+    }
+
+    // Y and Z: combine whole rows within the radius; rows beyond the grid are empty
+    const std::vector<uint64_t> source_y = words_;
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const int y = r % grid_.num_y;
+        const int z = r / grid_.num_y;
+        uint64_t* words = row(y, z);
+        const bool clipped = y - radius < 0 || y + radius >= grid_.num_y;
+
+        for (int w = 0; w <= last; ++w) {
+            uint64_t bits = grow ? 0 : (clipped ? 0 : std::numeric_limits<uint64_t>::max());
+            for (int n = std::max(y - radius, 0); n <= std::min(y + radius, grid_.num_y - 1); ++n) {
+                const uint64_t other = source_y[row_offset(n, z) + w];
+                bits = grow ? (bits | other) : (bits & other);
+            }
+            words[w] = bits;
+        }
+    }
+
+    const std::vector<uint64_t> source_z = words_;
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const int y = r % grid_.num_y;
+        const int z = r / grid_.num_y;
+        uint64_t* words = row(y, z);
+        const bool clipped = z - radius < 0 || z + radius >= grid_.num_z;
+
+        for (int w = 0; w <= last; ++w) {
+            uint64_t bits = grow ? 0 : (clipped ? 0 : std::numeric_limits<uint64_t>::max());
+            for (int n = std::max(z - radius, 0); n <= std::min(z + radius, grid_.num_z - 1); ++n) {
+                const uint64_t other = source_z[row_offset(y, n) + w];
+                bits = grow ? (bits | other) : (bits & other);
+            }
+            words[w] = bits;
+        }
+    }
+}
+
+
+/* Getters */
+
+size_t OccupancyGrid::count() const {
+    const int num_words = static_cast<int>(words_.size());
+    long long total = 0;
+
+#pragma omp parallel for reduction(+:total) schedule(static)
+    for (int w = 0; w < num_words; ++w) {
+        total += std::popcount(words_[w]);
+    }
+
+    return static_cast<size_t>(total);
+}
+
+std::vector<uint32_t> OccupancyGrid::active_indices() const {
+    const int num_rows = static_cast<int>(grid_.row_count());
+    std::vector<size_t> offsets(num_rows + 1, 0);
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const uint64_t* words = words_.data() + static_cast<size_t>(r) * words_per_row_;
+        size_t count = 0;
+        for (int w = 0; w < words_per_row_; ++w) {
+            count += std::popcount(words[w]);
+        }
+        offsets[r + 1] = count;
+    }
+
+    for (int r = 0; r < num_rows; ++r) {
+        offsets[r + 1] += offsets[r];
+    }
+
+    std::vector<uint32_t> indices(offsets[num_rows]);
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const uint64_t* words = words_.data() + static_cast<size_t>(r) * words_per_row_;
+        const uint32_t row_start = static_cast<uint32_t>(static_cast<size_t>(r) * grid_.num_x);
+        uint32_t* out = indices.data() + offsets[r];
+
+        for (int w = 0; w < words_per_row_; ++w) {
+            uint64_t bits = words[w];
+            while (bits) {
+                *out++ = row_start + w * 64 + std::countr_zero(bits);
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    return indices;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <bit>
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "grid.hpp"
+
+
+class Volume;
+
+
+/**
+ * @class OccupancyGrid
+ * @brief Bit-packed voxel occupancy, one bit per voxel and 64 voxels per word.
+ *
+ * Every X row of the grid starts at a word boundary, so rows never share words and can be written
+ * concurrently by different threads without synchronization. Bits past num_x in the last word of a
+ * row are always zero.
+ */
+class OccupancyGrid {
+public: // Constructors
+    /** @brief Construct an empty grid without voxels. */
+    OccupancyGrid() = default;
+
+    /**
+     * @brief Construct a grid with all voxels unoccupied.
+     * @param grid Voxel grid layout.
+     */
+    explicit OccupancyGrid(const Grid& grid);
+
+public: // Statics
+    /**
+     * @brief Build an occupancy grid from the active voxels of a volume.
+     * @param volume Source volume.
+     * @param grid Grid layout; must match the dimensions of the volume.
+     * @return Occupancy of the volume.
+     */
+    static OccupancyGrid from_volume(const Volume& volume, const Grid& grid);
+
+public: // Methods
+    /**
+     * @brief Resize to a grid layout and clear all voxels.
+     * @param grid Voxel grid layout.
+     */
+    void reset(const Grid& grid);
+
+    /** @brief Mark all voxels as unoccupied. */
+    void clear();
+
+    /** @brief Mark all voxels as occupied. */
+    void fill();
+
+    /** @brief Mark voxel (x, y, z) as occupied. */
+    void set(int x, int y, int z) {
+        words_[word_index(x, y, z)] |= uint64_t(1) << (x & 63);
+    }
+
+    /** @brief Mark voxel (x, y, z) as unoccupied. */
+    void unset(int x, int y, int z) {
+        words_[word_index(x, y, z)] &= ~(uint64_t(1) << (x & 63));
+    }
+
+    /**
+     * @brief Mark a run of voxels along a row as occupied.
+     * @param x_begin First voxel of the run.
+     * @param x_end One past the last voxel of the run.
+     * @param y Row Y coordinate.
+     * @param z Row Z coordinate.
+     */
+    void set_run(int x_begin, int x_end, int y, int z);
+
+    /**
+     * @brief Grow the occupied region by a cube of the given radius (Chebyshev distance).
+     * @param radius Radius in voxels; voxels outside the grid are never occupied.
+     */
+    void dilate(int radius);
+
+    /**
+     * @brief Shrink the occupied region by a cube of the given radius (Chebyshev distance).
+     * @param radius Radius in voxels; voxels outside the grid count as unoccupied.
+     */
+    void erode(int radius);
+
+    /**
+     * @brief Write the occupancy into a volume, activating occupied and deactivating empty voxels.
+     *
+     * Only previously active and occupied voxels are touched.
+     *
+     * @param volume Target volume; must match the grid dimensions.
+     * @param color Color assigned to occupied voxels.
+     */
+    void to_volume(Volume& volume, const glm::vec4& color) const;
+
+    /**
+     * @brief Call a function for every occupied voxel in grid order.
+     * @param fn Callable taking (int x, int y, int z).
+     */
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (int z = 0; z < grid_.num_z; ++z) {
+            for (int y = 0; y < grid_.num_y; ++y) {
+                const uint64_t* words = row(y, z);
+                for (int w = 0; w < words_per_row_; ++w) {
+                    uint64_t bits = words[w];
+                    while (bits) {
+                        fn(w * 64 + std::countr_zero(bits), y, z);
+                        bits &= bits - 1;
+                    }
+                }
+            }
+        }
+    }
+
+public: // Getters
+    /** @brief Check whether voxel (x, y, z) is occupied. */
+    bool test(int x, int y, int z) const {
+        return (words_[word_index(x, y, z)] >> (x & 63)) & 1;
+    }
+
+    /** @brief Get the number of occupied voxels. */
+    size_t count() const;
+
+    /**
+     * @brief Get the linear indices (grid order, X fastest) of all occupied voxels.
+     *
+     * Rows are counted with popcount and written at their prefix offsets in parallel, so the list is
+     * sorted without locks or a merge step. Indices are 32 bits, so the grid must have at most
+     * UINT32_MAX voxels.
+     *
+     * @return Sorted voxel indices.
+     */
+    std::vector<uint32_t> active_indices() const;
+
+    /** @brief Get the words of row (y, z). */
+    const uint64_t* row(int y, int z) const { return words_.data() + row_offset(y, z); }
+
+    /** @brief Get the mutable words of row (y, z). */
+    uint64_t* row(int y, int z) { return words_.data() + row_offset(y, z); }
+
+    /** @brief Get the number of words per row. */
+    int words_per_row() const { return words_per_row_; }
+
+    /** @brief Get the grid layout. */
+    const Grid& grid() const { return grid_; }
+
+    /** @brief Get the memory used by the bits in bytes. */
+    size_t memory_bytes() const { return words_.size() * sizeof(uint64_t); }
+
+private: // Methods
+    /**
+     * @brief Apply a separable cube dilation or erosion, one axis at a time.
+     * @param radius Radius in voxels.
+     * @param grow True to dilate, false to erode.
+     */
+    void morph(int radius, bool grow);
+
+    /** @brief Get the offset of the first word of row (y, z). */
+    size_t row_offset(int y, int z) const {
+        return (static_cast<size_t>(z) * grid_.num_y + y) * words_per_row_;
+    }
+
+    /** @brief Get the index of the word holding voxel (x, y, z). */
+    size_t word_index(int x, int y, int z) const { return row_offset(y, z) + (x >> 6); }
+
+private: // Variables
+    Grid grid_;                     // Grid layout
+    int words_per_row_ = 0;         // Words per X row
+    std::vector<uint64_t> words_;   // Occupancy bits, row-aligned
+};
@@ -0,0 +1,58 @@
+#include "ordering.hpp"
+
+#include <numeric>
+#include <algorithm>
+
+
+// Rows a thread processes between merges of its rejection counters
+constexpr const int VIEW_ORDER_INTERVAL = 16;
+
+
+/* Constructors */
+
+ViewOrder::ViewOrder(std::vector<size_t>& tested, std::vector<size_t>& rejected)
+    : tested_(tested), rejected_(rejected),
+      local_tested_(tested.size(), 0), local_rejected_(rejected.size(), 0), order_(tested.size()) {
+    std::iota(order_.begin(), order_.end(), 0);
+}
+
+
+/* Public methods */
+
+void ViewOrder::row_done() {
+    if (++rows_ >= VIEW_ORDER_INTERVAL) {
+        synchronize();
+    }
+}
+
+void ViewOrder::synchronize() {
+    rows_ = 0;
+
+#pragma omp critical (view_order)
+    {
+        for (size_t v = 0; v < order_.size(); ++v) {
+            tested_[v] += local_tested_[v];
+            rejected_[v] += local_rejected_[v];
+        }
+        order_ = order_by_rejection(tested_, rejected_);
+    }
+
+    std::fill(local_tested_.begin(), local_tested_.end(), 0);
+    std::fill(local_rejected_.begin(), local_rejected_.end(), 0);
+}
+
+
+/* Functions */
+
+std::vector<int> order_by_rejection(const std::vector<size_t>& tested, const std::vector<size_t>& rejected) {
+    std::vector<int> order(tested.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    // Laplace smoothing keeps rarely tested views near 0.5 instead of at 0 or 1
+    auto rate = [&](int v) {
+        return (static_cast<double>(rejected[v]) + 1.0) / (static_cast<double>(tested[v]) + 2.0);
+    };
+
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return rate(a) > rate(b); });
+    return order;
+}
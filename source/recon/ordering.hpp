@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+
+/**
+ * @class ViewOrder
+ * @brief Per-thread view test order that adapts to how often each view rejects voxels.
+ *
+ * A voxel test stops at the first view that rejects it, so testing the most selective views first
+ * minimizes the number of lookups. Each thread counts tests and rejections locally and periodically
+ * merges them into shared totals, after which it re-sorts its order by the smoothed rejection rate.
+ */
+class ViewOrder {
+public: // Constructors
+    /**
+     * @brief Start with the views in project order.
+     * @param tested Shared number of tests per view.
+     * @param rejected Shared number of rejections per view.
+     */
+    ViewOrder(std::vector<size_t>& tested, std::vector<size_t>& rejected);
+
+public: // Methods
+    /**
+     * @brief Count one test of a view.
+     * @param view View index.
+     * @param rejected Whether the view rejected the voxel.
+     */
+    void record(int view, bool rejected) {
+        local_tested_[view]++;
+        local_rejected_[view] += rejected;
+    }
+
+    /** @brief Count a finished row and synchronize every few rows. */
+    void row_done();
+
+    /** @brief Merge the local counters into the shared totals and re-sort the order. */
+    void synchronize();
+
+public: // Getters
+    /** @brief Get the view indices in test order. */
+    const int* order() const { return order_.data(); }
+
+private: // Variables
+    std::vector<size_t>& tested_;           // Shared tests per view
+    std::vector<size_t>& rejected_;         // Shared rejections per view
+    std::vector<size_t> local_tested_;      // Tests per view since the last merge
+    std::vector<size_t> local_rejected_;    // Rejections per view since the last merge
+    std::vector<int> order_;                // View indices in test order
+    int rows_ = 0;                          // Rows since the last merge
+};
+
+
+/**
+ * @brief Sort views by decreasing smoothed rejection rate.
+ * @param tested Number of tests per view.
+ * @param rejected Number of rejections per view.
+ * @return View indices, most selective first; ties keep project order.
+ */
+std::vector<int> order_by_rejection(const std::vector<size_t>& tested, const std::vector<size_t>& rejected);
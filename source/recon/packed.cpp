@@ -0,0 +1,79 @@
+#include "packed.hpp"
+
+#include <limits>
+#include <algorithm>
+
+#include "simd.hpp"
+
+
+// Mask value of foreground pixels
+constexpr const uint8_t PACKED_FOREGROUND = std::numeric_limits<uint8_t>::max();
+
+// Rows of tiles below which a mask is packed on a single thread
+constexpr const int PACKED_PARALLEL_ROWS = 64;
+
+
+/* Functions */
+
+#if defined(SIMD_AVX2)
+// Pack the leading multiple of 32 pixels of a row, 32 pixels giving the row bytes of four tiles; returns the pixels done
+SIMD_TARGET_AVX2 static int pack_row_avx2(const uint8_t* pixels, int width, int shift, uint64_t* tiles) {
+    const __m256i foreground = _mm256_set1_epi8(static_cast<char>(PACKED_FOREGROUND));
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + x));
+        const uint64_t lanes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, foreground)));
+        uint64_t* out = tiles + (x >> 3);
+        out[0] |= (lanes & 0xFF) << shift;
+        out[1] |= ((lanes >> 8) & 0xFF) << shift;
+        out[2] |= ((lanes >> 16) & 0xFF) << shift;
+        out[3] |= (lanes >> 24) << shift;
+    }
+    return x;
+}
+#endif
+
+// Pack one pixel row into row r of a row of tiles
+static void pack_row(const uint8_t* pixels, int width, int r, uint64_t* tiles) {
+    const int shift = 8 * r;
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = pack_row_avx2(pixels, width, shift, tiles);
+    }
+#endif
+    for (; x < width; ++x) {
+        tiles[x >> 3] |= static_cast<uint64_t>(pixels[x] == PACKED_FOREGROUND) << (shift + (x & 7));
+    }
+}
+
+
+/* Public methods */
+
+void PackedMask::build(const cv::Mat& mask) {
+    clear();
+    if (mask.empty()) {
+        return;
+    }
+
+    // Padding pixels of the last tile row and column stay background
+    size_ = mask.size();
+    tiles_x_ = tiles_per_row(size_.width);
+    const int tiles_y = (size_.height + 7) >> 3;
+    words_.assign(static_cast<size_t>(tiles_x_) * tiles_y, 0);
+
+#pragma omp parallel for schedule(static) if (tiles_y >= PACKED_PARALLEL_ROWS)
+    for (int ty = 0; ty < tiles_y; ++ty) {
+        uint64_t* tiles = words_.data() + static_cast<size_t>(ty) * tiles_x_;
+        const int rows = std::min(8, size_.height - 8 * ty);
+        for (int r = 0; r < rows; ++r) {
+            pack_row(mask.ptr<uint8_t>(8 * ty + r), size_.width, r, tiles);
+        }
+    }
+}
+
+void PackedMask::clear() {
+    words_.clear();
+    size_ = cv::Size();
+    tiles_x_ = 0;
+}
@@ -0,0 +1,372 @@
+#include "pinhole.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "simd.hpp"
+
+#if !defined(SIMD_AVX2) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+// Points closer to the camera plane than this are treated as behind the camera
+constexpr const float MIN_CAMERA_DEPTH = 1e-3f;
+
+// Samples per edge of the grid box when bounding its image; distortion bends the edges between the corners
+constexpr const int BOUNDS_EDGE_SAMPLES = 32;
+
+// Pixels added around the projected grid box, covering the rounding to the nearest pixel
+constexpr const int BOUNDS_MARGIN = 2;
+
+// Fixed-point iterations inverting the distortion, as cv::undistortPoints
+constexpr const int UNDISTORT_ITERATIONS = 20;
+
+
+/* Kernels */
+
+namespace {
+
+/**
+ * @struct RowSetup
+ * @brief Camera coordinates of the first voxel of a grid row and the per-voxel step along the row.
+ */
+struct RowSetup {
+    float base[3];
+    float step[3];
+};
+
+inline void distort(const PinholeModel& m, float xc, float yc, float zc, float& u, float& v) {
+    if (zc <= MIN_CAMERA_DEPTH) {
+        u = v = std::numeric_limits<float>::quiet_NaN();
+        return;
+    }
+
+    float inv_z = 1.0f / zc;
+    float xn = xc * inv_z;
+    float yn = yc * inv_z;
+
+    float r2 = xn * xn + yn * yn;
+    float r4 = r2 * r2;
+    float r6 = r4 * r2;
+    float radial = 1.0f + m.k1 * r2 + m.k2 * r4 + m.k3 * r6;
+
+    float a1 = 2.0f * xn * yn;
+    float a2 = r2 + 2.0f * xn * xn;
+    float a3 = r2 + 2.0f * yn * yn;
+
+    float xd = xn * radial + m.p1 * a1 + m.p2 * a2;
+    float yd = yn * radial + m.p1 * a3 + m.p2 * a1;
+
+    u = m.fx * xd + m.cx;
+    v = m.fy * yd + m.cy;
+}
+
+void project_row_scalar(const PinholeModel& m, const RowSetup& row, int begin, int end, float* out_x, float* out_y) {
+    float xc = row.base[0] + row.step[0] * begin;
+    float yc = row.base[1] + row.step[1] * begin;
+    float zc = row.base[2] + row.step[2] * begin;
+
+    for (int i = begin; i < end; ++i) {
+        distort(m, xc, yc, zc, out_x[i], out_y[i]);
+        xc += row.step[0];
+        yc += row.step[1];
+        zc += row.step[2];
+    }
+}
+
+#if defined(SIMD_AVX2)
+
+SIMD_TARGET_AVX2 int project_row_avx2(const PinholeModel& m, const RowSetup& row, int count, float* out_x, float* out_y) {
+    constexpr int LANES = 8;
+    const int vector_end = count - count % LANES;
+
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 min_depth = _mm256_set1_ps(MIN_CAMERA_DEPTH);
+    const __m256 nan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+    const __m256 k1 = _mm256_set1_ps(m.k1), k2 = _mm256_set1_ps(m.k2), k3 = _mm256_set1_ps(m.k3);
+    const __m256 p1 = _mm256_set1_ps(m.p1), p2 = _mm256_set1_ps(m.p2);
+    const __m256 fx = _mm256_set1_ps(m.fx), fy = _mm256_set1_ps(m.fy);
+    const __m256 cx = _mm256_set1_ps(m.cx), cy = _mm256_set1_ps(m.cy);
+
+    // Camera coordinates of the first LANES voxels, advanced by a constant vector per iteration
+    __m256 xc = _mm256_add_ps(_mm256_set1_ps(row.base[0]), _mm256_mul_ps(lane, _mm256_set1_ps(row.step[0])));
+    __m256 yc = _mm256_add_ps(_mm256_set1_ps(row.base[1]), _mm256_mul_ps(lane, _mm256_set1_ps(row.step[1])));
+    __m256 zc = _mm256_add_ps(_mm256_set1_ps(row.base[2]), _mm256_mul_ps(lane, _mm256_set1_ps(row.step[2])));
+    const __m256 dx = _mm256_set1_ps(row.step[0] * LANES);
+    const __m256 dy = _mm256_set1_ps(row.step[1] * LANES);
+    const __m256 dz = _mm256_set1_ps(row.step[2] * LANES);
+
+    for (int i = 0; i < vector_end; i += LANES) {
+        __m256 valid = _mm256_cmp_ps(zc, min_depth, _CMP_GT_OQ);
+        __m256 inv_z = _mm256_div_ps(one, zc);
+        __m256 xn = _mm256_mul_ps(xc, inv_z);
+        __m256 yn = _mm256_mul_ps(yc, inv_z);
+
+        __m256 xx = _mm256_mul_ps(xn, xn);
+        __m256 yy = _mm256_mul_ps(yn, yn);
+        __m256 r2 = _mm256_add_ps(xx, yy);
+        __m256 r4 = _mm256_mul_ps(r2, r2);
+        __m256 r6 = _mm256_mul_ps(r4, r2);
+        __m256 radial = _mm256_add_ps(one, _mm256_add_ps(_mm256_mul_ps(k1, r2),
+            _mm256_add_ps(_mm256_mul_ps(k2, r4), _mm256_mul_ps(k3, r6))));
+
+        __m256 a1 = _mm256_mul_ps(two, _mm256_mul_ps(xn, yn));
+        __m256 a2 = _mm256_add_ps(r2, _mm256_mul_ps(two, xx));
+        __m256 a3 = _mm256_add_ps(r2, _mm256_mul_ps(two, yy));
+
+        __m256 xd = _mm256_add_ps(_mm256_mul_ps(xn, radial), _mm256_add_ps(_mm256_mul_ps(p1, a1), _mm256_mul_ps(p2, a2)));
+        __m256 yd = _mm256_add_ps(_mm256_mul_ps(yn, radial), _mm256_add_ps(_mm256_mul_ps(p1, a3), _mm256_mul_ps(p2, a1)));
+
+        __m256 u = _mm256_add_ps(_mm256_mul_ps(fx, xd), cx);
+        __m256 v = _mm256_add_ps(_mm256_mul_ps(fy, yd), cy);
+
+        _mm256_storeu_ps(out_x + i, _mm256_blendv_ps(nan, u, valid));
+        _mm256_storeu_ps(out_y + i, _mm256_blendv_ps(nan, v, valid));
+
+        xc = _mm256_add_ps(xc, dx);
+        yc = _mm256_add_ps(yc, dy);
+        zc = _mm256_add_ps(zc, dz);
+    }
+
+    return vector_end;
+}
+
+int project_row_simd(const PinholeModel& m, const RowSetup& row, int count, float* out_x, float* out_y) {
+    return cpu_has_avx2() ? project_row_avx2(m, row, count, out_x, out_y) : 0;
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+int project_row_simd(const PinholeModel& m, const RowSetup& row, int count, float* out_x, float* out_y) {
+    constexpr int LANES = 4;
+    const int vector_end = count - count % LANES;
+
+    const float lane_init[LANES] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    const float32x4_t lane = vld1q_f32(lane_init);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t two = vdupq_n_f32(2.0f);
+    const float32x4_t min_depth = vdupq_n_f32(MIN_CAMERA_DEPTH);
+    const float32x4_t nan = vdupq_n_f32(std::numeric_limits<float>::quiet_NaN());
+
+    float32x4_t xc = vmlaq_n_f32(vdupq_n_f32(row.base[0]), lane, row.step[0]);
+    float32x4_t yc = vmlaq_n_f32(vdupq_n_f32(row.base[1]), lane, row.step[1]);
+    float32x4_t zc = vmlaq_n_f32(vdupq_n_f32(row.base[2]), lane, row.step[2]);
+    const float32x4_t dx = vdupq_n_f32(row.step[0] * LANES);
+    const float32x4_t dy = vdupq_n_f32(row.step[1] * LANES);
+    const float32x4_t dz = vdupq_n_f32(row.step[2] * LANES);
+
+    for (int i = 0; i < vector_end; i += LANES) {
+        uint32x4_t valid = vcgtq_f32(zc, min_depth);
+        float32x4_t inv_z = vdivq_f32(one, zc);
+        float32x4_t xn = vmulq_f32(xc, inv_z);
+        float32x4_t yn = vmulq_f32(yc, inv_z);
+
+        float32x4_t xx = vmulq_f32(xn, xn);
+        float32x4_t yy = vmulq_f32(yn, yn);
+        float32x4_t r2 = vaddq_f32(xx, yy);
+        float32x4_t r4 = vmulq_f32(r2, r2);
+        float32x4_t r6 = vmulq_f32(r4, r2);
+        float32x4_t radial = vaddq_f32(one, vaddq_f32(vmulq_n_f32(r2, m.k1),
+            vaddq_f32(vmulq_n_f32(r4, m.k2), vmulq_n_f32(r6, m.k3))));
+
+        float32x4_t a1 = vmulq_f32(two, vmulq_f32(xn, yn));
+        float32x4_t a2 = vaddq_f32(r2, vmulq_f32(two, xx));
+        float32x4_t a3 = vaddq_f32(r2, vmulq_f32(two, yy));
+
+        float32x4_t xd = vaddq_f32(vmulq_f32(xn, radial), vaddq_f32(vmulq_n_f32(a1, m.p1), vmulq_n_f32(a2, m.p2)));
+        float32x4_t yd = vaddq_f32(vmulq_f32(yn, radial), vaddq_f32(vmulq_n_f32(a3, m.p1), vmulq_n_f32(a1, m.p2)));
+
+        float32x4_t u = vaddq_f32(vmulq_n_f32(xd, m.fx), vdupq_n_f32(m.cx));
+        float32x4_t v = vaddq_f32(vmulq_n_f32(yd, m.fy), vdupq_n_f32(m.cy));
+
+        vst1q_f32(out_x + i, vbslq_f32(valid, u, nan));
+        vst1q_f32(out_y + i, vbslq_f32(valid, v, nan));
+
+        xc = vaddq_f32(xc, dx);
+        yc = vaddq_f32(yc, dy);
+        zc = vaddq_f32(zc, dz);
+    }
+
+    return vector_end;
+}
+
+#else
+
+int project_row_simd(const PinholeModel&, const RowSetup&, int, float*, float*) {
+    return 0;
+}
+
+#endif
+
+} // namespace
+
+
+/* PinholeModel */
+
+PinholeModel PinholeModel::from_calibration(const cv::Mat& rvec, const cv::Mat& tvec, const cv::Mat& intrinsic, const cv::Mat& distortion) {
+    PinholeModel model;
+
+    cv::Mat rotation;
+    cv::Rodrigues(rvec, rotation);
+    rotation.convertTo(rotation, CV_64F);
+    for (int i = 0; i < 9; ++i) {
+        model.rotation[i] = static_cast<float>(rotation.at<double>(i / 3, i % 3));
+    }
+
+    cv::Mat translation;
+    tvec.convertTo(translation, CV_64F);
+    for (int i = 0; i < 3; ++i) {
+        model.translation[i] = static_cast<float>(translation.at<double>(i));
+    }
+
+    cv::Mat camera;
+    intrinsic.convertTo(camera, CV_64F);
+    model.fx = static_cast<float>(camera.at<double>(0, 0));
+    model.fy = static_cast<float>(camera.at<double>(1, 1));
+    model.cx = static_cast<float>(camera.at<double>(0, 2));
+    model.cy = static_cast<float>(camera.at<double>(1, 2));
+
+    cv::Mat coeffs;
+    distortion.convertTo(coeffs, CV_64F);
+    coeffs = coeffs.reshape(1, 1);
+    auto coeff = [&](int i) { return i < coeffs.cols ? static_cast<float>(coeffs.at<double>(0, i)) : 0.0f; };
+    model.k1 = coeff(0);
+    model.k2 = coeff(1);
+    model.p1 = coeff(2);
+    model.p2 = coeff(3);
+    model.k3 = coeff(4);
+
+    return model;
+}
+
+cv::Point2f PinholeModel::project(const glm::vec3& point) const {
+    glm::vec3 cam = to_camera(point);
+    cv::Point2f pixel;
+    distort(*this, cam.x, cam.y, cam.z, pixel.x, pixel.y);
+    return pixel;
+}
+
+cv::Point2d PinholeModel::normalize(const cv::Point2d& pixel) const {
+    const double xd = (pixel.x - cx) / fx;
+    const double yd = (pixel.y - cy) / fy;
+
+    // Solve distort() for the undistorted point, starting from the distorted one
+    double x = xd;
+    double y = yd;
+    for (int i = 0; i < UNDISTORT_ITERATIONS; ++i) {
+        const double r2 = x * x + y * y;
+        const double radial = 1.0 + r2 * (k1 + r2 * (k2 + r2 * k3));
+        const double dx = 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+        const double dy = p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
+        x = (xd - dx) / radial;
+        y = (yd - dy) / radial;
+    }
+    return cv::Point2d(x, y);
+}
+
+glm::vec3 PinholeModel::to_camera(const glm::vec3& point) const {
+    return glm::vec3(
+        rotation[0] * point.x + rotation[1] * point.y + rotation[2] * point.z + translation[0],
+        rotation[3] * point.x + rotation[4] * point.y + rotation[5] * point.z + translation[1],
+        rotation[6] * point.x + rotation[7] * point.y + rotation[8] * point.z + translation[2]
+    );
+}
+
+glm::vec3 PinholeModel::center() const {
+    // -R^T t
+    const auto& r = rotation;
+    const auto& t = translation;
+    return glm::vec3(
+        -(r[0] * t[0] + r[3] * t[1] + r[6] * t[2]),
+        -(r[1] * t[0] + r[4] * t[1] + r[7] * t[2]),
+        -(r[2] * t[0] + r[5] * t[1] + r[8] * t[2])
+    );
+}
+
+
+/* Functions */
+
+void project_grid(const PinholeModel& model, const Grid& grid, int z_begin, int z_end, float* out_x, float* out_y, bool simd) {
+    const auto& r = model.rotation;
+    const auto& t = model.translation;
+    const double size = grid.voxel_size;
+
+    // Moving one voxel along X adds the scaled first rotation column to the camera coordinates
+    RowSetup row;
+    row.step[0] = static_cast<float>(r[0] * size);
+    row.step[1] = static_cast<float>(r[3] * size);
+    row.step[2] = static_cast<float>(r[6] * size);
+
+    size_t offset = 0;
+    for (int zi = z_begin; zi < z_end; ++zi) {
+        for (int yi = 0; yi < grid.num_y; ++yi) {
+            // Row base in double precision so rounding errors do not accumulate across rows
+            double wx = grid.origin.x;
+            double wy = grid.origin.y + yi * size;
+            double wz = grid.origin.z + zi * size;
+            row.base[0] = static_cast<float>(r[0] * wx + r[1] * wy + r[2] * wz + t[0]);
+            row.base[1] = static_cast<float>(r[3] * wx + r[4] * wy + r[5] * wz + t[1]);
+            row.base[2] = static_cast<float>(r[6] * wx + r[7] * wy + r[8] * wz + t[2]);
+
+            float* row_x = out_x + offset;
+            float* row_y = out_y + offset;
+            int done = simd ? project_row_simd(model, row, grid.num_x, row_x, row_y) : 0;
+            project_row_scalar(model, row, done, grid.num_x, row_x, row_y);
+
+            offset += grid.num_x;
+        }
+    }
+}
+
+cv::Rect grid_image_bounds(const PinholeModel& model, const Grid& grid, const cv::Size& image_size) {
+    const cv::Rect image(0, 0, image_size.width, image_size.height);
+
+    // The voxel cubes reach half a voxel beyond the outermost samples
+    const glm::vec3 half(grid.voxel_size * 0.5f);
+    const glm::vec3 low = grid.origin - half;
+    const glm::vec3 high = grid.position(grid.num_x - 1, grid.num_y - 1, grid.num_z - 1) + half;
+
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+
+    // Edge e runs along axis e / 4; the bits of e % 4 pick the low or high side of the other two axes
+    for (int edge = 0; edge < 12; ++edge) {
+        const int axis = edge / 4;
+        const int side_a = (axis + 1) % 3;
+        const int side_b = (axis + 2) % 3;
+
+        for (int s = 0; s <= BOUNDS_EDGE_SAMPLES; ++s) {
+            glm::vec3 point;
+            point[axis] = low[axis] + (high[axis] - low[axis]) * s / BOUNDS_EDGE_SAMPLES;
+            point[side_a] = edge & 1 ? high[side_a] : low[side_a];
+            point[side_b] = edge & 2 ? high[side_b] : low[side_b];
+
+            // A box reaching behind the camera can cover any part of the image
+            cv::Point2f pixel = model.project(point);
+            if (!std::isfinite(pixel.x) || !std::isfinite(pixel.y)) {
+                return image;
+            }
+
+            min_x = std::min(min_x, pixel.x);
+            min_y = std::min(min_y, pixel.y);
+            max_x = std::max(max_x, pixel.x);
+            max_y = std::max(max_y, pixel.y);
+        }
+    }
+
+    // Clamp before converting so boxes projecting far outside the image do not overflow
+    const float limit_x = static_cast<float>(image_size.width + BOUNDS_MARGIN);
+    const float limit_y = static_cast<float>(image_size.height + BOUNDS_MARGIN);
+    const int x0 = static_cast<int>(std::floor(std::clamp(min_x, -limit_x, limit_x))) - BOUNDS_MARGIN;
+    const int y0 = static_cast<int>(std::floor(std::clamp(min_y, -limit_y, limit_y))) - BOUNDS_MARGIN;
+    const int x1 = static_cast<int>(std::ceil(std::clamp(max_x, -limit_x, limit_x))) + BOUNDS_MARGIN + 1;
+    const int y1 = static_cast<int>(std::ceil(std::clamp(max_y, -limit_y, limit_y))) + BOUNDS_MARGIN + 1;
+
+    return cv::Rect(x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)) & image;
+}
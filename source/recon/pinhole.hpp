@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "grid.hpp"
+
+
+/**
+ * @struct PinholeModel
+ * @brief Single-precision copy of a view calibration for batch projection.
+ *
+ * Uses the same pinhole and 5-coefficient distortion model (k1, k2, p1, p2, k3) as cv::projectPoints.
+ * Points at or behind the camera plane project to NaN instead of being mirrored through the camera.
+ *
+ * Members:
+ * - rotation: Row-major world-to-camera rotation matrix.
+ * - translation: World-to-camera translation (View::tvec_proj).
+ * - fx, fy, cx, cy: Focal length and principal point in pixels.
+ * - k1, k2, p1, p2, k3: Distortion coefficients.
+ */
+struct PinholeModel {
+    std::array<float, 9> rotation{};                // Row-major rotation matrix
+    std::array<float, 3> translation{};             // Translation vector
+    float fx = 0.0f, fy = 0.0f;                     // Focal length in pixels
+    float cx = 0.0f, cy = 0.0f;                     // Principal point in pixels
+    float k1 = 0.0f, k2 = 0.0f, k3 = 0.0f;          // Radial distortion coefficients
+    float p1 = 0.0f, p2 = 0.0f;                     // Tangential distortion coefficients
+
+    /**
+     * @brief Build a model from OpenCV calibration matrices.
+     * @param rvec Rotation vector.
+     * @param tvec Translation vector.
+     * @param intrinsic Intrinsic camera matrix.
+     * @param distortion Distortion coefficients (up to 5 are used).
+     * @return Pinhole model.
+     */
+    static PinholeModel from_calibration(const cv::Mat& rvec, const cv::Mat& tvec, const cv::Mat& intrinsic, const cv::Mat& distortion);
+
+    /**
+     * @brief Project a single world point.
+     * @param point World position (OpenCV coordinates).
+     * @return Pixel position, or NaN coordinates if the point is behind the camera.
+     */
+    cv::Point2f project(const glm::vec3& point) const;
+
+    /**
+     * @brief Undo the intrinsics and the distortion of a pixel, the inverse of project().
+     * @param pixel Pixel position.
+     * @return Normalized image coordinates (camera X / Z, Y / Z) of the ray through the pixel.
+     */
+    cv::Point2d normalize(const cv::Point2d& pixel) const;
+
+    /** @brief Transform a world point into camera coordinates. */
+    glm::vec3 to_camera(const glm::vec3& point) const;
+
+    /** @brief Get the camera center in world coordinates. */
+    glm::vec3 center() const;
+
+    /** @brief Compare two models for identical parameters. */
+    bool operator==(const PinholeModel& other) const = default;
+};
+
+
+/**
+ * @brief Project the voxel sample points of a Z slab of the grid.
+ *
+ * Along a grid row the camera coordinates change by a constant vector, so each point costs three adds
+ * plus the perspective divide and distortion. Uses AVX2 or NEON when available, scalar code otherwise.
+ *
+ * @param model Pinhole model of the view.
+ * @param grid Voxel grid.
+ * @param z_begin First Z layer of the slab.
+ * @param z_end One past the last Z layer of the slab.
+ * @param out_x Output pixel X per voxel, (z_end - z_begin) * num_y * num_x entries in grid order.
+ * @param out_y Output pixel Y per voxel, same layout as out_x.
+ * @param simd Use the AVX2 or NEON kernels when available; false forces the scalar code (for accuracy checks).
+ */
+void project_grid(const PinholeModel& model, const Grid& grid, int z_begin, int z_end, float* out_x, float* out_y, bool simd = true);
+
+/**
+ * @brief Bound the image region a grid can project into.
+ *
+ * Projects points along the twelve edges of the box covered by the voxel cubes, so distortion between
+ * the corners is accounted for, and adds a small margin. Pixels outside the region can never affect
+ * a carve of the grid.
+ *
+ * @param model Pinhole model of the view.
+ * @param grid Voxel grid.
+ * @param image_size Image size of the view.
+ * @return Region clipped to the image; the whole image if the box reaches behind the camera.
+ */
+cv::Rect grid_image_bounds(const PinholeModel& model, const Grid& grid, const cv::Size& image_size);
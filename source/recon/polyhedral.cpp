@@ -0,0 +1,1022 @@
+#include "polyhedral.hpp"
+
+#include <map>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <omp.h>
+
+
+// Tolerance of the edge tracing relative to the diagonal of the grid box; crossings closer than this to
+// the start of an edge belong to the faces of the start vertex itself
+constexpr const double HULL_TRACE_EPSILON = 1e-9;
+
+// Traced vertices beyond this many per viewing edge vertex mean the tracing diverged
+constexpr const size_t HULL_MAX_VERTEX_GROWTH = 64;
+
+// Amplitude of the perturbation of the contour vertices in normalized image coordinates (about 1e-4 px);
+// it moves coincident viewing rays of symmetric camera setups apart, so no four faces meet at a point
+constexpr const double HULL_PERTURBATION = 1e-7;
+
+// Builds with another perturbation before faces are left open: nearly tangent cones at frontier points can
+// still meet within the rounding error of the tracing for one perturbation, rarely for the next
+constexpr const int HULL_ATTEMPTS = 4;
+
+// Link of a vertex edge that has not been traced yet, and of one whose tracing failed
+constexpr const uint32_t HULL_UNTRACED = std::numeric_limits<uint32_t>::max();
+constexpr const uint32_t HULL_FAILED = HULL_UNTRACED - 1;
+
+// Box faces follow the cone faces, in the order -X, +X, -Y, +Y, -Z, +Z
+constexpr const int HULL_BOX_FACES = 6;
+
+
+/* Types */
+
+namespace {
+
+/** @brief World-to-camera transform of a view in double precision. */
+struct HullCamera {
+    std::array<double, 9> rotation{};   // Row-major world-to-camera rotation
+    glm::dvec3 translation{0.0};        // World-to-camera translation
+    glm::dvec3 center{0.0};             // Camera center in world coordinates
+
+    /** @brief Rotate a world direction into camera coordinates. */
+    glm::dvec3 rotate(const glm::dvec3& d) const {
+        const auto& r = rotation;
+        return glm::dvec3(r[0] * d.x + r[1] * d.y + r[2] * d.z, r[3] * d.x + r[4] * d.y + r[5] * d.z, r[6] * d.x + r[7] * d.y + r[8] * d.z);
+    }
+
+    /** @brief Rotate a camera direction into world coordinates. */
+    glm::dvec3 to_world(const glm::dvec3& d) const {
+        const auto& r = rotation;
+        return glm::dvec3(r[0] * d.x + r[3] * d.y + r[6] * d.z, r[1] * d.x + r[4] * d.y + r[7] * d.z, r[2] * d.x + r[5] * d.y + r[8] * d.z);
+    }
+
+    /** @brief Transform a world point into camera coordinates. */
+    glm::dvec3 to_camera(const glm::dvec3& p) const { return rotate(p) + translation; }
+};
+
+/**
+ * @brief Face of the hull: the wedge of a silhouette cone spanned by one contour edge, or a box face.
+ *
+ * The plane of a cone face contains the camera center; its inward normal points to the silhouette
+ * side of the contour edge. Points with normal . X + offset > 0 lie on the inner side.
+ */
+struct HullFace {
+    int view = -1;                  // View of a cone face, -1 for box faces
+    uint32_t prev = 0;              // Cone face of the previous contour edge, sharing corner a
+    uint32_t next = 0;              // Cone face of the next contour edge, sharing corner b
+    glm::dvec2 a{0.0};              // Contour edge start, normalized image coordinates
+    glm::dvec2 b{0.0};              // Contour edge end, normalized image coordinates
+    glm::dvec3 plane{0.0};          // Inward normal in camera coordinates
+    glm::dvec3 normal{0.0};         // Inward world normal
+    double offset = 0.0;            // World plane offset
+};
+
+/** @brief Hull vertex where three faces meet. */
+struct HullVertex {
+    std::array<uint32_t, 3> faces;  // Faces meeting at the vertex, sorted
+    std::array<uint32_t, 3> links;  // Vertex at the other end of the edge opposite each face
+    glm::dvec3 position;            // World position
+};
+
+/** @brief Part of a viewing ray inside the cones tested so far, with the faces bounding it. */
+struct RayInterval {
+    double lo, hi;                  // Ray parameters of the ends
+    uint32_t lo_face, hi_face;      // Faces the ray crosses at the ends
+};
+
+/** @brief Viewing edge found for a contour vertex. */
+struct ViewingEdge {
+    std::array<uint32_t, 3> lo_key, hi_key; // Faces of the end vertices, sorted
+    glm::dvec3 lo, hi;                      // End positions
+    int lo_slot, hi_slot;                   // Index of the crossing face within the sorted keys
+};
+
+/** @brief End of an edge followed from a vertex. */
+struct HullTrace {
+    uint32_t vertex = 0;            // Start vertex
+    int slot = 0;                   // Edge opposite faces[slot] of the start vertex
+    uint32_t face = HULL_FAILED;    // Face ending the edge, HULL_FAILED if none was found
+    glm::dvec3 position{0.0};       // End position
+};
+
+/** @brief Face cycle as a ring of vertex indices with planar coordinates. */
+struct HullRing {
+    std::vector<uint32_t> ids;      // Vertex indices
+    std::vector<glm::dvec2> points; // Coordinates in the face plane
+    double area = 0.0;              // Signed area, positive for outer boundaries
+};
+
+
+/* Functions */
+
+/** @brief Sort three face ids into a vertex key. */
+std::array<uint32_t, 3> vertex_key(uint32_t a, uint32_t b, uint32_t c) {
+    std::array<uint32_t, 3> key = { a, b, c };
+    std::sort(key.begin(), key.end());
+    return key;
+}
+
+/** @brief Deterministic offset in [-1, 1] for a contour vertex (splitmix64 of its seed, view and index). */
+double perturbation(uint64_t seed) {
+    seed += 0x9e3779b97f4a7c15ull;
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ull;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebull;
+    seed ^= seed >> 31;
+    return static_cast<double>(seed >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/** @brief Get the index of a face within a vertex key, or -1. */
+int key_slot(const std::array<uint32_t, 3>& key, uint32_t face) {
+    for (int k = 0; k < 3; ++k) {
+        if (key[k] == face) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/** @brief Twice the signed area of a triangle, positive if counter-clockwise. */
+double area2(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/** @brief Check whether a point lies inside a polygon (even-odd rule). */
+bool ring_contains(const std::vector<glm::dvec2>& ring, const glm::dvec2& p) {
+    bool inside = false;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        const glm::dvec2& a = ring[i];
+        const glm::dvec2& b = ring[j];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/** @brief Check whether two segments cross at a point interior to both. */
+bool segments_cross(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& c, const glm::dvec2& d) {
+    const double d1 = area2(a, b, c);
+    const double d2 = area2(a, b, d);
+    const double d3 = area2(c, d, a);
+    const double d4 = area2(c, d, b);
+    return ((d1 > 0.0 && d2 < 0.0) || (d1 < 0.0 && d2 > 0.0)) && ((d3 > 0.0 && d4 < 0.0) || (d3 < 0.0 && d4 > 0.0));
+}
+
+/** @brief Check whether a segment crosses any edge of a ring. */
+bool crosses_ring(const glm::dvec2& a, const glm::dvec2& b, const std::vector<glm::dvec2>& ring) {
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        if (segments_cross(a, b, ring[j], ring[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Splice a hole into its outer ring through a bridge to the nearest visible outer vertex.
+ * @param outer Outer ring, counter-clockwise; receives the hole.
+ * @param hole Hole ring, clockwise.
+ * @param holes All holes of the outer ring, which the bridge may not cross.
+ */
+void bridge_hole(HullRing& outer, const HullRing& hole, const std::vector<const HullRing*>& holes) {
+    // Bridge from the rightmost hole vertex
+    size_t m = 0;
+    for (size_t i = 1; i < hole.points.size(); ++i) {
+        if (hole.points[i].x > hole.points[m].x) {
+            m = i;
+        }
+    }
+    const glm::dvec2 from = hole.points[m];
+
+    std::vector<size_t> order(outer.points.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    auto distance = [&](size_t i) { const glm::dvec2 d = outer.points[i] - from; return glm::dot(d, d); };
+    std::sort(order.begin(), order.end(), [&](size_t i, size_t j) { return distance(i) < distance(j); });
+
+    // Nearest outer vertex whose bridge crosses no boundary and runs through the face
+    size_t target = order.front();
+    for (size_t i : order) {
+        const glm::dvec2 to = outer.points[i];
+        const glm::dvec2 mid = (from + to) * 0.5;
+        bool visible = !crosses_ring(from, to, outer.points) && ring_contains(outer.points, mid);
+        for (const HullRing* other : holes) {
+            visible = visible && !crosses_ring(from, to, other->points) && !ring_contains(other->points, mid);
+        }
+        if (visible) {
+            target = i;
+            break;
+        }
+    }
+
+    // outer[..target], hole from m around to m, outer[target..]
+    HullRing merged;
+    for (size_t i = 0; i <= target; ++i) {
+        merged.ids.push_back(outer.ids[i]);
+        merged.points.push_back(outer.points[i]);
+    }
+    for (size_t k = 0; k <= hole.ids.size(); ++k) {
+        const size_t i = (m + k) % hole.ids.size();
+        merged.ids.push_back(hole.ids[i]);
+        merged.points.push_back(hole.points[i]);
+    }
+    for (size_t i = target; i < outer.ids.size(); ++i) {
+        merged.ids.push_back(outer.ids[i]);
+        merged.points.push_back(outer.points[i]);
+    }
+    merged.area = outer.area + hole.area;
+    outer = std::move(merged);
+}
+
+/**
+ * @brief Triangulate a counter-clockwise ring by ear clipping.
+ *
+ * Only reflex corners can lie inside an ear, so only they are tested. Rings that have no ear left
+ * through rounding clip their next corner anyway, which keeps every edge of the ring in the mesh.
+ *
+ * @param ring Ring to triangulate; bridged holes repeat their bridge vertices.
+ * @param triangles Output vertex indices, three per triangle.
+ */
+void clip_ears(const HullRing& ring, std::vector<uint32_t>& triangles) {
+    const int n = static_cast<int>(ring.ids.size());
+    if (n < 3) {
+        return;
+    }
+
+    std::vector<int> prev(n), next(n);
+    std::vector<char> reflex(n);
+    for (int i = 0; i < n; ++i) {
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+    }
+    auto update = [&](int i) { reflex[i] = area2(ring.points[prev[i]], ring.points[i], ring.points[next[i]]) <= 0.0; };
+    for (int i = 0; i < n; ++i) {
+        update(i);
+    }
+
+    auto is_ear = [&](int i) {
+        const glm::dvec2& a = ring.points[prev[i]];
+        const glm::dvec2& b = ring.points[i];
+        const glm::dvec2& c = ring.points[next[i]];
+        if (reflex[i]) {
+            return false;
+        }
+        for (int j = next[next[i]]; j != prev[i]; j = next[j]) {
+            const glm::dvec2& p = ring.points[j];
+            if (!reflex[j] || p == a || p == b || p == c) {
+                continue;
+            }
+            if (area2(a, b, p) >= 0.0 && area2(b, c, p) >= 0.0 && area2(c, a, p) >= 0.0) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    int i = 0;
+    int remaining = n;
+    int stalled = 0;
+    while (remaining > 3) {
+        if (is_ear(i) || stalled > remaining) {
+            triangles.insert(triangles.end(), { ring.ids[prev[i]], ring.ids[i], ring.ids[next[i]] });
+            next[prev[i]] = next[i];
+            prev[next[i]] = prev[i];
+            update(prev[i]);
+            update(next[i]);
+            i = next[i];
+            --remaining;
+            stalled = 0;
+        }
+        else {
+            i = next[i];
+            ++stalled;
+        }
+    }
+    triangles.insert(triangles.end(), { ring.ids[prev[i]], ring.ids[i], ring.ids[next[i]] });
+}
+
+
+/**
+ * @class HullCones
+ * @brief Silhouette cones and box faces of a build, with the geometric queries of the edge tracing.
+ */
+class HullCones {
+public: // Methods
+    /** @brief Set up the cameras, cone faces and box faces, perturbing the contours with a seed. */
+    HullCones(const std::vector<View>& views, const std::vector<SilhouettePolygon>& polygons, const Grid& grid, int seed);
+
+    /** @brief Clip the ray through every contour vertex of a view against the other cones and the box. */
+    std::vector<ViewingEdge> viewing_edges(int view) const;
+
+    /** @brief Follow the edge opposite faces[slot] of a vertex to its other end. */
+    HullTrace trace(const HullVertex& vertex, int slot) const;
+
+    /** @brief Intersect three face planes, or return the fallback point if they are nearly parallel. */
+    glm::dvec3 intersect(uint32_t a, uint32_t b, uint32_t c, const glm::dvec3& fallback) const;
+
+    /** @brief Get a direction in the plane of a face pointing into the face across its edge with another face. */
+    glm::dvec3 inward(uint32_t face, uint32_t across) const;
+
+public: // Getters
+    /** @brief Get a face. */
+    const HullFace& face(uint32_t id) const { return faces_[id]; }
+
+    /** @brief Get the number of views. */
+    int view_count() const { return static_cast<int>(cameras_.size()); }
+
+    /** @brief Get the number of faces. */
+    uint32_t face_count() const { return static_cast<uint32_t>(faces_.size()); }
+
+private: // Methods
+    /** @brief Check whether two faces are cone faces of the same view. */
+    bool same_view(uint32_t a, uint32_t b) const { return faces_[a].view >= 0 && faces_[a].view == faces_[b].view; }
+
+    /** @brief Check whether a camera point projects inside the silhouette of a view. */
+    bool inside(int view, const glm::dvec3& camera_point) const;
+
+    /** @brief Check whether a camera point on the plane of a cone face projects onto its contour edge. */
+    bool on_edge(const HullFace& face, const glm::dvec3& camera_point) const;
+
+    /**
+     * @brief Get the camera-space linear form that is zero on the ray through an end of a contour edge
+     * and positive towards the other end.
+     */
+    glm::dvec3 boundary(const HullFace& face, bool at_b) const;
+
+private: // Variables
+    std::vector<HullCamera> cameras_;       // Camera per view
+    std::vector<HullFace> faces_;           // Cone faces by view, then the box faces
+    std::vector<uint32_t> view_faces_;      // First cone face per view, plus the end
+    glm::dvec3 box_min_{0.0};               // Box minimum corner
+    glm::dvec3 box_max_{0.0};               // Box maximum corner
+    double epsilon_ = 0.0;                  // Tracing tolerance in world units
+};
+
+HullCones::HullCones(const std::vector<View>& views, const std::vector<SilhouettePolygon>& polygons, const Grid& grid, int seed) {
+    const int num_views = static_cast<int>(views.size());
+    cameras_.resize(num_views);
+    view_faces_.assign(num_views + 1, 0);
+
+    for (int v = 0; v < num_views; ++v) {
+        const PinholeModel& model = views[v].pinhole;
+        HullCamera& camera = cameras_[v];
+        for (int i = 0; i < 9; ++i) {
+            camera.rotation[i] = model.rotation[i];
+        }
+        camera.translation = glm::dvec3(model.translation[0], model.translation[1], model.translation[2]);
+        camera.center = -camera.to_world(camera.translation);
+
+        // One face per contour edge, linked to its neighbors around the contour
+        std::vector<std::pair<uint32_t, uint32_t>> contours;
+        for (const auto& contour : polygons[v].contours()) {
+            // Straight corners would give two faces in one plane; drop them exactly on the pixel coordinates
+            std::vector<cv::Point> kept;
+            for (size_t i = 0; i < contour.size(); ++i) {
+                const cv::Point& p = kept.empty() ? contour.back() : kept.back();
+                const cv::Point& q = contour[i];
+                const cv::Point& r = contour[(i + 1) % contour.size()];
+                const int64_t turn = static_cast<int64_t>(q.x - p.x) * (r.y - q.y) - static_cast<int64_t>(q.y - p.y) * (r.x - q.x);
+                if (turn != 0) {
+                    kept.push_back(q);
+                }
+            }
+            if (kept.size() < 3) {
+                continue;
+            }
+
+            const uint32_t first = static_cast<uint32_t>(faces_.size());
+            const uint32_t count = static_cast<uint32_t>(kept.size());
+            std::vector<glm::dvec2> corners(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                const cv::Point2d p = model.normalize(cv::Point2d(kept[i].x, kept[i].y));
+                const uint64_t key = ((static_cast<uint64_t>(seed) << 56) ^ (static_cast<uint64_t>(v) << 32)) + first + i;
+                corners[i] = glm::dvec2(p.x + HULL_PERTURBATION * perturbation(2 * key), p.y + HULL_PERTURBATION * perturbation(2 * key + 1));
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                HullFace face;
+                face.view = v;
+                face.prev = first + (i + count - 1) % count;
+                face.next = first + (i + 1) % count;
+                face.a = corners[i];
+                face.b = corners[(i + 1) % count];
+                faces_.push_back(face);
+            }
+            contours.emplace_back(first, first + count);
+        }
+        view_faces_[v + 1] = static_cast<uint32_t>(faces_.size());
+
+        // Orient every contour from one probe just left of its longest edge; holes come out reversed
+        for (const auto& [first, end] : contours) {
+            uint32_t longest = first;
+            for (uint32_t f = first; f < end; ++f) {
+                const glm::dvec2 e = faces_[f].b - faces_[f].a;
+                const glm::dvec2 l = faces_[longest].b - faces_[longest].a;
+                longest = glm::dot(e, e) > glm::dot(l, l) ? f : longest;
+            }
+            const glm::dvec2 e = faces_[longest].b - faces_[longest].a;
+            const glm::dvec2 probe = (faces_[longest].a + faces_[longest].b) * 0.5 + glm::dvec2(-e.y, e.x) * 1e-3;
+            const bool left_inside = inside(v, glm::dvec3(probe.x, probe.y, 1.0));
+
+            for (uint32_t f = first; f < end; ++f) {
+                HullFace& face = faces_[f];
+                glm::dvec3 plane = glm::cross(glm::dvec3(face.a.x, face.a.y, 1.0), glm::dvec3(face.b.x, face.b.y, 1.0));
+                const glm::dvec2 left(face.a.y - face.b.y, face.b.x - face.a.x);
+                const bool positive_left = plane.x * left.x + plane.y * left.y > 0.0;
+                plane = glm::normalize(positive_left == left_inside ? plane : -plane);
+
+                // plane . (R X + t) > 0  <=>  (R^T plane) . X + plane . t > 0
+                face.plane = plane;
+                face.normal = camera.to_world(plane);
+                face.offset = glm::dot(plane, camera.translation);
+            }
+        }
+    }
+
+    // The box covered by the voxel cubes
+    const glm::vec3 half(grid.voxel_size * 0.5f);
+    box_min_ = glm::dvec3(grid.origin - half);
+    box_max_ = glm::dvec3(grid.origin + grid.extent() - half);
+    epsilon_ = HULL_TRACE_EPSILON * glm::length(box_max_ - box_min_);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        HullFace low, high;
+        low.normal[axis] = 1.0;
+        low.offset = -box_min_[axis];
+        high.normal[axis] = -1.0;
+        high.offset = box_max_[axis];
+        faces_.push_back(low);
+        faces_.push_back(high);
+    }
+}
+
+std::vector<ViewingEdge> HullCones::viewing_edges(int view) const {
+    std::vector<ViewingEdge> edges;
+    const HullCamera& camera = cameras_[view];
+    const uint32_t box = view_faces_.back();
+    const uint32_t none = HULL_FAILED;
+    const int num_views = static_cast<int>(cameras_.size());
+
+    std::vector<std::pair<double, uint32_t>> crossings;
+    std::vector<RayInterval> inside_parts;
+    std::vector<RayInterval> clipped;
+
+    for (uint32_t f = view_faces_[view]; f < view_faces_[view + 1]; ++f) {
+        const HullFace& face = faces_[f];
+        const glm::dvec3 origin = camera.center;
+        const glm::dvec3 direction = camera.to_world(glm::dvec3(face.a.x, face.a.y, 1.0));
+
+        // Part of the ray in front of the camera and inside the box
+        RayInterval span = { 0.0, std::numeric_limits<double>::max(), none, none };
+        for (int axis = 0; axis < 3 && span.lo < span.hi; ++axis) {
+            if (std::abs(direction[axis]) < std::numeric_limits<double>::min()) {
+                span.hi = origin[axis] > box_min_[axis] && origin[axis] < box_max_[axis] ? span.hi : span.lo;
+                continue;
+            }
+            const bool forward = direction[axis] > 0.0;
+            const double enter = ((forward ? box_min_ : box_max_)[axis] - origin[axis]) / direction[axis];
+            const double leave = ((forward ? box_max_ : box_min_)[axis] - origin[axis]) / direction[axis];
+            if (enter > span.lo) {
+                span.lo = enter;
+                span.lo_face = box + 2 * axis + (forward ? 0 : 1);
+            }
+            if (leave < span.hi) {
+                span.hi = leave;
+                span.hi_face = box + 2 * axis + (forward ? 1 : 0);
+            }
+        }
+        if (!(span.hi - span.lo > epsilon_)) {
+            continue;
+        }
+        std::vector<RayInterval> parts = { span };
+
+        // Keep the parts inside every other cone
+        for (int k = 0; k < num_views && !parts.empty(); ++k) {
+            if (k == view) {
+                continue;
+            }
+            const HullCamera& other = cameras_[k];
+            const glm::dvec3 y0 = other.to_camera(origin);
+            const glm::dvec3 y1 = other.rotate(direction);
+            const double lo = parts.front().lo;
+            const double hi = parts.back().hi;
+
+            crossings.clear();
+            for (uint32_t g = view_faces_[k]; g < view_faces_[k + 1]; ++g) {
+                const double slope = glm::dot(faces_[g].plane, y1);
+                if (slope == 0.0) {
+                    continue;
+                }
+                const double t = -glm::dot(faces_[g].plane, y0) / slope;
+                if (t > lo && t < hi && on_edge(faces_[g], y0 + y1 * t)) {
+                    crossings.emplace_back(t, g);
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            // Classify the pieces between crossings by their midpoints
+            inside_parts.clear();
+            double start = lo;
+            uint32_t start_face = none;
+            for (size_t c = 0; c <= crossings.size(); ++c) {
+                const double end = c < crossings.size() ? crossings[c].first : hi;
+                const uint32_t end_face = c < crossings.size() ? crossings[c].second : none;
+                if (inside(k, y0 + y1 * ((start + end) * 0.5))) {
+                    if (!inside_parts.empty() && inside_parts.back().hi == start) {
+                        inside_parts.back().hi = end;
+                        inside_parts.back().hi_face = end_face;
+                    }
+                    else {
+                        inside_parts.push_back({ start, end, start_face, end_face });
+                    }
+                }
+                start = end;
+                start_face = end_face;
+            }
+
+            // Intersect the parts; ends keep the face of the tighter bound
+            clipped.clear();
+            size_t i = 0, j = 0;
+            while (i < parts.size() && j < inside_parts.size()) {
+                const RayInterval& p = parts[i];
+                const RayInterval& q = inside_parts[j];
+                RayInterval r;
+                r.lo = q.lo > p.lo ? q.lo : p.lo;
+                r.lo_face = q.lo > p.lo ? q.lo_face : p.lo_face;
+                r.hi = q.hi < p.hi ? q.hi : p.hi;
+                r.hi_face = q.hi < p.hi ? q.hi_face : p.hi_face;
+                if (r.hi - r.lo > epsilon_) {
+                    clipped.push_back(r);
+                }
+                (p.hi < q.hi ? i : j)++;
+            }
+            parts.swap(clipped);
+        }
+
+        // Each remaining part is a viewing edge between two vertices of the faces of the contour corner
+        for (const RayInterval& part : parts) {
+            if (part.lo_face == none || part.hi_face == none) {
+                continue;
+            }
+            ViewingEdge edge;
+            edge.lo_key = vertex_key(face.prev, f, part.lo_face);
+            edge.hi_key = vertex_key(face.prev, f, part.hi_face);
+            edge.lo = origin + direction * part.lo;
+            edge.hi = origin + direction * part.hi;
+            edge.lo_slot = key_slot(edge.lo_key, part.lo_face);
+            edge.hi_slot = key_slot(edge.hi_key, part.hi_face);
+            edges.push_back(edge);
+        }
+    }
+
+    return edges;
+}
+
+HullTrace HullCones::trace(const HullVertex& vertex, int slot) const {
+    HullTrace result;
+    result.slot = slot;
+
+    const uint32_t c = vertex.faces[slot];
+    const uint32_t a = vertex.faces[(slot + 1) % 3];
+    const uint32_t b = vertex.faces[(slot + 2) % 3];
+    const HullFace& fa = faces_[a];
+    const HullFace& fb = faces_[b];
+    const glm::dvec3& start = vertex.position;
+
+    glm::dvec3 direction = glm::cross(fa.normal, fb.normal);
+    const double length = glm::length(direction);
+    if (!(length > 0.0)) {
+        return result;
+    }
+    direction /= length;
+
+    // A cone face next to the third face continues into its own wedge; otherwise the edge runs inside the third face
+    double side = glm::dot(faces_[c].normal, direction);
+    if (!same_view(a, b) && (same_view(a, c) || same_view(b, c))) {
+        const uint32_t on = same_view(a, c) ? a : b;
+        const HullFace& wedge = faces_[on];
+        side = glm::dot(boundary(wedge, c == wedge.next), cameras_[wedge.view].rotate(direction));
+    }
+    if (side < 0.0) {
+        direction = -direction;
+    }
+
+    double best = std::numeric_limits<double>::max();
+    auto consider = [&](double t, uint32_t face) {
+        if (t > epsilon_ && t < best) {
+            best = t;
+            result.face = face;
+        }
+    };
+
+    // Ends of the wedges the edge lies on
+    if (!same_view(a, b)) {
+        for (const HullFace* wedge : { &fa, &fb }) {
+            if (wedge->view < 0) {
+                continue;
+            }
+            const HullCamera& camera = cameras_[wedge->view];
+            const glm::dvec3 y0 = camera.to_camera(start);
+            const glm::dvec3 y1 = camera.rotate(direction);
+            for (bool at_b : { false, true }) {
+                const glm::dvec3 form = boundary(*wedge, at_b);
+                const double slope = glm::dot(form, y1);
+                if (slope < 0.0) {
+                    const double t = -glm::dot(form, y0) / slope;
+                    if ((y0 + y1 * t).z > 0.0) {
+                        consider(t, at_b ? wedge->next : wedge->prev);
+                    }
+                }
+            }
+        }
+    }
+
+    // Exits from the other cones
+    const int num_views = static_cast<int>(cameras_.size());
+    for (int k = 0; k < num_views; ++k) {
+        if (k == fa.view || k == fb.view) {
+            continue;
+        }
+        const HullCamera& camera = cameras_[k];
+        const glm::dvec3 y0 = camera.to_camera(start);
+        const glm::dvec3 y1 = camera.rotate(direction);
+        for (uint32_t g = view_faces_[k]; g < view_faces_[k + 1]; ++g) {
+            const double slope = glm::dot(faces_[g].plane, y1);
+            if (g == c || !(slope < 0.0)) {
+                continue;
+            }
+            const double t = -glm::dot(faces_[g].plane, y0) / slope;
+            if (t > epsilon_ && t < best && on_edge(faces_[g], y0 + y1 * t)) {
+                consider(t, g);
+            }
+        }
+    }
+
+    // Exits from the box
+    for (uint32_t g = view_faces_.back(); g < faces_.size(); ++g) {
+        const double slope = glm::dot(faces_[g].normal, direction);
+        if (g == a || g == b || g == c || !(slope < 0.0)) {
+            continue;
+        }
+        consider(-(glm::dot(faces_[g].normal, start) + faces_[g].offset) / slope, g);
+    }
+
+    if (result.face != HULL_FAILED) {
+        result.position = intersect(a, b, result.face, start + direction * best);
+    }
+    return result;
+}
+
+glm::dvec3 HullCones::intersect(uint32_t a, uint32_t b, uint32_t c, const glm::dvec3& fallback) const {
+    const HullFace& fa = faces_[a];
+    const HullFace& fb = faces_[b];
+    const HullFace& fc = faces_[c];
+    const glm::dvec3 bc = glm::cross(fb.normal, fc.normal);
+    const double det = glm::dot(fa.normal, bc);
+    if (std::abs(det) < 1e-12) {
+        return fallback;
+    }
+    return -(bc * fa.offset + glm::cross(fc.normal, fa.normal) * fb.offset + glm::cross(fa.normal, fb.normal) * fc.offset) / det;
+}
+
+glm::dvec3 HullCones::inward(uint32_t face, uint32_t across) const {
+    const HullFace& f = faces_[face];
+    if (!same_view(face, across)) {
+        return faces_[across].normal;
+    }
+    return cameras_[f.view].to_world(boundary(f, across == f.next));
+}
+
+bool HullCones::inside(int view, const glm::dvec3& camera_point) const {
+    if (!(camera_point.z > 0.0)) {
+        return false;
+    }
+    const glm::dvec2 p(camera_point.x / camera_point.z, camera_point.y / camera_point.z);
+
+    bool result = false;
+    for (uint32_t f = view_faces_[view]; f < view_faces_[view + 1]; ++f) {
+        const glm::dvec2& a = faces_[f].a;
+        const glm::dvec2& b = faces_[f].b;
+        if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+            result = !result;
+        }
+    }
+    return result;
+}
+
+bool HullCones::on_edge(const HullFace& face, const glm::dvec3& camera_point) const {
+    if (!(camera_point.z > 0.0)) {
+        return false;
+    }
+    const glm::dvec2 p(camera_point.x / camera_point.z, camera_point.y / camera_point.z);
+    const glm::dvec2 e = face.b - face.a;
+    const double s = glm::dot(p - face.a, e);
+    return s >= 0.0 && s <= glm::dot(e, e);
+}
+
+glm::dvec3 HullCones::boundary(const HullFace& face, bool at_b) const {
+    // e . (Y.xy - a Y.z) grows from corner a, e . (b Y.z - Y.xy) from corner b
+    const glm::dvec2 e = face.b - face.a;
+    return at_b ? glm::dvec3(-e.x, -e.y, glm::dot(e, face.b)) : glm::dvec3(e.x, e.y, -glm::dot(e, face.a));
+}
+
+/**
+ * @brief Build the hull mesh of a set of cones.
+ * @param cones Silhouette cones and box.
+ * @param positions Output vertex positions.
+ * @param triangles Output triangle vertex indices.
+ * @param viewing_edges Output number of viewing edges.
+ * @return Number of faces left open.
+ */
+size_t build_mesh(const HullCones& cones, std::vector<glm::vec3>& positions, std::vector<uint32_t>& triangles, size_t& viewing_edges) {
+    std::vector<HullVertex> vertices;
+    std::map<std::array<uint32_t, 3>, uint32_t> index;
+    auto find_or_add = [&](const std::array<uint32_t, 3>& key, const glm::dvec3& position, bool& added) {
+        auto [it, inserted] = index.try_emplace(key, static_cast<uint32_t>(vertices.size()));
+        added = inserted;
+        if (inserted) {
+            vertices.push_back({ key, { HULL_UNTRACED, HULL_UNTRACED, HULL_UNTRACED }, position });
+        }
+        return it->second;
+    };
+
+    // Viewing edges of every contour vertex
+    const int num_views = cones.view_count();
+    std::vector<std::vector<ViewingEdge>> viewing(num_views);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int v = 0; v < num_views; ++v) {
+        viewing[v] = cones.viewing_edges(v);
+    }
+
+    for (const auto& edges : viewing) {
+        for (const ViewingEdge& edge : edges) {
+            bool added;
+            const uint32_t lo = find_or_add(edge.lo_key, edge.lo, added);
+            const uint32_t hi = find_or_add(edge.hi_key, edge.hi, added);
+            vertices[lo].links[edge.lo_slot] = hi;
+            vertices[hi].links[edge.hi_slot] = lo;
+            ++viewing_edges;
+        }
+    }
+
+    // Follow the cone intersection edges from every vertex, wave by wave, until no new vertex is found
+    const size_t max_vertices = std::max<size_t>(vertices.size(), 1) * HULL_MAX_VERTEX_GROWTH;
+    std::vector<uint32_t> wave(vertices.size());
+    for (size_t i = 0; i < wave.size(); ++i) {
+        wave[i] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<HullTrace> traces;
+    while (!wave.empty()) {
+        traces.clear();
+        for (uint32_t v : wave) {
+            for (int slot = 0; slot < 3; ++slot) {
+                if (vertices[v].links[slot] == HULL_UNTRACED) {
+                    HullTrace trace;
+                    trace.vertex = v;
+                    trace.slot = slot;
+                    traces.push_back(trace);
+                }
+            }
+        }
+
+        const int num_traces = static_cast<int>(traces.size());
+#pragma omp parallel for schedule(dynamic, 16)
+        for (int t = 0; t < num_traces; ++t) {
+            const uint32_t v = traces[t].vertex;
+            traces[t] = cones.trace(vertices[v], traces[t].slot);
+            traces[t].vertex = v;
+        }
+
+        wave.clear();
+        for (int t = 0; t < num_traces; ++t) {
+            const HullTrace& trace = traces[t];
+            if (trace.face == HULL_FAILED) {
+                vertices[trace.vertex].links[trace.slot] = HULL_FAILED;
+                continue;
+            }
+
+            const std::array<uint32_t, 3>& faces = vertices[trace.vertex].faces;
+            const std::array<uint32_t, 3> key = vertex_key(faces[(trace.slot + 1) % 3], faces[(trace.slot + 2) % 3], trace.face);
+            bool added;
+            const uint32_t to = find_or_add(key, trace.position, added);
+            if (added) {
+                wave.push_back(to);
+            }
+
+            // The same edge seen from its far end, unless that end already traced it itself
+            vertices[trace.vertex].links[trace.slot] = to;
+            uint32_t& back = vertices[to].links[key_slot(key, trace.face)];
+            if (back == HULL_UNTRACED) {
+                back = trace.vertex;
+            }
+        }
+
+        // Diverged tracing leaves every face open
+        if (vertices.size() > max_vertices) {
+            positions.clear();
+            return cones.face_count();
+        }
+    }
+
+    // Link the edges of every face into cycles, each starting from one unvisited vertex of the face
+    std::vector<std::array<bool, 3>> visited(vertices.size(), { false, false, false });
+    std::map<uint32_t, std::vector<std::vector<uint32_t>>> cycles;
+    std::vector<char> open(cones.face_count(), 0);
+
+    for (uint32_t v0 = 0; v0 < vertices.size(); ++v0) {
+        for (int k0 = 0; k0 < 3; ++k0) {
+            if (visited[v0][k0]) {
+                continue;
+            }
+            const uint32_t face = vertices[v0].faces[k0];
+            visited[v0][k0] = true;
+
+            // Leave along the edge of the face opposite the next slot; 'shared' is the other face of that edge
+            std::vector<uint32_t> cycle = { v0 };
+            uint32_t current = v0;
+            int leave = (k0 + 1) % 3;
+            uint32_t shared = vertices[v0].faces[(k0 + 2) % 3];
+            bool closed = false;
+
+            for (size_t step = 0; step <= vertices.size(); ++step) {
+                const uint32_t next = vertices[current].links[leave];
+                if (next >= vertices.size()) {
+                    break;
+                }
+                const HullVertex& at = vertices[next];
+                const int slot_face = key_slot(at.faces, face);
+                const int slot_shared = key_slot(at.faces, shared);
+                if (slot_face < 0 || slot_shared < 0) {
+                    break;
+                }
+                if (next == v0) {
+                    closed = true;
+                    break;
+                }
+                visited[next][slot_face] = true;
+                cycle.push_back(next);
+
+                // Arrived along (face, shared); leave along (face, third), the edge opposite 'shared'
+                const int third = 3 - slot_face - slot_shared;
+                leave = slot_shared;
+                shared = at.faces[third];
+                current = next;
+            }
+
+            if (!closed || cycle.size() < 3) {
+                open[face] = 1;
+                continue;
+            }
+
+            // Orient counter-clockwise seen from outside: the face interior lies left of every edge
+            const glm::dvec3 outward = -cones.face(face).normal;
+            const glm::dvec3 along = vertices[cycle[1]].position - vertices[cycle[0]].position;
+            const uint32_t first_shared = vertices[v0].faces[(k0 + 2) % 3];
+            if (glm::dot(glm::cross(outward, along), cones.inward(face, first_shared)) < 0.0) {
+                std::reverse(cycle.begin() + 1, cycle.end());
+            }
+            cycles[face].push_back(std::move(cycle));
+        }
+    }
+
+    // Triangulate the faces in their planes; holes are bridged into the outer boundary containing them
+    for (auto& [face, rings] : cycles) {
+        if (open[face]) {
+            continue;
+        }
+        const glm::dvec3 outward = -cones.face(face).normal;
+        const glm::dvec3 helper = std::abs(outward.x) < 0.9 ? glm::dvec3(1.0, 0.0, 0.0) : glm::dvec3(0.0, 1.0, 0.0);
+        const glm::dvec3 u = glm::normalize(glm::cross(helper, outward));
+        const glm::dvec3 w = glm::cross(outward, u);
+        const glm::dvec3 origin = vertices[rings.front().front()].position;
+
+        std::vector<HullRing> outers, holes;
+        for (const auto& ids : rings) {
+            HullRing ring;
+            ring.ids = ids;
+            for (uint32_t id : ids) {
+                const glm::dvec3 d = vertices[id].position - origin;
+                ring.points.emplace_back(glm::dot(d, u), glm::dot(d, w));
+            }
+            for (size_t i = 0, j = ring.points.size() - 1; i < ring.points.size(); j = i++) {
+                ring.area += 0.5 * area2(glm::dvec2(0.0), ring.points[j], ring.points[i]);
+            }
+            (ring.area >= 0.0 ? outers : holes).push_back(std::move(ring));
+        }
+        if (outers.empty()) {
+            open[face] = 1;
+            continue;
+        }
+
+        // Each hole belongs to the smallest outer boundary around it
+        std::vector<std::vector<const HullRing*>> owned(outers.size());
+        for (const HullRing& hole : holes) {
+            int owner = -1;
+            for (size_t o = 0; o < outers.size(); ++o) {
+                if (ring_contains(outers[o].points, hole.points.front()) && (owner < 0 || outers[o].area < outers[owner].area)) {
+                    owner = static_cast<int>(o);
+                }
+            }
+            if (owner >= 0) {
+                owned[owner].push_back(&hole);
+            }
+        }
+
+        for (size_t o = 0; o < outers.size(); ++o) {
+            std::sort(owned[o].begin(), owned[o].end(), [](const HullRing* p, const HullRing* q) {
+                return std::max_element(p->points.begin(), p->points.end(), [](auto& l, auto& r) { return l.x < r.x; })->x
+                     > std::max_element(q->points.begin(), q->points.end(), [](auto& l, auto& r) { return l.x < r.x; })->x;
+            });
+            for (size_t h = 0; h < owned[o].size(); ++h) {
+                const std::vector<const HullRing*> remaining(owned[o].begin() + h, owned[o].end());
+                bridge_hole(outers[o], *owned[o][h], remaining);
+            }
+            clip_ears(outers[o], triangles);
+        }
+    }
+
+    positions.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        positions[i] = glm::vec3(vertices[i].position);
+    }
+    return static_cast<size_t>(std::count(open.begin(), open.end(), 1));
+}
+
+} // namespace
+
+
+/* Public methods */
+
+void PolyhedralHull::build(const std::vector<View>& views, const Grid& grid) {
+    clear();
+
+    const int num_views = static_cast<int>(views.size());
+    if (num_views == 0) {
+        return;
+    }
+
+    // Vectorize the silhouettes
+    polygons_.resize(num_views);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int v = 0; v < num_views; ++v) {
+        polygons_[v].build(views[v].mask, epsilon_);
+    }
+
+    // Degenerate configurations depend on the perturbation of the contours; retry those with another one
+    for (int attempt = 0; attempt < HULL_ATTEMPTS; ++attempt) {
+        const HullCones cones(views, polygons_, grid, attempt);
+        viewing_edges_ = 0;
+        triangles_.clear();
+        open_faces_ = build_mesh(cones, vertices_, triangles_, viewing_edges_);
+        if (open_faces_ == 0) {
+            break;
+        }
+    }
+
+    // Area-weighted vertex normals
+    normals_.assign(vertices_.size(), glm::vec3(0.0f));
+    for (size_t t = 0; t < triangles_.size(); t += 3) {
+        const glm::vec3& a = vertices_[triangles_[t]];
+        const glm::vec3 normal = glm::cross(vertices_[triangles_[t + 1]] - a, vertices_[triangles_[t + 2]] - a);
+        for (int k = 0; k < 3; ++k) {
+            normals_[triangles_[t + k]] += normal;
+        }
+    }
+    for (glm::vec3& normal : normals_) {
+        const float length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+}
+
+void PolyhedralHull::clear() {
+    polygons_.clear();
+    vertices_.clear();
+    normals_.clear();
+    triangles_.clear();
+    viewing_edges_ = 0;
+    open_faces_ = 0;
+}
+
+
+/* Getters */
+
+size_t PolyhedralHull::contour_vertex_count() const {
+    size_t count = 0;
+    for (const auto& polygon : polygons_) {
+        count += polygon.vertex_count();
+    }
+    return count;
+}
+
+size_t PolyhedralHull::memory_bytes() const {
+    size_t bytes = (vertices_.size() + normals_.size()) * sizeof(glm::vec3) + triangles_.size() * sizeof(uint32_t);
+    for (const auto& polygon : polygons_) {
+        bytes += polygon.memory_bytes();
+    }
+    return bytes;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "contour.hpp"
+
+
+/**
+ * @class PolyhedralHull
+ * @brief Exact polyhedral visual hull of vectorized silhouettes (edge-based, EPVH).
+ *
+ * Every view mask is vectorized into polygon contours and undistorted, so each silhouette cone is a
+ * polyhedral cone with one planar face per contour edge. The hull is the intersection of the cones
+ * and the grid box, built directly from its edges without sampling any grid:
+ * - Viewing edges: the ray through every contour vertex is clipped against the other cones and the
+ *   box; the parts inside all of them are hull edges, their ends hull vertices.
+ * - Cone intersection edges: from every vertex, the edges along the intersection of two of its faces
+ *   are followed until they leave a cone or the box, which ends them in a viewing edge vertex or a
+ *   triple point of three faces. Vertices are identified by their three faces, so an edge reached
+ *   from both ends links the same two vertices.
+ * - Faces: the edges on every cone and box face are linked into oriented cycles (outer boundaries
+ *   counter-clockwise seen from outside, holes clockwise) and triangulated.
+ *
+ * The mesh is watertight and its vertices lie on the cone surfaces up to rounding, at any grid
+ * resolution; memory and time grow with the contour vertices, not the voxels. The grid only bounds
+ * the hull. Contour vertices are perturbed by about 1e-4 px so that symmetric camera setups do not
+ * make four faces meet in one point. Nearly tangent cones can still meet within the rounding error,
+ * so a build whose edges do not close into cycles is repeated with another perturbation; faces still
+ * open after that are left out and counted.
+ */
+class PolyhedralHull {
+public: // Methods
+    /**
+     * @brief Build the hull mesh of the views, clipped to the box covered by the voxels of a grid.
+     * @param views Calibrated views with masks.
+     * @param grid Grid bounding the hull.
+     */
+    void build(const std::vector<View>& views, const Grid& grid);
+
+    /** @brief Release the polygons and the mesh. */
+    void clear();
+
+    /**
+     * @brief Set the contour simplification tolerance.
+     * @param epsilon Maximum distance in pixels between a traced contour and its polygon.
+     */
+    void set_epsilon(double epsilon) { epsilon_ = epsilon; }
+
+public: // Getters
+    /** @brief Check whether the last build produced no triangles. */
+    bool empty() const { return triangles_.empty(); }
+
+    /** @brief Get the mesh vertices (OpenCV world coordinates, mm). */
+    const std::vector<glm::vec3>& vertices() const { return vertices_; }
+
+    /** @brief Get the area-weighted vertex normals, pointing out of the hull. */
+    const std::vector<glm::vec3>& normals() const { return normals_; }
+
+    /** @brief Get the triangle vertex indices, three per triangle, counter-clockwise seen from outside. */
+    const std::vector<uint32_t>& triangles() const { return triangles_; }
+
+    /** @brief Get the silhouette polygon of every view of the last build. */
+    const std::vector<SilhouettePolygon>& polygons() const { return polygons_; }
+
+    /** @brief Get the total number of polygon vertices of the last build. */
+    size_t contour_vertex_count() const;
+
+    /** @brief Get the number of viewing edges of the last build. */
+    size_t viewing_edge_count() const { return viewing_edges_; }
+
+    /** @brief Get the number of faces of the last build left open because their edges did not form cycles. */
+    size_t open_face_count() const { return open_faces_; }
+
+    /** @brief Get the memory used by the polygons and the mesh in bytes. */
+    size_t memory_bytes() const;
+
+private: // Variables
+    double epsilon_ = 1.0;                      // Contour simplification tolerance in pixels
+    std::vector<SilhouettePolygon> polygons_;   // Silhouette polygon per view
+    std::vector<glm::vec3> vertices_;           // Mesh vertices
+    std::vector<glm::vec3> normals_;            // Mesh vertex normals
+    std::vector<uint32_t> triangles_;           // Mesh triangles
+    size_t viewing_edges_ = 0;                  // Viewing edges of the last build
+    size_t open_faces_ = 0;                     // Faces left open in the last build
+};
@@ -0,0 +1,127 @@
+#include "projection.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <omp.h>
+
+
+// Number of Z layers projected per batch
+constexpr const int PROJECTION_SLAB = 4;
+
+
+/* Public methods */
+
+void ProjectionTable::build(const View& view, const Grid& grid) {
+    grid_ = grid;
+    image_size_ = view.mask.size();
+    model_ = view.pinhole;
+    addresses_.assign(grid.voxel_count(), OUTSIDE);
+
+    if (image_size_.area() == 0) {
+        return;
+    }
+
+    const size_t slice_size = static_cast<size_t>(grid.num_x) * grid.num_y;
+    const int num_slabs = (grid.num_z + PROJECTION_SLAB - 1) / PROJECTION_SLAB;
+    const float width = static_cast<float>(image_size_.width);
+    const float height = static_cast<float>(image_size_.height);
+    const int tiles_per_row = PackedMask::tiles_per_row(image_size_.width);
+
+#pragma omp parallel
+    {
+        std::vector<float> px(slice_size * PROJECTION_SLAB);
+        std::vector<float> py(slice_size * PROJECTION_SLAB);
+
+#pragma omp for schedule(dynamic, 1)
+        for (int slab = 0; slab < num_slabs; ++slab) {
+            int z_begin = slab * PROJECTION_SLAB;
+            int z_end = std::min(z_begin + PROJECTION_SLAB, grid.num_z);
+            project_grid(model_, grid, z_begin, z_end, px.data(), py.data());
+
+            uint32_t* out = addresses_.data() + grid.index(0, 0, z_begin);
+            const size_t count = slice_size * (z_end - z_begin);
+            for (size_t i = 0; i < count; ++i) {
+                // Reject NaN (behind the camera) and far out-of-image values before rounding
+                if (!(px[i] > -1.0f && px[i] < width && py[i] > -1.0f && py[i] < height)) {
+                    continue;
+                }
+
+                int col = cvRound(px[i]);
+                int row = cvRound(py[i]);
+                if (col >= 0 && col < image_size_.width && row >= 0 && row < image_size_.height) {
+                    out[i] = PackedMask::address(col, row, tiles_per_row);
+                }
+            }
+        }
+    }
+}
+
+void ProjectionTable::clear() {
+    addresses_.clear();
+    addresses_.shrink_to_fit();
+    image_size_ = cv::Size();
+    model_ = PinholeModel();
+}
+
+
+/* Getters */
+
+bool ProjectionTable::is_valid_for(const View& view, const Grid& grid) const {
+    return !addresses_.empty()
+        && grid_ == grid
+        && image_size_ == view.mask.size()
+        && model_ == view.pinhole;
+}
+
+
+/* Functions */
+
+float max_projection_error(const View& view, const Grid& grid, bool simd, int stride) {
+    const size_t count = grid.voxel_count();
+    const size_t slice_size = static_cast<size_t>(grid.num_x) * grid.num_y;
+
+    std::vector<float> px(slice_size);
+    std::vector<float> py(slice_size);
+    std::vector<cv::Point3f> obj_pts;
+    std::vector<cv::Point2f> batch_pts;
+
+    // Gather a strided sample of voxels that lie in front of the camera, one slice projection at a time
+    size_t idx = 0;
+    for (int zi = 0; zi < grid.num_z && idx < count; ++zi) {
+        size_t slice_end = (zi + 1) * slice_size;
+        if (idx >= slice_end) {
+            continue;
+        }
+
+        project_grid(view.pinhole, grid, zi, zi + 1, px.data(), py.data(), simd);
+
+        for (; idx < slice_end; idx += stride) {
+            size_t in_slice = idx - zi * slice_size;
+            if (std::isnan(px[in_slice])) {
+                continue;
+            }
+
+            int yi = static_cast<int>(in_slice / grid.num_x);
+            int xi = static_cast<int>(in_slice % grid.num_x);
+            glm::vec3 pos = grid.position(xi, yi, zi);
+            obj_pts.emplace_back(pos.x, pos.y, pos.z);
+            batch_pts.emplace_back(px[in_slice], py[in_slice]);
+        }
+    }
+
+    if (obj_pts.empty()) {
+        return 0.0f;
+    }
+
+    std::vector<cv::Point2f> ref_pts;
+    cv::projectPoints(obj_pts, view.rvec, view.tvec_proj, view.intrinsic, view.distortion, ref_pts);
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < ref_pts.size(); ++i) {
+        float dx = batch_pts[i].x - ref_pts[i].x;
+        float dy = batch_pts[i].y - ref_pts[i].y;
+        max_error = std::max(max_error, std::sqrt(dx * dx + dy * dy));
+    }
+    return max_error;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "packed.hpp"
+#include "pinhole.hpp"
+
+
+// Maximum pixel deviation of the batch projection from cv::projectPoints
+constexpr const float PROJECTION_TOLERANCE = 0.05f;
+
+
+/**
+ * @class ProjectionTable
+ * @brief Precomputed voxel-to-pixel lookup table for a single view.
+ *
+ * Stores, for every voxel of a grid, the PackedMask bit address of the mask pixel its sample point
+ * projects to, or OUTSIDE when it falls outside the image. The table only depends on the grid, the
+ * view calibration and the image size, so it stays valid when the mask contents change.
+ */
+class ProjectionTable {
+public: // Statics
+    /** @brief Sentinel for voxels that project outside the image. */
+    static constexpr uint32_t OUTSIDE = std::numeric_limits<uint32_t>::max();
+
+public: // Methods
+    /**
+     * @brief Project every voxel of the grid into the view and store the pixel bit addresses.
+     * @param view Calibrated view to project into.
+     * @param grid Voxel grid to project.
+     */
+    void build(const View& view, const Grid& grid);
+
+    /** @brief Release the table. */
+    void clear();
+
+public: // Getters
+    /**
+     * @brief Check whether the table was built for the given view calibration and grid.
+     * @param view View to compare against.
+     * @param grid Grid to compare against.
+     * @return True if the table can be reused as-is.
+     */
+    bool is_valid_for(const View& view, const Grid& grid) const;
+
+    /** @brief Get the pixel bit address for a voxel, or OUTSIDE. */
+    uint32_t address(size_t voxel_index) const { return addresses_[voxel_index]; }
+
+    /** @brief Get the raw bit address array. */
+    const uint32_t* data() const { return addresses_.data(); }
+
+    /** @brief Get the number of entries in the table. */
+    size_t size() const { return addresses_.size(); }
+
+    /** @brief Get the memory used by the table in bytes. */
+    size_t memory_bytes() const { return addresses_.size() * sizeof(uint32_t); }
+
+    /** @brief Get the grid the table was built for. */
+    const Grid& grid() const { return grid_; }
+
+private: // Variables
+    Grid grid_;                         // Grid the table was built for
+    cv::Size image_size_;               // Image size the addresses refer to
+    PinholeModel model_;                // Calibration the table was built for
+    std::vector<uint32_t> addresses_;   // Pixel bit address per voxel
+};
+
+
+/**
+ * @brief Compare the batch projection of a view against cv::projectPoints.
+ * @param view Calibrated view.
+ * @param grid Voxel grid.
+ * @param simd Check the vector kernels when available; false checks the scalar code.
+ * @param stride Test every stride-th voxel.
+ * @return Maximum pixel distance between both projections over the tested voxels in front of the camera.
+ */
+float max_projection_error(const View& view, const Grid& grid, bool simd, int stride = 97);
@@ -0,0 +1,206 @@
+#include "pyramid.hpp"
+
+#include <bit>
+#include <algorithm>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "simd.hpp"
+
+
+// Mask value of foreground pixels, as MaskIntegral counts them
+constexpr const uint8_t PYRAMID_FOREGROUND = 255;
+
+// Levels with fewer rows of cells are reduced on a single thread
+constexpr const int PYRAMID_PARALLEL_ROWS = 64;
+
+// Levels below the query level, whose cells are a quarter of the rectangle extent
+constexpr const int PYRAMID_QUERY_REFINE = 2;
+
+
+/* Functions */
+
+// Gather the even bits of a word into its low half
+static inline uint64_t compact_pairs(uint64_t bits) {
+#if defined(__BMI2__)
+    return _pext_u64(bits, 0x5555555555555555ull);
+#else
+    bits &= 0x5555555555555555ull;
+    bits = (bits | (bits >> 1)) & 0x3333333333333333ull;
+    bits = (bits | (bits >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    bits = (bits | (bits >> 4)) & 0x00FF00FF00FF00FFull;
+    bits = (bits | (bits >> 8)) & 0x0000FFFF0000FFFFull;
+    bits = (bits | (bits >> 16)) & 0x00000000FFFFFFFFull;
+    return bits;
+#endif
+}
+
+// Read count (at most 64) consecutive bits of a row starting at bit first
+static inline uint64_t row_bits(const uint64_t* row, int first, int count) {
+    const int word = first >> 6;
+    const int shift = first & 63;
+
+    uint64_t bits = row[word] >> shift;
+    if (shift + count > 64) {
+        bits |= row[word + 1] << (64 - shift);
+    }
+    return count == 64 ? bits : bits & ((uint64_t(1) << count) - 1);
+}
+
+#if defined(SIMD_AVX2)
+// Pack the leading multiple of 32 pixels of a mask row; returns the pixels done
+SIMD_TARGET_AVX2 static int pack_row_avx2(const uint8_t* pixels, int width, uint64_t* bits) {
+    const __m256i foreground = _mm256_set1_epi8(static_cast<char>(PYRAMID_FOREGROUND));
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + x));
+        const uint32_t lanes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, foreground)));
+        bits[x >> 6] |= static_cast<uint64_t>(lanes) << (x & 63);
+    }
+    return x;
+}
+#endif
+
+// Pack the foreground pixels of a mask row into bits
+static void pack_row(const uint8_t* pixels, int width, uint64_t* bits) {
+    int x = 0;
+#if defined(SIMD_AVX2)
+    if (cpu_has_avx2()) {
+        x = pack_row_avx2(pixels, width, bits);
+    }
+#endif
+    for (; x < width; ++x) {
+        bits[x >> 6] |= static_cast<uint64_t>(pixels[x] == PYRAMID_FOREGROUND) << (x & 63);
+    }
+}
+
+
+/* Public methods */
+
+void MaskPyramid::build(const cv::Mat& mask) {
+    clear();
+    if (mask.empty()) {
+        return;
+    }
+
+    // Levels halve the cell counts until a single cell covers the mask
+    size_ = mask.size();
+    const int extent = std::max(size_.width, size_.height);
+    levels_.resize(1 + std::bit_width(static_cast<unsigned>(extent - 1)));
+
+    for (int index = 0; index < levels(); ++index) {
+        Level& level = levels_[index];
+        level.width = (size_.width + (1 << index) - 1) >> index;
+        level.height = (size_.height + (1 << index) - 1) >> index;
+        level.words_per_row = (level.width + 63) / 64;
+        level.any.assign(static_cast<size_t>(level.words_per_row) * level.height, 0);
+        level.all.assign(static_cast<size_t>(level.words_per_row) * level.height, 0);
+    }
+
+    // A pixel is its own minimum and maximum
+    Level& base = levels_.front();
+#pragma omp parallel for schedule(static)
+    for (int y = 0; y < size_.height; ++y) {
+        pack_row(mask.ptr<uint8_t>(y), size_.width, base.any.data() + static_cast<size_t>(y) * base.words_per_row);
+    }
+    base.all = base.any;
+
+    for (int index = 1; index < levels(); ++index) {
+        reduce(index);
+    }
+}
+
+void MaskPyramid::clear() {
+    levels_.clear();
+    size_ = cv::Size();
+}
+
+Coverage MaskPyramid::classify(const cv::Rect& rect) const {
+    if (levels_.empty()) {
+        return Coverage::PARTIAL;
+    }
+
+    const cv::Rect inside = rect & cv::Rect(0, 0, size_.width, size_.height);
+    if (inside.empty()) {
+        return Coverage::EMPTY;
+    }
+
+    // Cells of at least a quarter of the extent, so the rectangle touches at most 5 per axis
+    const int extent = std::max(inside.width, inside.height);
+    const int index = std::max(static_cast<int>(std::bit_width(static_cast<unsigned>(extent - 1))) - PYRAMID_QUERY_REFINE, 0);
+    const Level& level = levels_[index];
+
+    const int col_begin = inside.x >> index;
+    const int col_end = (inside.x + inside.width - 1) >> index;
+    const int row_begin = inside.y >> index;
+    const int row_end = (inside.y + inside.height - 1) >> index;
+    const int count = col_end - col_begin + 1;
+    const uint64_t full = count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+
+    bool any = false;
+    bool all = true;
+    for (int row = row_begin; row <= row_end; ++row) {
+        const size_t offset = static_cast<size_t>(row) * level.words_per_row;
+        any |= row_bits(level.any.data() + offset, col_begin, count) != 0;
+        all &= row_bits(level.all.data() + offset, col_begin, count) == full;
+    }
+
+    if (!any) {
+        return Coverage::EMPTY;
+    }
+    if (all && inside == rect) {
+        return Coverage::FULL;
+    }
+    return Coverage::PARTIAL;
+}
+
+Coverage MaskPyramid::classify(const Footprint& footprint) const {
+    return footprint.bounded ? classify(footprint.rect) : Coverage::PARTIAL;
+}
+
+size_t MaskPyramid::memory_bytes() const {
+    size_t bytes = 0;
+    for (const Level& level : levels_) {
+        bytes += (level.any.size() + level.all.size()) * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+
+/* Private methods */
+
+void MaskPyramid::reduce(int index) {
+    const Level& src = levels_[index - 1];
+    Level& dst = levels_[index];
+
+    // Rows past the source count as background: they add nothing to any and clear all
+#pragma omp parallel for schedule(static) if (dst.height >= PYRAMID_PARALLEL_ROWS)
+    for (int y = 0; y < dst.height; ++y) {
+        const bool pair = 2 * y + 1 < src.height;
+        const uint64_t* any_top = src.any.data() + static_cast<size_t>(2 * y) * src.words_per_row;
+        const uint64_t* all_top = src.all.data() + static_cast<size_t>(2 * y) * src.words_per_row;
+        const uint64_t* any_bottom = any_top + src.words_per_row;
+        const uint64_t* all_bottom = all_top + src.words_per_row;
+        uint64_t* any_out = dst.any.data() + static_cast<size_t>(y) * dst.words_per_row;
+        uint64_t* all_out = dst.all.data() + static_cast<size_t>(y) * dst.words_per_row;
+
+        // Source word 2w feeds the low half of word w, source word 2w + 1 the high half
+        for (int w = 0; w < dst.words_per_row; ++w) {
+            uint64_t any_bits = 0;
+            uint64_t all_bits = 0;
+
+            for (int half = 0; half < 2 && 2 * w + half < src.words_per_row; ++half) {
+                const int word = 2 * w + half;
+                const uint64_t any = pair ? any_top[word] | any_bottom[word] : any_top[word];
+                const uint64_t all = pair ? all_top[word] & all_bottom[word] : 0;
+                any_bits |= compact_pairs(any | (any >> 1)) << (32 * half);
+                all_bits |= compact_pairs(all & (all >> 1)) << (32 * half);
+            }
+
+            any_out[w] = any_bits;
+            all_out[w] = all_bits;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+
+#include "footprint.hpp"
+
+
+/**
+ * @class MaskPyramid
+ * @brief Min/max mip pyramid of a binary silhouette mask.
+ *
+ * Level 0 holds one bit per pixel; a cell of level L covers 2^L x 2^L pixels and keeps two bits:
+ * whether any of its pixels is foreground (max) and whether all of them are (min). Pixels outside the
+ * image count as background. Both bit planes are packed 64 cells per word, so a level is reduced from
+ * the previous one with a few word operations per 64 cells.
+ *
+ * A rectangle is classified at the level whose cells are about a quarter of its size, reading at most
+ * 5 x 5 cells as at most ten words per plane. EMPTY and FULL are exact; near the silhouette boundary
+ * a rectangle may be reported PARTIAL when its covering cells overhang it by up to a quarter of its size.
+ */
+class MaskPyramid {
+public: // Methods
+    /**
+     * @brief Build the pyramid from a binary mask.
+     * @param mask Binary mask (255 = foreground), CV_8UC1.
+     */
+    void build(const cv::Mat& mask);
+
+    /** @brief Release the pyramid. */
+    void clear();
+
+public: // Getters
+    /**
+     * @brief Classify a pixel rectangle against the mask.
+     *
+     * Parts of the rectangle outside the image count as background, so a clipped rectangle is never FULL.
+     *
+     * @param rect Pixel rectangle.
+     * @return Coverage of the rectangle.
+     */
+    Coverage classify(const cv::Rect& rect) const;
+
+    /**
+     * @brief Classify a footprint against the mask, as MaskIntegral::classify().
+     * @param footprint Footprint to classify.
+     * @return Coverage of the footprint; PARTIAL if unbounded.
+     */
+    Coverage classify(const Footprint& footprint) const;
+
+    /** @brief Check whether the pyramid has been built. */
+    bool empty() const { return levels_.empty(); }
+
+    /** @brief Get the number of levels, the last one being a single cell. */
+    int levels() const { return static_cast<int>(levels_.size()); }
+
+    /** @brief Get the size of the mask the pyramid was built from. */
+    cv::Size size() const { return size_; }
+
+    /** @brief Get the memory used by the pyramid in bytes. */
+    size_t memory_bytes() const;
+
+private: // Types
+    /** @brief Bit planes of one level. */
+    struct Level {
+        int width = 0;                  // Cells per row
+        int height = 0;                 // Rows of cells
+        int words_per_row = 0;          // Words per row of a plane
+        std::vector<uint64_t> any;      // Cells with any foreground pixel
+        std::vector<uint64_t> all;      // Cells with only foreground pixels
+    };
+
+private: // Methods
+    /** @brief Reduce level index - 1 into level index. */
+    void reduce(int index);
+
+private: // Variables
+    cv::Size size_;                     // Mask size
+    std::vector<Level> levels_;         // Levels, finest first
+};
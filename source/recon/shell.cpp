@@ -0,0 +1,101 @@
+#include "shell.hpp"
+
+#include <bit>
+#include <array>
+
+#include <omp.h>
+
+
+/* Functions */
+
+/**
+ * @brief Compute the exposed faces of the 64 voxels of one occupancy word.
+ * @param occupancy Source occupancy.
+ * @param y Row Y coordinate.
+ * @param z Row Z coordinate.
+ * @param w Word index within the row.
+ * @param exposed Output words, one per face direction (SHELL_FACE_* bit order).
+ * @return Occupied voxels with at least one exposed face.
+ */
+static uint64_t exposed_faces(const OccupancyGrid& occupancy, int y, int z, int w, std::array<uint64_t, 6>& exposed) {
+    const Grid& grid = occupancy.grid();
+    const int last = occupancy.words_per_row() - 1;
+    const uint64_t* words = occupancy.row(y, z);
+
+    const uint64_t cur = words[w];
+    if (cur == 0) {
+        return 0;
+    }
+
+    // Neighbor occupancy of every bit; rows beyond the grid and padding bits past num_x are empty
+    const uint64_t prev = w > 0 ? words[w - 1] : 0;
+    const uint64_t next = w < last ? words[w + 1] : 0;
+    const uint64_t neg_x = (cur << 1) | (prev >> 63);
+    const uint64_t pos_x = (cur >> 1) | (next << 63);
+    const uint64_t neg_y = y > 0 ? occupancy.row(y - 1, z)[w] : 0;
+    const uint64_t pos_y = y < grid.num_y - 1 ? occupancy.row(y + 1, z)[w] : 0;
+    const uint64_t neg_z = z > 0 ? occupancy.row(y, z - 1)[w] : 0;
+    const uint64_t pos_z = z < grid.num_z - 1 ? occupancy.row(y, z + 1)[w] : 0;
+
+    exposed = { cur & ~neg_x, cur & ~pos_x, cur & ~neg_y, cur & ~pos_y, cur & ~neg_z, cur & ~pos_z };
+    return exposed[0] | exposed[1] | exposed[2] | exposed[3] | exposed[4] | exposed[5];
+}
+
+
+/* Public methods */
+
+void SurfaceShell::build(const OccupancyGrid& occupancy) {
+    grid_ = occupancy.grid();
+
+    const int num_rows = static_cast<int>(grid_.row_count());
+    const int words_per_row = occupancy.words_per_row();
+    std::vector<size_t> offsets(num_rows + 1, 0);
+
+    // Count per row, then let every row write at its prefix offset: sorted and lock-free
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        std::array<uint64_t, 6> exposed;
+        size_t count = 0;
+        for (int w = 0; w < words_per_row; ++w) {
+            count += std::popcount(exposed_faces(occupancy, r % grid_.num_y, r / grid_.num_y, w, exposed));
+        }
+        offsets[r + 1] = count;
+    }
+
+    for (int r = 0; r < num_rows; ++r) {
+        offsets[r + 1] += offsets[r];
+    }
+
+    indices_.resize(offsets[num_rows]);
+    faces_.resize(offsets[num_rows]);
+
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r < num_rows; ++r) {
+        const uint32_t row_start = static_cast<uint32_t>(static_cast<size_t>(r) * grid_.num_x);
+        uint32_t* out_index = indices_.data() + offsets[r];
+        uint8_t* out_faces = faces_.data() + offsets[r];
+        std::array<uint64_t, 6> exposed;
+
+        for (int w = 0; w < words_per_row; ++w) {
+            uint64_t bits = exposed_faces(occupancy, r % grid_.num_y, r / grid_.num_y, w, exposed);
+
+            while (bits) {
+                const int b = std::countr_zero(bits);
+                uint8_t mask = 0;
+                for (int f = 0; f < 6; ++f) {
+                    mask |= static_cast<uint8_t>(((exposed[f] >> b) & 1) << f);
+                }
+
+                *out_index++ = row_start + w * 64 + b;
+                *out_faces++ = mask;
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+void SurfaceShell::clear() {
+    grid_ = Grid();
+    indices_.clear();
+    faces_.clear();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "grid.hpp"
+#include "occupancy.hpp"
+
+
+// Exposed-face bits of shell voxels, one per 6-neighbor direction
+constexpr const uint8_t SHELL_FACE_NEG_X = 1 << 0;
+constexpr const uint8_t SHELL_FACE_POS_X = 1 << 1;
+constexpr const uint8_t SHELL_FACE_NEG_Y = 1 << 2;
+constexpr const uint8_t SHELL_FACE_POS_Y = 1 << 3;
+constexpr const uint8_t SHELL_FACE_NEG_Z = 1 << 4;
+constexpr const uint8_t SHELL_FACE_POS_Z = 1 << 5;
+
+
+/**
+ * @class SurfaceShell
+ * @brief Occupied voxels with at least one empty 6-neighbor, with the mask of their exposed faces.
+ *
+ * Built word-wise from an occupancy grid: the six neighbor words of every occupancy word are formed
+ * with shifts and row offsets, so 64 voxels are classified per operation. Voxels outside the grid
+ * count as empty. The interior of a carved hull, usually most of its voxels, is skipped entirely.
+ */
+class SurfaceShell {
+public: // Methods
+    /**
+     * @brief Extract the shell of an occupancy grid.
+     * @param occupancy Source occupancy.
+     */
+    void build(const OccupancyGrid& occupancy);
+
+    /** @brief Release the shell. */
+    void clear();
+
+public: // Getters
+    /** @brief Get the linear indices (grid order, X fastest) of the shell voxels, sorted. */
+    const std::vector<uint32_t>& indices() const { return indices_; }
+
+    /** @brief Get the exposed-face mask (SHELL_FACE_* bits) of every shell voxel, parallel to indices(). */
+    const std::vector<uint8_t>& faces() const { return faces_; }
+
+    /** @brief Get the number of shell voxels. */
+    size_t size() const { return indices_.size(); }
+
+    /** @brief Check whether the shell is empty. */
+    bool empty() const { return indices_.empty(); }
+
+    /** @brief Get the grid layout of the source occupancy. */
+    const Grid& grid() const { return grid_; }
+
+private: // Variables
+    Grid grid_;                     // Grid layout
+    std::vector<uint32_t> indices_; // Sorted shell voxel indices
+    std::vector<uint8_t> faces_;    // Exposed faces per shell voxel
+};
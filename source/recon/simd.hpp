@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+ * AVX2 kernels are compiled per function with SIMD_TARGET_AVX2 next to their scalar loops, so the rest
+ * of the binary stays at the baseline instruction set. Callers pick a kernel with cpu_has_avx2() at run
+ * time and fall back to the scalar loop on CPUs without AVX2 and FMA.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(VOLREC_AVX2) || defined(__AVX2__)
+#define SIMD_AVX2 1
+#endif
+#endif
+
+#if defined(SIMD_AVX2)
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+
+/** @brief Check whether the AVX2 kernels are built and the CPU runs them. */
+inline bool cpu_has_avx2() {
+#if !defined(SIMD_AVX2)
+    return false;
+#elif defined(__AVX2__) && defined(__FMA__)
+    return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    // AVX2 and FMA need the CPU flags and the OS saving the YMM registers (XCR0 bits 1 and 2)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool fma = (info[2] >> 12) & 1;
+        const bool osxsave = (info[2] >> 27) & 1;
+        if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return ((info[1] >> 5) & 1) != 0;
+    }();
+    return supported;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#endif
+}
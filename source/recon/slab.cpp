@@ -0,0 +1,142 @@
+#include "slab.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+
+#include "carver.hpp"
+
+
+// Number of coarse voxels along the longest grid axis in the balancing pre-pass
+constexpr const int SLAB_PREPASS_RESOLUTION = 32;
+
+// Cost of an empty coarse cell relative to an occupied one
+constexpr const double SLAB_EMPTY_COST = 0.1;
+
+// Slab file signature and format version
+constexpr const uint32_t SLAB_MAGIC = 0x42534c56; // "VLSB"
+constexpr const uint32_t SLAB_VERSION = 1;
+
+
+/* Types */
+
+/** @brief Fixed-size header of a slab file. */
+struct SlabHeader {
+    uint32_t magic = SLAB_MAGIC;    // File signature
+    uint32_t version = SLAB_VERSION; // Format version
+    int32_t num_x = 0;              // Full grid size X
+    int32_t num_y = 0;              // Full grid size Y
+    int32_t num_z = 0;              // Full grid size Z
+    float voxel_size = 0.0f;        // Voxel size in mm
+    float origin[3] = {};           // Full grid origin
+    int32_t z_begin = 0;            // First layer of the slab
+    int32_t z_end = 0;              // One past the last layer of the slab
+    int32_t words_per_row = 0;      // Occupancy words per row
+};
+
+
+/* Functions */
+
+std::vector<int> balance_slabs(const std::vector<View>& views, const Grid& grid, int num_slabs) {
+    num_slabs = std::clamp(num_slabs, 1, std::max(grid.num_z, 1));
+
+    const glm::vec3 extent = grid.extent();
+    const float coarse_size = std::max(grid.voxel_size, std::max({ extent.x, extent.y, extent.z }) / SLAB_PREPASS_RESOLUTION);
+
+    // Coarse cubes tile the grid extent, as in the hull bounds pre-pass
+    Grid coarse = Grid::from_extent(grid.origin, grid.origin + extent, coarse_size);
+    coarse.origin += glm::vec3(coarse_size * 0.5f);
+
+    Carver carver;
+    carver.set_strategy(CarveStrategy::FOOTPRINT);
+
+    OccupancyGrid occupancy;
+    carver.carve(views, coarse, occupancy);
+
+    std::vector<double> layer_cost(coarse.num_z, SLAB_EMPTY_COST * coarse.num_x * coarse.num_y);
+    occupancy.for_each([&](int, int, int z) {
+        layer_cost[z] += 1.0 - SLAB_EMPTY_COST;
+    });
+
+    // Estimated cost of every fine layer, from the coarse layer containing it
+    std::vector<double> prefix(grid.num_z + 1, 0.0);
+    for (int z = 0; z < grid.num_z; ++z) {
+        const int layer = std::clamp(static_cast<int>(std::floor(z * grid.voxel_size / coarse_size)), 0, coarse.num_z - 1);
+        prefix[z + 1] = prefix[z] + layer_cost[layer];
+    }
+
+    // Cut at equal cost quantiles, leaving at least one layer per slab
+    std::vector<int> bounds(num_slabs + 1, 0);
+    bounds[num_slabs] = grid.num_z;
+    for (int s = 1; s < num_slabs; ++s) {
+        const double target = prefix[grid.num_z] * s / num_slabs;
+        int z = static_cast<int>(std::lower_bound(prefix.begin(), prefix.end(), target) - prefix.begin());
+        bounds[s] = std::clamp(z, bounds[s - 1] + 1, grid.num_z - (num_slabs - s));
+    }
+
+    return bounds;
+}
+
+Grid slab_grid(const Grid& grid, int z_begin, int z_end) {
+    return grid.subgrid(glm::ivec3(0, 0, z_begin), glm::ivec3(grid.num_x, grid.num_y, z_end));
+}
+
+bool write_slab(const std::filesystem::path& file, const Grid& grid, int z_begin, const OccupancyGrid& slab) {
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream) {
+        std::cerr << "Could not open slab file: " << file << std::endl;
+        return false;
+    }
+
+    const Grid& layout = slab.grid();
+    SlabHeader header;
+    header.num_x = grid.num_x;
+    header.num_y = grid.num_y;
+    header.num_z = grid.num_z;
+    header.voxel_size = grid.voxel_size;
+    header.origin[0] = grid.origin.x;
+    header.origin[1] = grid.origin.y;
+    header.origin[2] = grid.origin.z;
+    header.z_begin = z_begin;
+    header.z_end = z_begin + layout.num_z;
+    header.words_per_row = slab.words_per_row();
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Rows are contiguous in grid order
+    const size_t words = layout.row_count() * slab.words_per_row();
+    if (words > 0) {
+        stream.write(reinterpret_cast<const char*>(slab.row(0, 0)), static_cast<std::streamsize>(words * sizeof(uint64_t)));
+    }
+    return static_cast<bool>(stream);
+}
+
+bool merge_slab(const std::filesystem::path& file, OccupancyGrid& occupancy) {
+    std::ifstream stream(file, std::ios::binary);
+    SlabHeader header;
+    if (!stream || !stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Could not read slab file: " << file << std::endl;
+        return false;
+    }
+
+    const Grid& grid = occupancy.grid();
+    const bool same_grid = header.num_x == grid.num_x && header.num_y == grid.num_y && header.num_z == grid.num_z &&
+        header.voxel_size == grid.voxel_size && header.origin[0] == grid.origin.x && header.origin[1] == grid.origin.y &&
+        header.origin[2] == grid.origin.z && header.words_per_row == occupancy.words_per_row();
+
+    if (header.magic != SLAB_MAGIC || header.version != SLAB_VERSION || !same_grid ||
+        header.z_begin < 0 || header.z_end > grid.num_z || header.z_begin >= header.z_end) {
+        std::cerr << "Slab file does not match the grid: " << file << std::endl;
+        return false;
+    }
+
+    const size_t words = static_cast<size_t>(header.z_end - header.z_begin) * grid.num_y * occupancy.words_per_row();
+    if (!stream.read(reinterpret_cast<char*>(occupancy.row(0, header.z_begin)), static_cast<std::streamsize>(words * sizeof(uint64_t)))) {
+        std::cerr << "Slab file is truncated: " << file << std::endl;
+        return false;
+    }
+    return true;
+}
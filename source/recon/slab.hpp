@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <filesystem>
+
+#include "grid.hpp"
+#include "view.hpp"
+#include "occupancy.hpp"
+
+
+/**
+ * @brief Split the Z layers of a grid into slabs of about equal carve work.
+ *
+ * A coarse footprint pre-pass estimates the occupied cells per layer; occupied voxels cost a test
+ * against every view while empty ones are mostly rejected by the first view, so slabs are cut at
+ * equal quantiles of the estimated cost rather than at equal heights. Subjects standing on the
+ * floor get thin slabs near the floor and tall ones above.
+ *
+ * @param views Calibrated views with masks.
+ * @param grid Grid to partition (usually the carve bounds).
+ * @param num_slabs Number of slabs (clamped to 1..num_z).
+ * @return Slab boundaries: num_slabs + 1 increasing Z layers from 0 to grid.num_z.
+ */
+std::vector<int> balance_slabs(const std::vector<View>& views, const Grid& grid, int num_slabs);
+
+/**
+ * @brief Get the subgrid of a Z slab.
+ * @param grid Full grid.
+ * @param z_begin First layer of the slab.
+ * @param z_end One past the last layer of the slab.
+ * @return Subgrid whose samples coincide with those of the grid.
+ */
+Grid slab_grid(const Grid& grid, int z_begin, int z_end);
+
+/**
+ * @brief Write the occupancy of a slab to a binary file.
+ *
+ * The file holds the full grid layout, the slab range and the occupancy words, so a merge can check
+ * that coordinator and worker agree on the grid.
+ *
+ * @param file Output file.
+ * @param grid Full grid the slab belongs to.
+ * @param z_begin First layer of the slab.
+ * @param slab Occupancy of the slab, laid out as slab_grid(grid, z_begin, ...).
+ * @return True if the file was written.
+ */
+bool write_slab(const std::filesystem::path& file, const Grid& grid, int z_begin, const OccupancyGrid& slab);
+
+/**
+ * @brief Merge a slab file into the occupancy of the full grid.
+ * @param file Slab file written by write_slab.
+ * @param occupancy Occupancy of the full grid; the slab layers are overwritten.
+ * @return False if the file is unreadable or was written for a different grid.
+ */
+bool merge_slab(const std::filesystem::path& file, OccupancyGrid& occupancy);
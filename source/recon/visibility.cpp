@@ -0,0 +1,267 @@
+#include "visibility.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <omp.h>
+
+#include "shell.hpp"
+
+
+// Image bands per thread when rasterizing, for load balance
+constexpr const int RASTER_BANDS_PER_THREAD = 4;
+
+// Cube corners (bit 0 = +X, bit 1 = +Y, bit 2 = +Z) of every face, in SHELL_FACE_* bit order
+constexpr const int FACE_CORNERS[6][4] = {
+    { 0, 2, 6, 4 },     // -X
+    { 1, 3, 7, 5 },     // +X
+    { 0, 1, 5, 4 },     // -Y
+    { 2, 3, 7, 6 },     // +Y
+    { 0, 1, 3, 2 },     // -Z
+    { 4, 5, 7, 6 },     // +Z
+};
+
+
+/* Functions */
+
+/** @brief Check whether a projected pixel is finite (the point is in front of the camera). */
+static bool is_finite(const cv::Point2f& p) {
+    return std::isfinite(p.x) && std::isfinite(p.y);
+}
+
+
+/* Public methods */
+
+void VisibilityBuffer::render(const View& view, const Grid& grid, const std::vector<uint32_t>& indices, const std::vector<uint8_t>* faces) {
+    const PinholeModel& model = view.pinhole;
+    const int count = static_cast<int>(indices.size());
+    const bool face_mode = mode_ == SplatMode::FACES && faces && faces->size() == indices.size();
+    const float ds = static_cast<float>(downsample_);
+    const float focal = std::max(model.fx, model.fy);
+    const float half = grid.voxel_size * 0.5f;
+    const glm::vec3 eye = model.center();
+
+    const int rows = (view.mask.rows + downsample_ - 1) / downsample_;
+    const int cols = (view.mask.cols + downsample_ - 1) / downsample_;
+    const cv::Rect image(0, 0, cols, rows);
+
+    depth_.create(rows, cols, CV_32F);
+    depth_.setTo(std::numeric_limits<float>::max());
+    ids_.create(rows, cols, CV_32S);
+    ids_.setTo(VISIBILITY_EMPTY);
+
+    pixels_.resize(count);
+    depths_.resize(count);
+    bounds_.resize(count);
+    front_.assign(face_mode ? count : 0, 0);
+    corners_.resize(face_mode ? static_cast<size_t>(count) * 8 : 0);
+    corner_depths_.resize(corners_.size());
+
+    // Buffer pixel centers sit at integer coordinates; image pixel u maps to (u + 0.5) / ds - 0.5
+    auto to_buffer = [ds](const cv::Point2f& p) {
+        return cv::Point2f((p.x + 0.5f) / ds - 0.5f, (p.y + 0.5f) / ds - 0.5f);
+    };
+
+    // Project every voxel and compute its footprint in the buffer
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < count; ++i) {
+        const glm::vec3 position = grid.position(grid.coordinates(indices[i]));
+        pixels_[i] = model.project(position);
+        depths_[i] = model.to_camera(position).z;
+        bounds_[i] = cv::Rect();
+
+        if (!is_finite(pixels_[i])) {
+            continue;
+        }
+
+        const cv::Point2f center = to_buffer(pixels_[i]);
+        const int cx = static_cast<int>(std::floor(center.x + 0.5f));
+        const int cy = static_cast<int>(std::floor(center.y + 0.5f));
+        cv::Rect footprint(cx, cy, 1, 1);
+
+        if (!face_mode) {
+            const float radius = 0.5f * focal * grid.voxel_size / (depths_[i] * ds);
+            const int r = static_cast<int>(std::min(radius, static_cast<float>(std::max(rows, cols))));
+            footprint = cv::Rect(cx - r, cy - r, 2 * r + 1, 2 * r + 1);
+        }
+        else {
+            // Exposed faces whose outward normal points towards the camera
+            uint8_t front = 0;
+            for (int f = 0; f < 6; ++f) {
+                const float sign = (f & 1) ? 1.0f : -1.0f;
+                const int axis = f >> 1;
+                if ((((*faces)[i] >> f) & 1) && sign * (eye[axis] - position[axis]) > half) {
+                    front |= static_cast<uint8_t>(1 << f);
+                }
+            }
+
+            cv::Point2f* corners = &corners_[static_cast<size_t>(i) * 8];
+            float* corner_depths = &corner_depths_[static_cast<size_t>(i) * 8];
+            bool valid = true;
+            for (int c = 0; c < 8 && front; ++c) {
+                const glm::vec3 corner = position + glm::vec3((c & 1) ? half : -half, (c & 2) ? half : -half, (c & 4) ? half : -half);
+                const cv::Point2f p = model.project(corner);
+                valid = valid && is_finite(p);
+                corners[c] = to_buffer(p);
+                corner_depths[c] = model.to_camera(corner).z;
+            }
+
+            // Voxels straddling the camera plane are reduced to their center point
+            front_[i] = valid ? front : 0;
+            for (int c = 0; c < 8 && front_[i]; ++c) {
+                footprint |= cv::Rect(static_cast<int>(std::floor(corners[c].x)), static_cast<int>(std::floor(corners[c].y)), 2, 2);
+            }
+        }
+
+        bounds_[i] = footprint & image;
+    }
+
+    // Bucket the voxels by every image band their footprint touches, so each band is written by one thread only
+    const int target_bands = std::max(1, omp_get_max_threads() * RASTER_BANDS_PER_THREAD);
+    const int band_height = std::max(1, (rows + target_bands - 1) / target_bands);
+    const int num_bands = (rows + band_height - 1) / band_height;
+
+    std::vector<size_t> offsets(num_bands + 1, 0);
+    for (int i = 0; i < count; ++i) {
+        if (bounds_[i].empty()) {
+            continue;
+        }
+        const int first = bounds_[i].y / band_height;
+        const int last = (bounds_[i].y + bounds_[i].height - 1) / band_height;
+        for (int b = first; b <= last; ++b) {
+            offsets[b + 1]++;
+        }
+    }
+    for (int b = 0; b < num_bands; ++b) {
+        offsets[b + 1] += offsets[b];
+    }
+
+    std::vector<int> order(offsets[num_bands]);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        if (bounds_[i].empty()) {
+            continue;
+        }
+        const int first = bounds_[i].y / band_height;
+        const int last = (bounds_[i].y + bounds_[i].height - 1) / band_height;
+        for (int b = first; b <= last; ++b) {
+            order[fill[b]++] = i;
+        }
+    }
+
+    // Buckets keep index order, so ties resolve the same way for any thread count
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int b = 0; b < num_bands; ++b) {
+        const int y_begin = b * band_height;
+        const int y_end = std::min(rows, y_begin + band_height);
+
+        for (size_t k = offsets[b]; k < offsets[b + 1]; ++k) {
+            if (face_mode) {
+                splat_faces(order[k], y_begin, y_end);
+            }
+            else {
+                splat_voxel(order[k], y_begin, y_end);
+            }
+        }
+    }
+}
+
+void VisibilityBuffer::clear() {
+    depth_.release();
+    ids_.release();
+    pixels_.clear();
+    depths_.clear();
+    bounds_.clear();
+    front_.clear();
+    corners_.clear();
+    corner_depths_.clear();
+}
+
+
+/* Getters */
+
+bool VisibilityBuffer::is_visible(int i, float slack) const {
+    if (bounds_[i].empty()) {
+        return false;
+    }
+
+    const float ds = static_cast<float>(downsample_);
+    const int px = static_cast<int>(std::floor((pixels_[i].x + 0.5f) / ds));
+    const int py = static_cast<int>(std::floor((pixels_[i].y + 0.5f) / ds));
+    if (px < 0 || py < 0 || px >= depth_.cols || py >= depth_.rows) {
+        return false;
+    }
+
+    return depths_[i] <= depth_.at<float>(py, px) + slack;
+}
+
+
+/* Private methods */
+
+void VisibilityBuffer::splat_voxel(int i, int y_begin, int y_end) {
+    const cv::Rect& r = bounds_[i];
+    const float depth = depths_[i];
+
+    for (int y = std::max(r.y, y_begin); y < std::min(r.y + r.height, y_end); ++y) {
+        for (int x = r.x; x < r.x + r.width; ++x) {
+            write(i, x, y, depth);
+        }
+    }
+}
+
+void VisibilityBuffer::splat_faces(int i, int y_begin, int y_end) {
+    const uint8_t front = front_[i];
+
+    for (int f = 0; f < 6; ++f) {
+        if ((front >> f) & 1) {
+            const int* c = FACE_CORNERS[f];
+            splat_triangle(i, c[0], c[1], c[2], y_begin, y_end);
+            splat_triangle(i, c[0], c[2], c[3], y_begin, y_end);
+        }
+    }
+
+    // Faces smaller than a buffer pixel can miss every pixel center; the voxel center always covers its own pixel
+    const float ds = static_cast<float>(downsample_);
+    const int cx = static_cast<int>(std::floor((pixels_[i].x + 0.5f) / ds));
+    const int cy = static_cast<int>(std::floor((pixels_[i].y + 0.5f) / ds));
+    if (cy >= y_begin && cy < y_end && cx >= 0 && cx < depth_.cols) {
+        write(i, cx, cy, depths_[i]);
+    }
+}
+
+void VisibilityBuffer::splat_triangle(int i, int a, int b, int c, int y_begin, int y_end) {
+    const cv::Point2f* corners = &corners_[static_cast<size_t>(i) * 8];
+    const float* corner_depths = &corner_depths_[static_cast<size_t>(i) * 8];
+    const cv::Point2f& pa = corners[a];
+    const cv::Point2f& pb = corners[b];
+    const cv::Point2f& pc = corners[c];
+
+    const float area = (pb.x - pa.x) * (pc.y - pa.y) - (pb.y - pa.y) * (pc.x - pa.x);
+    if (std::abs(area) < 1e-12f) {
+        return;
+    }
+
+    // Screen-space barycentrics interpolate 1/z linearly under perspective projection
+    const float inv_area = 1.0f / area;
+    const float wa = 1.0f / corner_depths[a];
+    const float wb = 1.0f / corner_depths[b];
+    const float wc = 1.0f / corner_depths[c];
+
+    const int x_min = std::max(static_cast<int>(std::ceil(std::min({ pa.x, pb.x, pc.x }))), 0);
+    const int x_max = std::min(static_cast<int>(std::floor(std::max({ pa.x, pb.x, pc.x }))), depth_.cols - 1);
+    const int y_min = std::max(static_cast<int>(std::ceil(std::min({ pa.y, pb.y, pc.y }))), y_begin);
+    const int y_max = std::min(static_cast<int>(std::floor(std::max({ pa.y, pb.y, pc.y }))), y_end - 1);
+
+    for (int y = y_min; y <= y_max; ++y) {
+        for (int x = x_min; x <= x_max; ++x) {
+            const float la = ((pb.x - x) * (pc.y - y) - (pb.y - y) * (pc.x - x)) * inv_area;
+            const float lb = ((pc.x - x) * (pa.y - y) - (pc.y - y) * (pa.x - x)) * inv_area;
+            const float lc = 1.0f - la - lb;
+            if (la < 0.0f || lb < 0.0f || lc < 0.0f) {
+                continue;
+            }
+            write(i, x, y, 1.0f / (la * wa + lb * wb + lc * wc));
+        }
+    }
+}
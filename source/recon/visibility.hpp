@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "grid.hpp"
+#include "view.hpp"
+
+
+// Voxel ID of buffer pixels no voxel covers
+constexpr const int VISIBILITY_EMPTY = -1;
+
+
+/**
+ * @enum SplatMode
+ * @brief Selects the primitives rasterized per voxel.
+ *
+ * - VOXELS: One square per voxel, sized to the projected voxel width, at the depth of its center
+ * - FACES: The exposed, front-facing faces of every voxel as quads with interpolated depth
+ */
+enum class SplatMode {
+    VOXELS,
+    FACES
+};
+
+
+/**
+ * @class VisibilityBuffer
+ * @brief Software rasterizer of voxels into the depth and voxel-ID buffer of one view.
+ *
+ * Runs on the CPU without a GL context. Voxels are projected in parallel through the view's pinhole
+ * model, then bucketed by the image bands their footprints touch; every band is rasterized by one
+ * thread, so buffer writes need no synchronization. The buffer can be rendered at a fraction of the
+ * image resolution.
+ */
+class VisibilityBuffer {
+public: // Methods
+    /**
+     * @brief Rasterize voxels into the buffer of a view.
+     * @param view Calibrated view; its mask size gives the image size.
+     * @param grid Grid layout of the voxel indices.
+     * @param indices Linear voxel indices (X fastest), e.g. all occupied voxels or a surface shell.
+     * @param faces Exposed-face mask (SHELL_FACE_* bits) per voxel, parallel to indices; without it FACES renders as VOXELS.
+     */
+    void render(const View& view, const Grid& grid, const std::vector<uint32_t>& indices, const std::vector<uint8_t>* faces);
+
+    /**
+     * @brief Select the rasterized primitives.
+     * @param mode Splat mode for subsequent renders.
+     */
+    void set_mode(SplatMode mode) { mode_ = mode; }
+
+    /**
+     * @brief Set the downsample factor of the buffer.
+     * @param downsample Image pixels per buffer pixel along each axis (at least 1).
+     */
+    void set_downsample(int downsample) { downsample_ = std::max(downsample, 1); }
+
+    /** @brief Release the buffers. */
+    void clear();
+
+public: // Getters
+    /**
+     * @brief Check whether a voxel of the last render is frontmost at its projected center.
+     * @param i Position of the voxel in the rendered index list.
+     * @param slack Depth tolerance in millimeters.
+     * @return True if no other voxel lies more than slack in front of it.
+     */
+    bool is_visible(int i, float slack) const;
+
+    /** @brief Get the image pixel (full resolution) of the center of voxel i of the last render (NaN if behind the camera). */
+    const cv::Point2f& pixel(int i) const { return pixels_[i]; }
+
+    /** @brief Get the camera depth of the center of voxel i of the last render. */
+    float voxel_depth(int i) const { return depths_[i]; }
+
+    /** @brief Get the depth buffer (CV_32F, camera depth in mm, FLT_MAX where empty). */
+    const cv::Mat& depth() const { return depth_; }
+
+    /** @brief Get the voxel-ID buffer (CV_32S, position in the rendered index list, VISIBILITY_EMPTY where empty). */
+    const cv::Mat& ids() const { return ids_; }
+
+    /** @brief Get the splat mode. */
+    SplatMode mode() const { return mode_; }
+
+    /** @brief Get the downsample factor. */
+    int downsample() const { return downsample_; }
+
+    /** @brief Get the memory used by the buffers in bytes. */
+    size_t memory_bytes() const { return depth_.total() * depth_.elemSize() + ids_.total() * ids_.elemSize(); }
+
+private: // Methods
+    /** @brief Rasterize a square splat of voxel i into rows [y_begin, y_end). */
+    void splat_voxel(int i, int y_begin, int y_end);
+
+    /** @brief Rasterize the front-facing exposed faces of voxel i into rows [y_begin, y_end). */
+    void splat_faces(int i, int y_begin, int y_end);
+
+    /** @brief Keep a depth at buffer pixel (x, y) if it is nearer than the stored one. */
+    void write(int i, int x, int y, float depth) {
+        float& stored = depth_.at<float>(y, x);
+        if (depth < stored) {
+            stored = depth;
+            ids_.at<int>(y, x) = i;
+        }
+    }
+
+    /** @brief Rasterize the triangle of cube corners (a, b, c) of voxel i with perspective-correct depth into rows [y_begin, y_end). */
+    void splat_triangle(int i, int a, int b, int c, int y_begin, int y_end);
+
+private: // Variables
+    SplatMode mode_ = SplatMode::VOXELS;    // Rasterized primitives
+    int downsample_ = 1;                    // Image pixels per buffer pixel
+    cv::Mat depth_;                         // Depth buffer, CV_32F
+    cv::Mat ids_;                           // Voxel-ID buffer, CV_32S
+    std::vector<cv::Point2f> pixels_;       // Image pixel of every voxel center
+    std::vector<float> depths_;             // Camera depth of every voxel center
+    std::vector<cv::Rect> bounds_;          // Buffer footprint of every voxel (empty if culled)
+    std::vector<uint8_t> front_;            // Front-facing exposed faces per voxel (FACES only)
+    std::vector<cv::Point2f> corners_;      // Buffer pixels of the 8 cube corners per voxel (FACES only)
+    std::vector<float> corner_depths_;      // Camera depth of the 8 cube corners per voxel (FACES only)
+};
@@ -15,6 +15,7 @@ enum class ShaderType {
     LINES,      /**< Line rendering shader */
     POINTS,     /**< Point rendering shader */
     VOXELS,     /**< Voxel rendering shader */
+    MESH,       /**< Lit triangle mesh shader */
     OVERLAY     /**< Overlay rendering shader */
 };
 
@@ -18,6 +18,7 @@
 #include "global.hpp"
 
 #include "model/box.hpp"
+#include "model/hull.hpp"
 #include "model/floor.hpp"
 #include "model/frame.hpp"
 #include "model/model.hpp"
@@ -160,9 +161,14 @@ void Renderer::render() {
         render_checkers();
     }
 
-    // Draw the volume (will write proper depth values)
+    // Draw the volume, or the hull mesh of polyhedral reconstructions (will write proper depth values)
     if (show_volume_) {
-        render_volume();
+        if (scene_->hull()) {
+            render_hull();
+        }
+        else {
+            render_volume();
+        }
     }
     
     // Draw the world axes (after volume, should be properly occluded by depth testing)
@@ -253,6 +259,16 @@ bool Renderer::initialize_shaders() {
         success = false;
     }
 
+    // Load lit mesh shader
+    auto mesh_shader = std::make_shared<Shader>();
+    if (mesh_shader->load_from_file(shader_path("shaders/mesh.vert"), shader_path("shaders/mesh.frag"))) {
+        shaders_[ShaderType::MESH] = mesh_shader;
+    }
+    else {
+        std::cerr << "Failed to load mesh shader" << std::endl;
+        success = false;
+    }
+
     // Load image overlay shader
     auto overlay_shader = std::make_shared<Shader>();
     if (overlay_shader->load_from_file(shader_path("shaders/overlay.vert"), shader_path("shaders/overlay.frag"))) {
@@ -480,7 +496,7 @@ void Renderer::render_volume() const {
             shader->set_uniform("mvp_matrix", mvp);
             shader->set_uniform("model_matrix", volume->transform());
             shader->set_uniform("point_size", 2.0f); // Reasonable base size multiplier
-            shader->set_uniform("voxel_size", static_cast<float>(VOLUME_VOXEL_SIZE)); // Actual voxel size from global constants
+            shader->set_uniform("voxel_size", volume->voxel_size()); // Actual voxel size of the reconstruction grid
             
             // Use volume's modern OpenGL rendering
             volume->bind();
@@ -536,6 +552,36 @@ void Renderer::render_volume() const {
     }
 }
 
+void Renderer::render_hull() const {
+    auto hull = scene_->hull();
+    if (!hull || !hull->is_visible() || !hull->is_ready_to_render()) { return; }
+
+    auto shader = get_shader(ShaderType::MESH);
+    if (!shader || !shader->is_valid()) { return; }
+
+    shader->use();
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+
+    shader->set_uniform("mvp_matrix", mvp_matrix());
+    shader->set_uniform("model_matrix", hull->transform());
+    shader->set_uniform("normal_matrix", glm::transpose(glm::inverse(hull->transform())));
+    shader->set_uniform("model_color", hull->color());
+
+    for (const auto& mesh : hull->meshes()) {
+        if (mesh) {
+            mesh->bind();
+            draw_mesh(*mesh);
+            mesh->unbind();
+        }
+    }
+
+    shader->unuse();
+}
+
 void Renderer::render_checkers() const {
     auto checkers = scene_->checkers();
     if (!checkers || !checkers->is_ready_to_render()) { return; }
@@ -148,6 +148,9 @@ private: // Methods
     /** @brief Render the volume. */
     void render_volume() const;
 
+    /** @brief Render the hull mesh of a polyhedral reconstruction. */
+    void render_hull() const;
+
     /** @brief Render the checker board. */
     void render_checkers() const;
 
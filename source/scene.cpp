@@ -1,7 +1,9 @@
 #include "scene.hpp"
 
+#include <cmath>
 #include <limits>
 #include <fstream>
+#include <algorithm>
 #include <iostream>
 
 #include <omp.h>
@@ -15,24 +17,107 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "model/box.hpp"
+#include "model/hull.hpp"
 #include "model/floor.hpp"
 #include "model/frame.hpp"
 #include "model/volume.hpp"
 #include "model/frustum.hpp"
 #include "model/checkers.hpp"
+#include "recon/bounds.hpp"
+
+
+// Color assigned to carved voxels
+constexpr const glm::vec4 CARVED_VOXEL_COLOR(0.8f, 0.3f, 0.2f, 0.9f);
+
+// Number of grid divisions of the floor
+constexpr const int FLOOR_DIVISIONS = 4;
 
 
 /* Public methods */
 
 void Scene::load_project(std::shared_ptr<Project> project) {
+    project_ = project;
+    grid_ = project->grid;
+    tight_bounds_ = project->tight_bounds;
+
     create_box();
     create_floor();
     create_frame();
     create_checkers(project->chess_rows, project->chess_cols, project->square_size);
     create_frustums(project->views);
+
+    carver_.set_strategy(project->strategy);
+    carver_.set_min_views(project->min_views);
+    colorer_.set_consistency_threshold(project->photo_threshold);
+    colorer_.set_visibility_downsample(project->visibility_downsample);
     create_volume(project->views);
 }
 
+bool Scene::set_min_views(int min_views) {
+    if (!volume_ || !carver_.extract(min_views, occupancy_)) {
+        return false;
+    }
+
+    update_volume();
+    if (verbose_) {
+        carver_.stats().print();
+    }
+    return true;
+}
+
+bool Scene::update_view_mask(int view_index, const cv::Mat& mask) {
+    if (!project_ || view_index < 0 || view_index >= static_cast<int>(project_->views.size())) {
+        return false;
+    }
+
+    std::vector<View>& views = project_->views;
+    views[view_index].mask = mask;
+
+    // Consensus carves always span the full grid, so a mask edit cannot move their bounds
+    if (volume_ && !bricked_ && occupancy_.grid() == grid_ && carver_.update_view(views, view_index, occupancy_)) {
+        update_volume();
+        if (verbose_) {
+            carver_.stats().print();
+        }
+        return true;
+    }
+
+    create_volume(views);
+    return true;
+}
+
+void Scene::update_frame() {
+    if (!project_) {
+        return;
+    }
+
+    const Grid& carve_grid = occupancy_.grid();
+    const int margin = static_cast<int>(std::ceil(project_->motion_margin / carve_grid.voxel_size));
+
+    if (volume_ && !bricked_ && carver_.carve_band(project_->views, std::max(margin, 1), !(carve_grid == grid_), occupancy_)) {
+        update_volume();
+        if (verbose_) {
+            carver_.stats().print();
+        }
+        return;
+    }
+
+    // Polyhedral and footprint carves are never seeded, so only report rejected seeds
+    const bool seeded = carver_.strategy() != CarveStrategy::POLYHEDRAL && carver_.strategy() != CarveStrategy::FOOTPRINT;
+    if (verbose_ && !bricked_ && seeded) {
+        std::cout << "Sequence seed rejected, carving the full frame" << std::endl;
+    }
+    create_volume(project_->views);
+}
+
+void Scene::set_shell_only(bool shell_only) {
+    shell_only_ = shell_only;
+
+    if (volume_) {
+        volume_->set_render_source(shell_only_ ? VolumeRenderSource::SHELL : VolumeRenderSource::ALL);
+    }
+}
+
 void Scene::unload_project() {
     // Reset all models
     box_.reset();
@@ -41,6 +126,16 @@ void Scene::unload_project() {
     checkers_.reset();
     frustums_.clear();
     volume_.reset();
+    hull_.reset();
+    carver_.reset();
+    occupancy_ = OccupancyGrid();
+    bricks_.close();
+    bricked_ = false;
+    shell_.clear();
+    colorer_.clear();
+    project_.reset();
+    grid_ = Grid();
+    tight_bounds_ = true;
 
     // Create empty default models
     create_box();
@@ -56,9 +151,11 @@ void Scene::unload_project() {
 void Scene::create_box() {
     box_ = std::make_shared<Box>();
 
-    // Configure box based on global constants
-    glm::vec3 box_size = glm::vec3(VOLUME_BOX_LENGTH * 2, VOLUME_BOX_LENGTH, VOLUME_BOX_LENGTH * 2);
-    glm::vec3 box_position = glm::vec3(0.0f, VOLUME_BOX_LENGTH * 0.5f, 0.0f); // Center it vertically
+    // Configure box to enclose the reconstruction grid (OpenCV X, Z, -Y become OpenGL X, Y, Z)
+    glm::vec3 extent = grid_.extent();
+    glm::vec3 center = grid_.origin + extent * 0.5f;
+    glm::vec3 box_size = glm::vec3(extent.x, extent.z, extent.y);
+    glm::vec3 box_position = glm::vec3(center.x, center.z, -center.y);
 
     box_->set_size(box_size);
     box_->set_position(box_position);
@@ -71,12 +168,13 @@ void Scene::create_box() {
 void Scene::create_floor() {
     floor_ = std::make_shared<Floor>();
 
-    // Configure floor based on global constants
-    int floor_size = VOLUME_BOX_LENGTH * 2;
-    int half_floor_edge = VOLUME_BOX_LENGTH / 2;;
+    // Floor is centered on the world origin and must cover the footprint of the grid
+    glm::vec3 min_corner = grid_.origin;
+    glm::vec3 max_corner = grid_.origin + grid_.extent();
+    float floor_size = 2.0f * std::max({ std::abs(min_corner.x), std::abs(max_corner.x), std::abs(min_corner.y), std::abs(max_corner.y) });
 
-    floor_->set_size(static_cast<float>(floor_size));
-    floor_->set_divisions(floor_size / half_floor_edge);
+    floor_->set_size(floor_size);
+    floor_->set_divisions(FLOOR_DIVISIONS);
     floor_->set_floor_color(glm::vec4(0.9f, 0.9f, 0.9f, 0.5f));
     floor_->initialize();
 }
@@ -119,85 +217,103 @@ void Scene::create_frustums(const std::vector<View>& views) {
 }
 
 void Scene::create_empty_volume() {
-    const int num_x = (VOLUME_BOX_LENGTH * 2) / VOLUME_VOXEL_SIZE;
-    const int num_y = (VOLUME_BOX_LENGTH * 2) / VOLUME_VOXEL_SIZE;
-    const int num_z = VOLUME_BOX_LENGTH / VOLUME_VOXEL_SIZE;
-
-    volume_ = std::make_shared<Volume>(num_x, num_y, num_z, static_cast<float>(VOLUME_VOXEL_SIZE));
-
-    const int total_voxels = num_x * num_y * num_z;
-    #pragma omp parallel for
-    for (int idx = 0; idx < total_voxels; ++idx) {
-        int xi = idx / (num_y * num_z);
-        int yi = (idx / num_z) % num_y;
-        int zi = idx % num_z;
-        volume_->set_voxel_active(xi, yi, zi, true);
-        volume_->set_voxel_color(xi, yi, zi, glm::vec4(0.8f, 0.3f, 0.2f, 0.9f));
-    }
+    volume_ = std::make_shared<Volume>(grid_.num_x, grid_.num_y, grid_.num_z, grid_.voxel_size, grid_.origin);
+    volume_->fill_rows([&](int, int, Voxel* row) {
+        for (int xi = 0; xi < grid_.num_x; ++xi) {
+            row[xi].active = true;
+            row[xi].color = CARVED_VOXEL_COLOR;
+        }
+    });
 
     volume_->initialize();
 }
 
 void Scene::create_volume(const std::vector<View>& views) {
-    auto voxel_visible = [](const View& view, const cv::Point3f& vox_pos) {
-        // Check if mask is empty
-        if (view.mask.empty()) {
-            return false;
-        }
+    // Only allocate and carve the part of the grid that can contain the hull
+    Grid carve_grid = carve_bounds(views, grid_, tight_bounds_, carver_.strategy());
 
-        // Project the 3D point into the image plane using OpenCV
-        std::vector<cv::Point2f> img_pts;
-        std::vector<cv::Point3f> obj_pts = {vox_pos};
-        cv::projectPoints(obj_pts, view.rvec, view.tvec_proj, view.intrinsic, view.distortion, img_pts);
+    if (verbose_ && !(carve_grid == grid_)) {
+        std::cout << "Hull bounds: " << carve_grid.num_x << "x" << carve_grid.num_y << "x" << carve_grid.num_z
+                  << " of " << grid_.num_x << "x" << grid_.num_y << "x" << grid_.num_z << " voxels" << std::endl;
+    }
 
-        // Check if the projected point is within the image bounds and on the mask
-        if (img_pts.empty()) {
-            return false;
+    // Grids whose carve and rendered voxels exceed the memory budget are carved out of core and shown downsampled to fit the budget
+    const bool polyhedral = carver_.strategy() == CarveStrategy::POLYHEDRAL;
+    const size_t in_core_bytes = carve_bytes(views, carve_grid, carver_.strategy()) + (polyhedral ? 0 : carve_grid.voxel_count() * sizeof(Voxel));
+    bricked_ = project_ && project_->memory_budget > 0 && in_core_bytes > project_->memory_budget;
+    if (bricked_) {
+        BrickStats stats;
+        bricks_.set_budget(project_->memory_budget);
+        if (!carve_bricks(carver_, views, carve_grid, project_->brick_dir, bricks_, stats)) {
+            std::cerr << "Failed to write brick store: " << project_->brick_dir.string() << std::endl;
+            occupancy_ = OccupancyGrid();
+            volume_.reset();
+            hull_.reset();
+            bricked_ = false;
+            return;
+        }
+        if (verbose_) {
+            stats.print();
         }
 
-        const auto& pt = img_pts[0];
-        int px = cvRound(pt.x);
-        int py = cvRound(pt.y);
-
-        if (px < 0 || px >= view.mask.cols || py < 0 || py >= view.mask.rows) {
-            return false;
+        // Coarsen until the preview occupancy and its rendered voxels fit within the budget
+        const auto preview_bytes = [&](int factor) {
+            Grid coarse = carve_grid;
+            coarse.num_x = (carve_grid.num_x + factor - 1) / factor;
+            coarse.num_y = (carve_grid.num_y + factor - 1) / factor;
+            coarse.num_z = (carve_grid.num_z + factor - 1) / factor;
+            return occupancy_bytes(coarse) + coarse.voxel_count() * sizeof(Voxel);
+        };
+        const int max_factor = std::max({ carve_grid.num_x, carve_grid.num_y, carve_grid.num_z });
+        int factor = 1;
+        while (factor < max_factor && preview_bytes(factor) > project_->memory_budget) {
+            ++factor;
+        }
+        occupancy_ = bricks_.downsample(factor);
+        carve_grid = occupancy_.grid();
+        if (verbose_) {
+            std::cout << "Preview: " << carve_grid.num_x << "x" << carve_grid.num_y << "x" << carve_grid.num_z
+                      << " voxels, " << factor << "x downsampled" << std::endl;
+        }
+    }
+    else {
+        carver_.carve(views, carve_grid, occupancy_);
+        if (verbose_) {
+            carver_.stats().print();
         }
-        return view.mask.at<uint8_t>(py, px) == std::numeric_limits<uint8_t>::max(); // 255
-    };
-
-    const int num_x = (VOLUME_BOX_LENGTH * 2) / VOLUME_VOXEL_SIZE;
-    const int num_y = (VOLUME_BOX_LENGTH * 2) / VOLUME_VOXEL_SIZE;
-    const int num_z = VOLUME_BOX_LENGTH / VOLUME_VOXEL_SIZE;
-    volume_ = std::make_shared<Volume>(num_x, num_y, num_z, static_cast<float>(VOLUME_VOXEL_SIZE));
-
-    std::vector<std::vector<cv::Point3i>> thread_voxels(omp_get_max_threads());
-
-#pragma omp parallel
-    {
-        auto& local_voxels = thread_voxels[omp_get_thread_num()];
-        
-#pragma omp for schedule(dynamic, 2) nowait
-        for (int idx = 0; idx < num_x * num_y * num_z; ++idx) {
-            int xi = idx / (num_y * num_z);
-            int yi = (idx / num_z) % num_y;
-            int zi = idx % num_z;
-            
-            // Calculate voxel position in OpenCV coordinates
-            int x = -VOLUME_BOX_LENGTH + xi * VOLUME_VOXEL_SIZE;
-            int y = -VOLUME_BOX_LENGTH + yi * VOLUME_VOXEL_SIZE;
-            int z = zi * VOLUME_VOXEL_SIZE;
-
-            bool all_visible = std::ranges::all_of(views, [&](const View& view) {
-                return voxel_visible(view, {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-            });
-
-            if (all_visible) {
-                local_voxels.emplace_back(x, z, -y);
-                volume_->set_voxel_active(xi, yi, zi, true);
-                volume_->set_voxel_color(xi, yi, zi, glm::vec4(0.8f, 0.3f, 0.2f, 0.9f));
-            }
+    }
+
+    // Polyhedral carves have no voxels and are shown as their hull mesh
+    hull_.reset();
+    if (polyhedral) {
+        volume_.reset();
+        if (!carver_.hull().empty()) {
+            hull_ = std::make_shared<Hull>(carver_.hull());
+            hull_->set_color(CARVED_VOXEL_COLOR);
+            hull_->initialize();
         }
+        return;
     }
 
+    volume_ = std::make_shared<Volume>(carve_grid.num_x, carve_grid.num_y, carve_grid.num_z, carve_grid.voxel_size, carve_grid.origin);
+    volume_->set_render_source(shell_only_ ? VolumeRenderSource::SHELL : VolumeRenderSource::ALL);
+    update_volume();
     volume_->initialize();
 }
+
+void Scene::update_volume() {
+    // Color before writing the volume: the photo hull may still carve surface voxels
+    shell_.build(occupancy_);
+    if (project_) {
+        colorer_.color(project_->views, occupancy_, shell_, CARVED_VOXEL_COLOR);
+        if (verbose_) {
+            colorer_.stats().print();
+        }
+    }
+
+    occupancy_.to_volume(*volume_, CARVED_VOXEL_COLOR);
+    volume_->set_shell(shell_.indices());
+    if (project_) {
+        volume_->assign_colors(shell_.indices(), colorer_.colors());
+    }
+}
@@ -10,11 +10,18 @@
 
 #include "view.hpp"
 #include "project.hpp"
+#include "recon/grid.hpp"
+#include "recon/carver.hpp"
+#include "recon/shell.hpp"
+#include "recon/brick.hpp"
+#include "recon/coloring.hpp"
+#include "recon/occupancy.hpp"
 
 
 
 class Box;
 class Floor;
+class Hull;
 class Frame;
 class Volume;
 class Frustum;
@@ -45,6 +52,45 @@ public:
 	/** @brief Unload the current project and reset the scene. */
 	void unload_project();
 
+	/**
+	 * @brief Re-extract the volume of a consensus carve for a new view count without re-carving.
+	 * @param min_views Number of views that must see a voxel; 0 or less requires all views.
+	 * @return False if the last carve was not a consensus carve.
+	 */
+	bool set_min_views(int min_views);
+
+	/**
+	 * @brief Replace the mask of one view and update the reconstruction.
+	 *
+	 * A consensus carve, which always spans the full grid, is updated incrementally from the changed
+	 * view alone; other carves are run again from all views.
+	 *
+	 * @param view_index Index of the view in the loaded project.
+	 * @param mask New foreground mask of the view.
+	 * @return False if no project is loaded or the view index is out of range.
+	 */
+	bool update_view_mask(int view_index, const cv::Mat& mask);
+
+	/**
+	 * @brief Update the reconstruction after the masks of all views changed to the next sequence frame.
+	 *
+	 * The carve is seeded by the current hull and only tests the band the subject can have moved
+	 * through within the project motion margin; a full carve is run when the seed is rejected.
+	 */
+	void update_frame();
+
+	/**
+	 * @brief Select whether only the surface shell of the carved volume is rendered.
+	 * @param shell_only True to render shell voxels only, false to render all occupied voxels.
+	 */
+	void set_shell_only(bool shell_only);
+
+	/**
+	 * @brief Select whether carve and coloring statistics are printed after every reconstruction update.
+	 * @param verbose True to print the statistics to standard output.
+	 */
+	void set_verbose(bool verbose) { verbose_ = verbose; }
+
 public: // Getters
 	/**
 	 * @brief Get the box model.
@@ -70,12 +116,45 @@ public: // Getters
 	 */
 	std::shared_ptr<Volume> volume() const { return volume_; }
 
+	/**
+	 * @brief Get the hull mesh model of a polyhedral reconstruction.
+	 * @return Shared pointer to Hull, or null for voxel reconstructions.
+	 */
+	std::shared_ptr<Hull> hull() const { return hull_; }
+
 	/**
 	 * @brief Get the checkers model.
 	 * @return Shared pointer to Checkers.
 	 */
 	std::shared_ptr<Checkers> checkers() const { return checkers_; }
 
+	/**
+	 * @brief Get the occupancy of the last reconstruction.
+	 * @return Bit-packed occupancy grid.
+	 */
+	const OccupancyGrid& occupancy() const { return occupancy_; }
+
+	/**
+	 * @brief Get the surface shell of the last reconstruction.
+	 * @return Occupied voxels with an empty 6-neighbor and their exposed faces.
+	 */
+	const SurfaceShell& shell() const { return shell_; }
+
+	/**
+	 * @brief Get the voxel colorer.
+	 * @return Colorer with the surface colors and statistics of the last reconstruction.
+	 */
+	const VoxelColorer& colorer() const { return colorer_; }
+
+	/** @brief Check whether only the surface shell is rendered. */
+	bool shell_only() const { return shell_only_; }
+
+	/**
+	 * @brief Get the voxel carver.
+	 * @return Carver with the statistics of the last carve.
+	 */
+	const Carver& carver() const { return carver_; }
+
 	/**
 	 * @brief Get the camera frustums.
 	 * @return Vector of shared pointers to Frustum.
@@ -104,11 +183,27 @@ private:
 	/** @brief Create the volume model for the given views. */
 	void create_volume(const std::vector<View>& views);
 
+	/** @brief Color the surface of the occupancy and write both into the volume. */
+	void update_volume();
+
 private:
 	std::shared_ptr<Box> box_;
 	std::shared_ptr<Floor> floor_;
 	std::shared_ptr<Frame> frame_;
 	std::shared_ptr<Volume> volume_;
+	std::shared_ptr<Hull> hull_;
 	std::shared_ptr<Checkers> checkers_;
 	std::vector<std::shared_ptr<Frustum>> frustums_;
+
+	std::shared_ptr<Project> project_;	// Loaded project, or null
+	Grid grid_;			// Reconstruction grid
+	bool tight_bounds_ = true;	// Carve only the part of the grid that can contain the hull
+	Carver carver_;		// Visual hull carver with cached projection tables
+	OccupancyGrid occupancy_;	// Bit-packed result of the last carve
+	SurfaceShell shell_;		// Surface voxels of the last carve
+	VoxelColorer colorer_;		// Surface colors from the foreground images
+	bool shell_only_ = false;	// Render only the surface shell
+	bool verbose_ = false;		// Print carve and coloring statistics after every update
+	BrickStore bricks_;		// Out-of-core carve, paged in for the downsampled preview
+	bool bricked_ = false;		// Whether the last carve exceeded the memory budget
 };
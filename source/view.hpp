@@ -1,10 +1,15 @@
 #pragma once
 
+#include <memory>
+#include <vector>
 #include <filesystem>
 
 #include <glm/glm.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "recon/pinhole.hpp"
+#include "recon/background.hpp"
+
 
 constexpr const float DEFAULT_CAM_DIST = 2000.0f;
 
@@ -37,8 +42,13 @@ constexpr const float DEFAULT_FAR = 10000.0f;
  * - forward, upward, right: Derived orientation vectors
  * - proj: Projection matrix
  * - intrinsic, distortion, rvec, tvec, tvec_proj, focal_length, principal_point: Calibration matrices
+ * - pinhole: Single-precision projection model for batch projection
  * - fg, bg, mask: Foreground, background, and mask images
+ * - mask_roi: Image region the reconstruction grid projects into; masks are background outside it
+ * - background: Gaussian background model segmenting the masks (null for difference masks)
  * - bg_path, fg_path, cb_path: Paths to image and calibration files
+ * - bg_frame_paths: Additional background frames the background model learns from
+ * - frame_paths: Foreground image paths of the frames of a capture sequence (empty for single captures)
  */
 struct View {
     // OpenGL rendering data
@@ -64,14 +74,19 @@ struct View {
     cv::Mat tvec_proj = cv::Mat::zeros(3, 1, CV_64F);               // Precomputed translation vector for projection
     cv::Mat focal_length = cv::Mat::zeros(2, 1, CV_64F);            // Focal length (fx, fy) as 2x1 double matrix
     cv::Mat principal_point = cv::Mat::zeros(2, 1, CV_64F);         // Principal point (cx, cy) as 2x1 double matrix
+    PinholeModel pinhole;                                           // Float projection model derived from the matrices above
     
     // Background, foreground, mask images
     cv::Mat fg;                                                     // Foreground image
     cv::Mat bg;                                                     // Background image
     cv::Mat mask;                                                   // Mask image
+    cv::Rect mask_roi;                                              // Segmented region of the mask
+    std::shared_ptr<const BackgroundModel> background;              // Background model of Gaussian masks
 
     // Paths for background, foreground, and calibration files
     std::filesystem::path bg_path;                                  // Background image path
     std::filesystem::path fg_path;                                  // Foreground image path
     std::filesystem::path cb_path;                                  // Calibration file path
+    std::vector<std::filesystem::path> bg_frame_paths;              // Additional background frames
+    std::vector<std::filesystem::path> frame_paths;                 // Foreground image paths of a capture sequence
 };